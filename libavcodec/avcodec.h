@@ -39,6 +39,7 @@
 #include "libavutil/log.h"
 #include "libavutil/pixfmt.h"
 #include "libavutil/rational.h"
+#include "libavutil/threadpool.h"
 
 #include "version.h"
 
@@ -3195,6 +3196,9 @@ typedef struct AVCodecContext {
      * Which multithreading methods to use.
      * Use of FF_THREAD_FRAME will increase decoding delay by one frame per thread,
      * so clients which cannot provide future frames should not use it.
+     * With FF_THREAD_LOW_DELAY, at most two frames are decoded at once and
+     * the delay is limited to one frame; this is also allowed together with
+     * AV_CODEC_FLAG_LOW_DELAY, which otherwise disables frame threading.
      *
      * - encoding: Set by user, otherwise the default is used.
      * - decoding: Set by user, otherwise the default is used.
@@ -3202,6 +3206,7 @@ typedef struct AVCodecContext {
     int thread_type;
 #define FF_THREAD_FRAME   1 ///< Decode more than one frame at once
 #define FF_THREAD_SLICE   2 ///< Decode more than one part of a single frame at once
+#define FF_THREAD_LOW_DELAY 4 ///< Limit frame threading to one frame of delay
 
     /**
      * Which multithreading methods are in use by the codec.
@@ -3702,6 +3707,28 @@ typedef struct AVCodecContext {
      * (with the display dimensions being determined by the crop_* fields).
      */
     int apply_cropping;
+
+    /**
+     * Number of slice threads used by each frame thread, for decoders which
+     * support combining frame and slice threading. This applies when both
+     * are enabled in thread_type, and multiplies the number of threads.
+     * 0 uses the cores left over by the frame threads when thread_count is
+     * also automatic, and no slice threads otherwise. 1 disables it.
+     * - encoding: unused
+     * - decoding: Set by user, set by libavcodec to the number in use.
+     */
+    int slice_thread_count;
+
+    /**
+     * Thread pool to run the threads of the codec on, instead of creating
+     * threads for this context. thread_count keeps its meaning, with 0
+     * selecting a count suitable for the size of the pool. Some codecs may
+     * still create threads of their own for parts of their work.
+     * The pool must stay valid until the context is closed.
+     * - encoding: Set by user.
+     * - decoding: Set by user.
+     */
+    AVThreadPool *thread_pool;
 } AVCodecContext;
 
 AVRational av_codec_get_pkt_timebase         (const AVCodecContext *avctx);
@@ -3854,6 +3881,13 @@ typedef struct AVCodec {
      * packets before decoding.
      */
     const char *bsfs;
+
+    /**
+     * Return the number of bytes allocated by the codec for the context,
+     * not counting priv_data itself and the frames. Buffers shared with other
+     * contexts are counted with ff_buffer_shared_size().
+     */
+    int64_t (*memory_usage)(AVCodecContext *avctx);
 } AVCodec;
 
 int av_codec_get_max_lowres(const AVCodec *codec);
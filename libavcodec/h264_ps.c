@@ -105,6 +105,25 @@ static void remove_sps(H264ParamSets *s, int id)
     av_buffer_unref(&s->sps_list[id]);
 }
 
+/**
+ * Check whether the SPS in gb is a byte-exact repeat of an already parsed
+ * one, which then does not need to be parsed again.
+ */
+static int sps_is_repeat(const H264ParamSets *ps, const GetBitContext *gb)
+{
+    size_t size = gb->buffer_end - gb->buffer;
+    int i;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(ps->sps_list); i++) {
+        const SPS *sps = ps->sps_list[i] ? (const SPS*)ps->sps_list[i]->data : NULL;
+
+        if (sps && sps->data_size == size && size < sizeof(sps->data) &&
+            !memcmp(sps->data, gb->buffer, size))
+            return 1;
+    }
+    return 0;
+}
+
 static inline int decode_hrd_parameters(GetBitContext *gb, AVCodecContext *avctx,
                                         SPS *sps)
 {
@@ -341,6 +360,10 @@ int ff_h264_decode_seq_parameter_set(GetBitContext *gb, AVCodecContext *avctx,
     SPS *sps;
     int ret;
 
+    /* in-band SPS are usually repeated with every keyframe */
+    if (sps_is_repeat(ps, gb))
+        return 0;
+
     sps_buf = av_buffer_allocz(sizeof(*sps));
     if (!sps_buf)
         return AVERROR(ENOMEM);
@@ -158,33 +158,6 @@ static int alloc_scratch_buffers(H264SliceContext *sl, int linesize)
     return 0;
 }
 
-static int init_table_pools(H264Context *h)
-{
-    const int big_mb_num    = h->mb_stride * (h->mb_height + 1) + 1;
-    const int mb_array_size = h->mb_stride * h->mb_height;
-    const int b4_stride     = h->mb_width * 4 + 1;
-    const int b4_array_size = b4_stride * h->mb_height * 4;
-
-    h->qscale_table_pool = av_buffer_pool_init(big_mb_num + h->mb_stride,
-                                               av_buffer_allocz);
-    h->mb_type_pool      = av_buffer_pool_init((big_mb_num + h->mb_stride) *
-                                               sizeof(uint32_t), av_buffer_allocz);
-    h->motion_val_pool   = av_buffer_pool_init(2 * (b4_array_size + 4) *
-                                               sizeof(int16_t), av_buffer_allocz);
-    h->ref_index_pool    = av_buffer_pool_init(4 * mb_array_size, av_buffer_allocz);
-
-    if (!h->qscale_table_pool || !h->mb_type_pool || !h->motion_val_pool ||
-        !h->ref_index_pool) {
-        av_buffer_pool_uninit(&h->qscale_table_pool);
-        av_buffer_pool_uninit(&h->mb_type_pool);
-        av_buffer_pool_uninit(&h->motion_val_pool);
-        av_buffer_pool_uninit(&h->ref_index_pool);
-        return AVERROR(ENOMEM);
-    }
-
-    return 0;
-}
-
 static int alloc_picture(H264Context *h, H264Picture *pic)
 {
     int i, ret = 0;
@@ -220,12 +193,6 @@ static int alloc_picture(H264Context *h, H264Picture *pic)
         }
     }
 
-    if (!h->qscale_table_pool) {
-        ret = init_table_pools(h);
-        if (ret < 0)
-            goto fail;
-    }
-
     pic->qscale_table_buf = av_buffer_pool_get(h->qscale_table_pool);
     pic->mb_type_buf      = av_buffer_pool_get(h->mb_type_pool);
     if (!pic->qscale_table_buf || !pic->mb_type_buf)
@@ -283,7 +250,7 @@ static void copy_picture_range(H264Picture **to, H264Picture **from, int count,
     }
 }
 
-static int h264_slice_header_init(H264Context *h);
+static int h264_slice_header_init(H264Context *h, const H264Context *src);
 
 int ff_h264_update_thread_context(AVCodecContext *dst,
                                   const AVCodecContext *src)
@@ -360,7 +327,7 @@ int ff_h264_update_thread_context(AVCodecContext *dst,
         h->b_stride  = h1->b_stride;
 
         if (h->context_initialized || h1->context_initialized) {
-            if ((err = h264_slice_header_init(h)) < 0) {
+            if ((err = h264_slice_header_init(h, h1)) < 0) {
                 av_log(h->avctx, AV_LOG_ERROR, "h264_slice_header_init() failed");
                 return err;
             }
@@ -910,7 +877,11 @@ static int init_dimensions(H264Context *h)
     return 0;
 }
 
-static int h264_slice_header_init(H264Context *h)
+/**
+ * (Re)initialize the context for the current SPS.
+ * @param src context to share the dimension-dependent tables with, may be NULL
+ */
+static int h264_slice_header_init(H264Context *h, const H264Context *src)
 {
     const SPS *sps = h->ps.sps;
     int i, ret;
@@ -933,7 +904,7 @@ static int h264_slice_header_init(H264Context *h)
     h->prev_interlaced_frame = 1;
 
     init_scan_tables(h);
-    ret = ff_h264_alloc_tables(h);
+    ret = ff_h264_alloc_tables(h, src);
     if (ret < 0) {
         av_log(h->avctx, AV_LOG_ERROR, "Could not allocate memory\n");
         goto fail;
@@ -1125,7 +1096,7 @@ static int h264_init_ps(H264Context *h, const H264SliceContext *sl, int first_sl
         av_log(h->avctx, AV_LOG_VERBOSE, "Reinit context to %dx%d, "
                "pix_fmt: %s\n", h->width, h->height, av_get_pix_fmt_name(h->avctx->pix_fmt));
 
-        if ((ret = h264_slice_header_init(h)) < 0) {
+        if ((ret = h264_slice_header_init(h, NULL)) < 0) {
             av_log(h->avctx, AV_LOG_ERROR,
                    "h264_slice_header_init() failed\n");
             return ret;
@@ -2500,6 +2471,71 @@ static void decode_finish_row(const H264Context *h, H264SliceContext *sl)
                               h->picture_structure == PICT_BOTTOM_FIELD);
 }
 
+/* Number of MB rows the deblocking job waits for once it has caught up
+ * with the decoding, so that it is not woken up for every single row. */
+#define DEBLOCK_BATCH_ROWS 4
+
+#if HAVE_THREADS
+static void queue_deblock(H264Context *h, int mb_y, int end_x, int row_end,
+                          int slice_done)
+{
+    pthread_mutex_lock(&h->deblock_progress_mutex);
+    if (slice_done) {
+        h->deblock_slice_done = 1;
+    } else {
+        h->deblock_queued_y       = mb_y;
+        h->deblock_queued_x       = end_x;
+        h->deblock_queued_row_end = row_end;
+    }
+    if (slice_done || mb_y >= h->deblock_wait_y)
+        pthread_cond_signal(&h->deblock_progress_cond);
+    pthread_mutex_unlock(&h->deblock_progress_mutex);
+}
+
+/**
+ * Wait until MB row mb_y has been queued, or if it has not yet, until
+ * wait_y has been.
+ */
+static void await_deblock(H264Context *h, int mb_y, int wait_y,
+                          int *queued_y, int *queued_x, int *row_end)
+{
+    pthread_mutex_lock(&h->deblock_progress_mutex);
+    if (h->deblock_queued_y < mb_y) {
+        h->deblock_wait_y = wait_y;
+        while (h->deblock_queued_y < wait_y && !h->deblock_slice_done)
+            pthread_cond_wait(&h->deblock_progress_cond, &h->deblock_progress_mutex);
+        h->deblock_wait_y = INT_MAX;
+    }
+    *queued_y = h->deblock_queued_y;
+    *queued_x = h->deblock_queued_x;
+    *row_end  = h->deblock_queued_row_end;
+    pthread_mutex_unlock(&h->deblock_progress_mutex);
+}
+#else
+static void queue_deblock(H264Context *h, int mb_y, int end_x, int row_end,
+                          int slice_done) {}
+
+static void await_deblock(H264Context *h, int mb_y, int wait_y,
+                          int *queued_y, int *queued_x, int *row_end)
+{
+    *queued_y = -1;
+}
+#endif
+
+/**
+ * Deblock the given part of the current MB row, or queue it for the
+ * deblocking job if the filter runs in a job of its own.
+ */
+static void filter_mb_range(const H264Context *h, H264SliceContext *sl,
+                            int start_x, int end_x, int row_end)
+{
+    loop_filter(h, sl, start_x, end_x);
+    if (h->deblock_mt)
+        queue_deblock(sl->h264, sl->mb_y, end_x, row_end, 0);
+    else if (row_end)
+        decode_finish_row(h, sl);
+}
+
 static void er_add_slice(H264SliceContext *sl,
                          int startx, int starty,
                          int endx, int endy, int status)
@@ -2533,7 +2569,7 @@ static int decode_slice(struct AVCodecContext *avctx, void *arg)
 
     av_assert0(h->block_offset[15] == (4 * ((scan8[15] - scan8[0]) & 7) << h->pixel_shift) + 4 * sl->linesize * ((scan8[15] - scan8[0]) >> 3));
 
-    if (h->postpone_filter)
+    if (h->postpone_filter || h->deblock_mt)
         sl->deblocking_filter = 0;
 
     sl->is_complex = FRAME_MBAFF(h) || h->picture_structure != PICT_FRAME ||
@@ -2596,7 +2632,7 @@ static int decode_slice(struct AVCodecContext *avctx, void *arg)
                 er_add_slice(sl, sl->resync_mb_x, sl->resync_mb_y, sl->mb_x - 1,
                              sl->mb_y, ER_MB_END);
                 if (sl->mb_x >= lf_x_start)
-                    loop_filter(h, sl, lf_x_start, sl->mb_x + 1);
+                    filter_mb_range(h, sl, lf_x_start, sl->mb_x + 1, 0);
                 goto finish;
             }
             if (sl->cabac.bytestream > sl->cabac.bytestream_end + 2 )
@@ -2612,9 +2648,8 @@ static int decode_slice(struct AVCodecContext *avctx, void *arg)
             }
 
             if (++sl->mb_x >= h->mb_width) {
-                loop_filter(h, sl, lf_x_start, sl->mb_x);
+                filter_mb_range(h, sl, lf_x_start, sl->mb_x, 1);
                 sl->mb_x = lf_x_start = 0;
-                decode_finish_row(h, sl);
                 ++sl->mb_y;
                 if (FIELD_OR_MBAFF_PICTURE(h)) {
                     ++sl->mb_y;
@@ -2629,7 +2664,7 @@ static int decode_slice(struct AVCodecContext *avctx, void *arg)
                 er_add_slice(sl, sl->resync_mb_x, sl->resync_mb_y, sl->mb_x - 1,
                              sl->mb_y, ER_MB_END);
                 if (sl->mb_x > lf_x_start)
-                    loop_filter(h, sl, lf_x_start, sl->mb_x);
+                    filter_mb_range(h, sl, lf_x_start, sl->mb_x, 0);
                 goto finish;
             }
         }
@@ -2669,9 +2704,8 @@ static int decode_slice(struct AVCodecContext *avctx, void *arg)
             }
 
             if (++sl->mb_x >= h->mb_width) {
-                loop_filter(h, sl, lf_x_start, sl->mb_x);
+                filter_mb_range(h, sl, lf_x_start, sl->mb_x, 1);
                 sl->mb_x = lf_x_start = 0;
-                decode_finish_row(h, sl);
                 ++sl->mb_y;
                 if (FIELD_OR_MBAFF_PICTURE(h)) {
                     ++sl->mb_y;
@@ -2705,7 +2739,7 @@ static int decode_slice(struct AVCodecContext *avctx, void *arg)
                     er_add_slice(sl, sl->resync_mb_x, sl->resync_mb_y,
                                  sl->mb_x - 1, sl->mb_y, ER_MB_END);
                     if (sl->mb_x > lf_x_start)
-                        loop_filter(h, sl, lf_x_start, sl->mb_x);
+                        filter_mb_range(h, sl, lf_x_start, sl->mb_x, 0);
 
                     goto finish;
                 } else {
@@ -2723,6 +2757,91 @@ finish:
     return 0;
 }
 
+/**
+ * Deblock the MB rows of the current slice as they are queued by
+ * decode_slice(), lagging one row behind so that the intra prediction of the
+ * next row still sees unfiltered samples.
+ */
+static void deblock_rows(H264Context *h, H264SliceContext *sl)
+{
+    const int step = 1 + FIELD_OR_MBAFF_PICTURE(h);
+    int mb_y = sl->mb_y, start_x = sl->mb_x;
+    int queued_y, queued_x, row_end;
+
+    for (;; mb_y += step, start_x = 0) {
+        await_deblock(h, mb_y + step, mb_y + step * DEBLOCK_BATCH_ROWS,
+                      &queued_y, &queued_x, &row_end);
+        if (queued_y < mb_y)
+            break;
+        if (queued_y > mb_y) {
+            queued_x = h->mb_width;
+            row_end  = 1;
+        }
+
+        sl->mb_y = mb_y;
+        loop_filter(h, sl, start_x, queued_x);
+        if (row_end)
+            decode_finish_row(h, sl);
+        if (queued_y == mb_y)
+            break;
+    }
+}
+
+static int decode_slice_deblock_mt(AVCodecContext *avctx, void *arg,
+                                   int job, int self_id)
+{
+    H264Context *h = avctx->priv_data;
+    int ret;
+
+    if (job) {
+        deblock_rows(h, &h->slice_ctx[1]);
+        return 0;
+    }
+
+    ret = decode_slice(avctx, &h->slice_ctx[0]);
+    queue_deblock(h, 0, 0, 0, 1);
+    return ret;
+}
+
+/**
+ * Set up the second slice context to deblock the slice decoded by the
+ * first one.
+ */
+static int init_deblock_context(H264Context *h)
+{
+    const H264SliceContext *sl = &h->slice_ctx[0];
+    H264SliceContext *dsl      = &h->slice_ctx[1];
+    int ret;
+
+    dsl->linesize   = h->cur_pic_ptr->f->linesize[0];
+    dsl->uvlinesize = h->cur_pic_ptr->f->linesize[1];
+
+    ret = alloc_scratch_buffers(dsl, dsl->linesize);
+    if (ret < 0)
+        return ret;
+
+    dsl->slice_num              = sl->slice_num;
+    dsl->slice_type             = sl->slice_type;
+    dsl->slice_type_nos         = sl->slice_type_nos;
+    dsl->list_count             = sl->list_count;
+    dsl->qscale                 = sl->qscale;
+    dsl->qp_thresh              = sl->qp_thresh;
+    dsl->deblocking_filter      = sl->deblocking_filter;
+    dsl->slice_alpha_c0_offset  = sl->slice_alpha_c0_offset;
+    dsl->slice_beta_offset      = sl->slice_beta_offset;
+    dsl->picture_structure      = sl->picture_structure;
+    dsl->mb_field_decoding_flag = sl->mb_field_decoding_flag;
+    dsl->mb_mbaff               = sl->mb_mbaff;
+    dsl->mb_x                   = sl->mb_x;
+    dsl->mb_y                   = sl->mb_y;
+
+    h->deblock_queued_y   = -1;
+    h->deblock_wait_y     = INT_MAX;
+    h->deblock_slice_done = 0;
+
+    return 0;
+}
+
 /**
  * Call decode_slice() for each context.
  *
@@ -2752,7 +2871,23 @@ int ff_h264_execute_decode_slices(H264Context *h)
         h->slice_ctx[0].next_slice_idx = h->mb_width * h->mb_height;
         h->postpone_filter = 0;
 
-        ret = decode_slice(avctx, &h->slice_ctx[0]);
+        /* with slice threads available but only one slice to decode, deblock
+         * in a second job running one MB row behind the reconstruction */
+        if (HAVE_THREADS && h->nb_slice_ctx > 1 &&
+            h->slice_ctx[0].deblocking_filter) {
+            int rets[2];
+
+            ret = init_deblock_context(h);
+            if (ret < 0)
+                goto finish;
+
+            h->deblock_mt = 1;
+            avctx->execute2(avctx, decode_slice_deblock_mt, NULL, rets, 2);
+            h->deblock_mt = 0;
+            ret = rets[0];
+        } else {
+            ret = decode_slice(avctx, &h->slice_ctx[0]);
+        }
         h->mb_y = h->slice_ctx[0].mb_y;
         if (ret < 0)
             goto finish;
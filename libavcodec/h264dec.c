@@ -149,19 +149,19 @@ void ff_h264_free_tables(H264Context *h)
     h->slice_table = NULL;
     av_freep(&h->list_counts);
 
-    av_freep(&h->mb2b_xy);
-    av_freep(&h->mb2br_xy);
-
-    av_buffer_pool_uninit(&h->qscale_table_pool);
-    av_buffer_pool_uninit(&h->mb_type_pool);
-    av_buffer_pool_uninit(&h->motion_val_pool);
-    av_buffer_pool_uninit(&h->ref_index_pool);
+    av_buffer_unref(&h->shared_tables_ref);
+    h->mb2b_xy           = NULL;
+    h->mb2br_xy          = NULL;
+    h->qscale_table_pool = NULL;
+    h->mb_type_pool      = NULL;
+    h->motion_val_pool   = NULL;
+    h->ref_index_pool    = NULL;
 
     for (i = 0; i < h->nb_slice_ctx; i++) {
         H264SliceContext *sl = &h->slice_ctx[i];
 
         av_freep(&sl->dc_val_base);
-        av_freep(&sl->er.mb_index2xy);
+        sl->er.mb_index2xy = NULL;
         av_freep(&sl->er.error_status_table);
         av_freep(&sl->er.er_temp_buffer);
 
@@ -177,11 +177,79 @@ void ff_h264_free_tables(H264Context *h)
     }
 }
 
-int ff_h264_alloc_tables(H264Context *h)
+static void free_shared_tables(void *opaque, uint8_t *data)
+{
+    H264SharedTables *t = (H264SharedTables *)data;
+
+    av_buffer_pool_uninit(&t->qscale_table_pool);
+    av_buffer_pool_uninit(&t->mb_type_pool);
+    av_buffer_pool_uninit(&t->motion_val_pool);
+    av_buffer_pool_uninit(&t->ref_index_pool);
+    av_free(data);
+}
+
+static AVBufferRef *alloc_shared_tables(H264Context *h)
+{
+    const int big_mb_num    = h->mb_stride * (h->mb_height + 1);
+    const int pool_mb_num   = big_mb_num + 1 + h->mb_stride;
+    const int mb_array_size = h->mb_stride * h->mb_height;
+    const int b4_array_size = (h->mb_width * 4 + 1) * h->mb_height * 4;
+    size_t size = sizeof(H264SharedTables) +
+                  2 * big_mb_num * sizeof(uint32_t) +
+                  (h->mb_num + 1) * sizeof(int);
+    H264SharedTables *t;
+    AVBufferRef *buf;
+    uint8_t *data;
+    int x, y;
+
+    data = av_mallocz(size);
+    if (!data)
+        return NULL;
+    buf = av_buffer_create(data, size, free_shared_tables, NULL, 0);
+    if (!buf) {
+        av_free(data);
+        return NULL;
+    }
+
+    t = (H264SharedTables *)data;
+    t->mb_width       = h->mb_width;
+    t->mb_height      = h->mb_height;
+    t->mb_stride      = h->mb_stride;
+    t->mb2b_xy        = (uint32_t *)(data + sizeof(*t));
+    t->mb2br_xy       = t->mb2b_xy + big_mb_num;
+    t->er_mb_index2xy = (int *)(t->mb2br_xy + big_mb_num);
+
+    for (y = 0; y < h->mb_height; y++)
+        for (x = 0; x < h->mb_width; x++) {
+            const int mb_xy = x + y * h->mb_stride;
+            const int b_xy  = 4 * x + 4 * y * h->b_stride;
+
+            t->mb2b_xy[mb_xy]  = b_xy;
+            t->mb2br_xy[mb_xy] = 8 * (FMO ? mb_xy : (mb_xy % (2 * h->mb_stride)));
+            t->er_mb_index2xy[x + y * h->mb_width] = mb_xy;
+        }
+    // error resilience code looks cleaner with this
+    t->er_mb_index2xy[h->mb_height * h->mb_width] = (h->mb_height - 1) *
+                                                    h->mb_stride + h->mb_width;
+
+    t->qscale_table_pool = av_buffer_pool_init(pool_mb_num, av_buffer_allocz);
+    t->mb_type_pool      = av_buffer_pool_init(pool_mb_num * sizeof(uint32_t),
+                                               av_buffer_allocz);
+    t->motion_val_pool   = av_buffer_pool_init(2 * (b4_array_size + 4) *
+                                               sizeof(int16_t), av_buffer_allocz);
+    t->ref_index_pool    = av_buffer_pool_init(4 * mb_array_size, av_buffer_allocz);
+    if (!t->qscale_table_pool || !t->mb_type_pool || !t->motion_val_pool ||
+        !t->ref_index_pool)
+        av_buffer_unref(&buf);
+
+    return buf;
+}
+
+int ff_h264_alloc_tables(H264Context *h, const H264Context *src)
 {
     const int big_mb_num = h->mb_stride * (h->mb_height + 1);
     const int row_mb_num = 2*h->mb_stride*FFMAX(h->nb_slice_ctx, 1);
-    int x, y;
+    const H264SharedTables *t;
 
     FF_ALLOCZ_ARRAY_OR_GOTO(h->avctx, h->intra4x4_pred_mode,
                       row_mb_num, 8 * sizeof(uint8_t), fail)
@@ -211,18 +279,25 @@ int ff_h264_alloc_tables(H264Context *h)
            (big_mb_num + h->mb_stride) * sizeof(*h->slice_table_base));
     h->slice_table = h->slice_table_base + h->mb_stride * 2 + 1;
 
-    FF_ALLOCZ_OR_GOTO(h->avctx, h->mb2b_xy,
-                      big_mb_num * sizeof(uint32_t), fail);
-    FF_ALLOCZ_OR_GOTO(h->avctx, h->mb2br_xy,
-                      big_mb_num * sizeof(uint32_t), fail);
-    for (y = 0; y < h->mb_height; y++)
-        for (x = 0; x < h->mb_width; x++) {
-            const int mb_xy = x + y * h->mb_stride;
-            const int b_xy  = 4 * x + 4 * y * h->b_stride;
-
-            h->mb2b_xy[mb_xy]  = b_xy;
-            h->mb2br_xy[mb_xy] = 8 * (FMO ? mb_xy : (mb_xy % (2 * h->mb_stride)));
-        }
+    if (src && src->shared_tables_ref) {
+        t = (const H264SharedTables *)src->shared_tables_ref->data;
+        if (t->mb_width  == h->mb_width  &&
+            t->mb_height == h->mb_height &&
+            t->mb_stride == h->mb_stride)
+            h->shared_tables_ref = av_buffer_ref(src->shared_tables_ref);
+    }
+    if (!h->shared_tables_ref)
+        h->shared_tables_ref = alloc_shared_tables(h);
+    if (!h->shared_tables_ref)
+        goto fail;
+
+    t = (const H264SharedTables *)h->shared_tables_ref->data;
+    h->mb2b_xy           = t->mb2b_xy;
+    h->mb2br_xy          = t->mb2br_xy;
+    h->qscale_table_pool = t->qscale_table_pool;
+    h->mb_type_pool      = t->mb_type_pool;
+    h->motion_val_pool   = t->motion_val_pool;
+    h->ref_index_pool    = t->ref_index_pool;
 
     return 0;
 
@@ -242,7 +317,7 @@ int ff_h264_slice_context_init(H264Context *h, H264SliceContext *sl)
     int y_size  = (2 * h->mb_width + 1) * (2 * h->mb_height + 1);
     int c_size  = h->mb_stride * (h->mb_height + 1);
     int yc_size = y_size + 2   * c_size;
-    int x, y, i;
+    int i;
 
     sl->ref_cache[0][scan8[5]  + 1] =
     sl->ref_cache[0][scan8[7]  + 1] =
@@ -268,16 +343,7 @@ int ff_h264_slice_context_init(H264Context *h, H264SliceContext *sl)
         er->mb_stride   = h->mb_stride;
         er->b8_stride   = h->mb_width * 2 + 1;
 
-        // error resilience code looks cleaner with this
-        FF_ALLOCZ_OR_GOTO(h->avctx, er->mb_index2xy,
-                          (h->mb_num + 1) * sizeof(int), fail);
-
-        for (y = 0; y < h->mb_height; y++)
-            for (x = 0; x < h->mb_width; x++)
-                er->mb_index2xy[x + y * h->mb_width] = x + y * h->mb_stride;
-
-        er->mb_index2xy[h->mb_height * h->mb_width] = (h->mb_height - 1) *
-                                                      h->mb_stride + h->mb_width;
+        er->mb_index2xy = ((H264SharedTables *)h->shared_tables_ref->data)->er_mb_index2xy;
 
         FF_ALLOCZ_OR_GOTO(h->avctx, er->error_status_table,
                           mb_array_size * sizeof(uint8_t), fail);
@@ -328,6 +394,11 @@ static int h264_init_context(AVCodecContext *avctx, H264Context *h)
 
     avctx->chroma_sample_location = AVCHROMA_LOC_LEFT;
 
+#if HAVE_THREADS
+    pthread_mutex_init(&h->deblock_progress_mutex, NULL);
+    pthread_cond_init(&h->deblock_progress_cond, NULL);
+#endif
+
     h->nb_slice_ctx = (avctx->active_thread_type & FF_THREAD_SLICE) ? avctx->thread_count : 1;
     h->slice_ctx = av_mallocz_array(h->nb_slice_ctx, sizeof(*h->slice_ctx));
     if (!h->slice_ctx) {
@@ -374,6 +445,11 @@ static av_cold int h264_decode_end(AVCodecContext *avctx)
     av_freep(&h->slice_ctx);
     h->nb_slice_ctx = 0;
 
+#if HAVE_THREADS
+    pthread_mutex_destroy(&h->deblock_progress_mutex);
+    pthread_cond_destroy(&h->deblock_progress_cond);
+#endif
+
     ff_h264_sei_uninit(&h->sei);
     ff_h264_ps_uninit(&h->ps);
 
@@ -505,6 +581,45 @@ void ff_h264_flush_change(H264Context *h)
     h->mmco_reset = 1;
 }
 
+static int64_t h264_memory_usage(AVCodecContext *avctx)
+{
+    H264Context *h = avctx->priv_data;
+    int64_t size = h->nb_slice_ctx * sizeof(*h->slice_ctx);
+    int i;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(h->ps.sps_list); i++)
+        size += ff_buffer_shared_size(h->ps.sps_list[i]);
+    for (i = 0; i < FF_ARRAY_ELEMS(h->ps.pps_list); i++)
+        size += ff_buffer_shared_size(h->ps.pps_list[i]);
+    size += ff_buffer_shared_size(h->shared_tables_ref);
+
+    if (h->intra4x4_pred_mode) {
+        const int big_mb_num = h->mb_stride * (h->mb_height + 1);
+        const int row_mb_num = 2 * h->mb_stride * FFMAX(h->nb_slice_ctx, 1);
+
+        size += row_mb_num * (8 + 2 * 16) +
+                big_mb_num * (48 + sizeof(uint16_t) + 1 + 4 + 1) +
+                (big_mb_num + h->mb_stride) * sizeof(*h->slice_table_base);
+    }
+
+    for (i = 0; i < h->nb_slice_ctx; i++) {
+        H264SliceContext *sl = &h->slice_ctx[i];
+
+        size += sl->bipred_scratchpad_allocated + sl->edge_emu_buffer_allocated +
+                sl->top_borders_allocated[0]    + sl->top_borders_allocated[1];
+        if (sl->er.error_status_table) {
+            const int mb_array_size = h->mb_height * h->mb_stride;
+            const int y_size = (2 * h->mb_width + 1) * (2 * h->mb_height + 1);
+            const int c_size = h->mb_stride * (h->mb_height + 1);
+
+            size += mb_array_size * (1 + 4 * sizeof(int) + 1) +
+                    (y_size + 2 * c_size) * sizeof(int16_t);
+        }
+    }
+
+    return size;
+}
+
 /* forget old pics after a seek */
 static void flush_dpb(AVCodecContext *avctx)
 {
@@ -1072,6 +1187,7 @@ AVCodec ff_h264_decoder = {
     .flush                 = flush_dpb,
     .init_thread_copy      = ONLY_IF_THREADS_ENABLED(decode_init_thread_copy),
     .update_thread_context = ONLY_IF_THREADS_ENABLED(ff_h264_update_thread_context),
+    .memory_usage          = h264_memory_usage,
     .profiles              = NULL_IF_CONFIG_SMALL(ff_h264_profiles),
     .priv_class            = &h264_class,
 };
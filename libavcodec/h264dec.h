@@ -371,6 +371,21 @@ typedef struct H264Context {
      */
     int postpone_filter;
 
+    /* Set when a single slice is decoded with slice threads available. Then
+     * the loop filter runs in a job of its own, one MB row behind the MB
+     * decoding.
+     */
+    int deblock_mt;
+    int deblock_queued_y;       ///< last MB row queued for deblocking
+    int deblock_queued_x;       ///< end of the queued part of that row
+    int deblock_queued_row_end; ///< that row is complete
+    int deblock_wait_y;         ///< MB row the deblocking job is waiting for
+    int deblock_slice_done;     ///< MB decoding of the slice has finished
+#if HAVE_THREADS
+    pthread_mutex_t deblock_progress_mutex;
+    pthread_cond_t  deblock_progress_cond;
+#endif
+
     /*
      * Set to 1 when the current picture is IDR, 0 otherwise.
      */
@@ -544,6 +559,11 @@ typedef struct H264Context {
 
     H264SEIContext sei;
 
+    /**
+     * Reference to the H264SharedTables the pools and mb2b_xy/mb2br_xy
+     * point into.
+     */
+    AVBufferRef *shared_tables_ref;
     AVBufferPool *qscale_table_pool;
     AVBufferPool *mb_type_pool;
     AVBufferPool *motion_val_pool;
@@ -551,6 +571,24 @@ typedef struct H264Context {
     int ref2frm[MAX_SLICES][2][64];     ///< reference to frame number lists, used in the loop filter, the first 2 are for -2,-1
 } H264Context;
 
+/**
+ * Tables which only depend on the frame dimensions. They are read-only once
+ * allocated, and shared by all frame threads decoding at the same size.
+ * The buffer pools for the per-picture tables are shared along with them.
+ */
+typedef struct H264SharedTables {
+    int mb_width, mb_height, mb_stride;
+
+    uint32_t *mb2b_xy;
+    uint32_t *mb2br_xy;
+    int *er_mb_index2xy;
+
+    AVBufferPool *qscale_table_pool;
+    AVBufferPool *mb_type_pool;
+    AVBufferPool *motion_val_pool;
+    AVBufferPool *ref_index_pool;
+} H264SharedTables;
+
 extern const uint16_t ff_h264_mb_sizes[4];
 
 /**
@@ -561,8 +599,10 @@ int ff_h264_get_slice_type(const H264SliceContext *sl);
 /**
  * Allocate tables.
  * needs width/height
+ * @param src context whose H264SharedTables are referenced if they match
+ *            the dimensions of h, may be NULL
  */
-int ff_h264_alloc_tables(H264Context *h);
+int ff_h264_alloc_tables(H264Context *h, const H264Context *src);
 
 int ff_h264_decode_ref_pic_list_reordering(H264SliceContext *sl, void *logctx);
 int ff_h264_build_ref_list(H264Context *h, H264SliceContext *sl);
@@ -70,6 +70,40 @@ static const AVRational vui_sar[] = {
     {  2,   1 },
 };
 
+/**
+ * Check whether the VPS or SPS in gb is a byte-exact repeat of an already
+ * parsed one, which then does not need to be parsed again.
+ */
+static int vps_is_repeat(const HEVCParamSets *ps, const GetBitContext *gb)
+{
+    ptrdiff_t size = gb->buffer_end - gb->buffer;
+    int i;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(ps->vps_list); i++) {
+        const HEVCVPS *vps = ps->vps_list[i] ? (const HEVCVPS*)ps->vps_list[i]->data : NULL;
+
+        if (vps && vps->data_size == size && size < sizeof(vps->data) &&
+            !memcmp(vps->data, gb->buffer, size))
+            return 1;
+    }
+    return 0;
+}
+
+static int sps_is_repeat(const HEVCParamSets *ps, const GetBitContext *gb)
+{
+    ptrdiff_t size = gb->buffer_end - gb->buffer;
+    int i;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(ps->sps_list); i++) {
+        const HEVCSPS *sps = ps->sps_list[i] ? (const HEVCSPS*)ps->sps_list[i]->data : NULL;
+
+        if (sps && sps->data_size == size && size < sizeof(sps->data) &&
+            !memcmp(sps->data, gb->buffer, size))
+            return 1;
+    }
+    return 0;
+}
+
 static void remove_pps(HEVCParamSets *s, int id)
 {
     if (s->pps_list[id] && s->pps == (const HEVCPPS*)s->pps_list[id]->data)
@@ -420,14 +454,18 @@ int ff_hevc_decode_nal_vps(GetBitContext *gb, AVCodecContext *avctx,
     int vps_id = 0;
     ptrdiff_t nal_size;
     HEVCVPS *vps;
-    AVBufferRef *vps_buf = av_buffer_allocz(sizeof(*vps));
+    AVBufferRef *vps_buf;
 
+    av_log(avctx, AV_LOG_DEBUG, "Decoding VPS\n");
+
+    if (vps_is_repeat(ps, gb))
+        return 0;
+
+    vps_buf = av_buffer_allocz(sizeof(*vps));
     if (!vps_buf)
         return AVERROR(ENOMEM);
     vps = (HEVCVPS*)vps_buf->data;
 
-    av_log(avctx, AV_LOG_DEBUG, "Decoding VPS\n");
-
     nal_size = gb->buffer_end - gb->buffer;
     if (nal_size > sizeof(vps->data)) {
         av_log(avctx, AV_LOG_WARNING, "Truncating likely oversized VPS "
@@ -1219,17 +1257,21 @@ int ff_hevc_decode_nal_sps(GetBitContext *gb, AVCodecContext *avctx,
                            HEVCParamSets *ps, int apply_defdispwin)
 {
     HEVCSPS *sps;
-    AVBufferRef *sps_buf = av_buffer_allocz(sizeof(*sps));
+    AVBufferRef *sps_buf;
     unsigned int sps_id;
     int ret;
     ptrdiff_t nal_size;
 
+    av_log(avctx, AV_LOG_DEBUG, "Decoding SPS\n");
+
+    if (sps_is_repeat(ps, gb))
+        return 0;
+
+    sps_buf = av_buffer_allocz(sizeof(*sps));
     if (!sps_buf)
         return AVERROR(ENOMEM);
     sps = (HEVCSPS*)sps_buf->data;
 
-    av_log(avctx, AV_LOG_DEBUG, "Decoding SPS\n");
-
     nal_size = gb->buffer_end - gb->buffer;
     if (nal_size > sizeof(sps->data)) {
         av_log(avctx, AV_LOG_WARNING, "Truncating likely oversized SPS "
@@ -78,13 +78,53 @@ static void pic_arrays_free(HEVCContext *s)
     av_freep(&s->sh.size);
     av_freep(&s->sh.offset);
 
-    av_buffer_pool_uninit(&s->tab_mvf_pool);
-    av_buffer_pool_uninit(&s->rpl_tab_pool);
+    av_buffer_unref(&s->shared_pools_ref);
+    s->tab_mvf_pool = NULL;
+    s->rpl_tab_pool = NULL;
 }
 
-/* allocate arrays that depend on frame dimensions */
-static int pic_arrays_init(HEVCContext *s, const HEVCSPS *sps)
+static void free_shared_pools(void *opaque, uint8_t *data)
 {
+    HEVCSharedPools *p = (HEVCSharedPools *)data;
+
+    av_buffer_pool_uninit(&p->tab_mvf_pool);
+    av_buffer_pool_uninit(&p->rpl_tab_pool);
+    av_free(data);
+}
+
+static AVBufferRef *alloc_shared_pools(int min_pu_size, int ctb_count)
+{
+    HEVCSharedPools *p = av_mallocz(sizeof(*p));
+    AVBufferRef *buf;
+
+    if (!p)
+        return NULL;
+    buf = av_buffer_create((uint8_t *)p, sizeof(*p), free_shared_pools, NULL, 0);
+    if (!buf) {
+        av_free(p);
+        return NULL;
+    }
+
+    p->min_pu_size  = min_pu_size;
+    p->ctb_count    = ctb_count;
+    p->tab_mvf_pool = av_buffer_pool_init(min_pu_size * sizeof(MvField),
+                                          av_buffer_allocz);
+    p->rpl_tab_pool = av_buffer_pool_init(ctb_count * sizeof(RefPicListTab),
+                                          av_buffer_allocz);
+    if (!p->tab_mvf_pool || !p->rpl_tab_pool)
+        av_buffer_unref(&buf);
+
+    return buf;
+}
+
+/**
+ * allocate arrays that depend on frame dimensions
+ * @param src context to share the buffer pools with if they match, may be NULL
+ */
+static int pic_arrays_init(HEVCContext *s, const HEVCSPS *sps,
+                           const HEVCContext *src)
+{
+    const HEVCSharedPools *pools;
     int log2_min_cb_size = sps->log2_min_cb_size;
     int width            = sps->width;
     int height           = sps->height;
@@ -125,13 +165,20 @@ static int pic_arrays_init(HEVCContext *s, const HEVCSPS *sps)
     if (!s->horizontal_bs || !s->vertical_bs)
         goto fail;
 
-    s->tab_mvf_pool = av_buffer_pool_init(min_pu_size * sizeof(MvField),
-                                          av_buffer_allocz);
-    s->rpl_tab_pool = av_buffer_pool_init(ctb_count * sizeof(RefPicListTab),
-                                          av_buffer_allocz);
-    if (!s->tab_mvf_pool || !s->rpl_tab_pool)
+    if (src && src->shared_pools_ref) {
+        pools = (const HEVCSharedPools *)src->shared_pools_ref->data;
+        if (pools->min_pu_size == min_pu_size && pools->ctb_count == ctb_count)
+            s->shared_pools_ref = av_buffer_ref(src->shared_pools_ref);
+    }
+    if (!s->shared_pools_ref)
+        s->shared_pools_ref = alloc_shared_pools(min_pu_size, ctb_count);
+    if (!s->shared_pools_ref)
         goto fail;
 
+    pools = (const HEVCSharedPools *)s->shared_pools_ref->data;
+    s->tab_mvf_pool = pools->tab_mvf_pool;
+    s->rpl_tab_pool = pools->rpl_tab_pool;
+
     return 0;
 
 fail:
@@ -403,7 +450,7 @@ static enum AVPixelFormat get_format(HEVCContext *s, const HEVCSPS *sps)
 }
 
 static int set_sps(HEVCContext *s, const HEVCSPS *sps,
-                   enum AVPixelFormat pix_fmt)
+                   enum AVPixelFormat pix_fmt, const HEVCContext *src)
 {
     int ret, i;
 
@@ -414,7 +461,7 @@ static int set_sps(HEVCContext *s, const HEVCSPS *sps,
     if (!sps)
         return 0;
 
-    ret = pic_arrays_init(s, sps);
+    ret = pic_arrays_init(s, sps, src);
     if (ret < 0)
         goto fail;
 
@@ -507,7 +554,7 @@ static int hls_slice_header(HEVCContext *s)
         if (pix_fmt < 0)
             return pix_fmt;
 
-        ret = set_sps(s, sps, pix_fmt);
+        ret = set_sps(s, sps, pix_fmt, NULL);
         if (ret < 0)
             return ret;
 
@@ -2357,6 +2404,33 @@ static void hls_decode_neighbour(HEVCContext *s, int x_ctb, int y_ctb,
     lc->ctb_up_left_flag = ((x_ctb > 0) && (y_ctb > 0)  && (ctb_addr_in_slice-1 >= s->ps.sps->ctb_width) && (s->ps.pps->tile_id[ctb_addr_ts] == s->ps.pps->tile_id[s->ps.pps->ctb_addr_rs_to_ts[ctb_addr_rs-1 - s->ps.sps->ctb_width]]));
 }
 
+#if HAVE_THREADS
+static void hevc_report_filter_rows(HEVCContext *s, int rows, int slice_done)
+{
+    pthread_mutex_lock(&s->filter_progress_mutex);
+    s->filter_rows_ready  = FFMAX(s->filter_rows_ready, rows);
+    s->filter_slice_done |= slice_done;
+    pthread_cond_signal(&s->filter_progress_cond);
+    pthread_mutex_unlock(&s->filter_progress_mutex);
+}
+
+static int hevc_await_filter_rows(HEVCContext *s, int row)
+{
+    int ready;
+
+    pthread_mutex_lock(&s->filter_progress_mutex);
+    while (s->filter_rows_ready <= row && !s->filter_slice_done)
+        pthread_cond_wait(&s->filter_progress_cond, &s->filter_progress_mutex);
+    ready = s->filter_rows_ready;
+    pthread_mutex_unlock(&s->filter_progress_mutex);
+
+    return ready;
+}
+#else
+static void hevc_report_filter_rows(HEVCContext *s, int rows, int slice_done) {}
+static int hevc_await_filter_rows(HEVCContext *s, int row) { return s->filter_rows_ready; }
+#endif
+
 static int hls_decode_entry(AVCodecContext *avctxt, void *isFilterThread)
 {
     HEVCContext *s  = avctxt->priv_data;
@@ -2408,21 +2482,100 @@ static int hls_decode_entry(AVCodecContext *avctxt, void *isFilterThread)
 
         ctb_addr_ts++;
         ff_hevc_save_states(s, ctb_addr_ts);
-        ff_hevc_hls_filters(s, x_ctb, y_ctb, ctb_size);
+        if (s->filter_mt) {
+            // a CTB row can be filtered once the row below it is decoded
+            if (x_ctb + ctb_size >= s->ps.sps->width)
+                hevc_report_filter_rows(s, y_ctb >> s->ps.sps->log2_ctb_size, 0);
+        } else
+            ff_hevc_hls_filters(s, x_ctb, y_ctb, ctb_size);
     }
 
     if (x_ctb + ctb_size >= s->ps.sps->width &&
-        y_ctb + ctb_size >= s->ps.sps->height)
-        ff_hevc_hls_filter(s, x_ctb, y_ctb, ctb_size);
+        y_ctb + ctb_size >= s->ps.sps->height) {
+        if (s->filter_mt)
+            hevc_report_filter_rows(s, s->ps.sps->ctb_height, 0);
+        else
+            ff_hevc_hls_filter(s, x_ctb, y_ctb, ctb_size);
+    }
 
     return ctb_addr_ts;
 }
 
+/**
+ * Loop filter the CTB rows made available by the reconstruction job, in the
+ * same order as ff_hevc_hls_filters() does when called after every CTB.
+ * The filter uses the local context of the second slice context, as the
+ * first one is used by the reconstruction.
+ */
+static void hls_filter_rows(HEVCContext *s1)
+{
+    HEVCContext *s = s1->sList[1];
+    int ctb_size   = 1 << s->ps.sps->log2_ctb_size;
+    int ready, x;
+
+    while ((ready = hevc_await_filter_rows(s1, s1->filter_row)) > s1->filter_row) {
+        for (; s1->filter_row < ready; s1->filter_row++)
+            for (x = 0; x < s->ps.sps->width; x += ctb_size)
+                ff_hevc_hls_filter(s, x, s1->filter_row << s->ps.sps->log2_ctb_size, ctb_size);
+    }
+}
+
+static int hls_decode_entry_filter_mt(AVCodecContext *avctx, void *arg, int job, int self_id)
+{
+    HEVCContext *s = avctx->priv_data;
+    int ret;
+
+    if (job) {
+        hls_filter_rows(s);
+        return 0;
+    }
+
+    ret = hls_decode_entry(avctx, NULL);
+    hevc_report_filter_rows(s, 0, 1);
+    return ret;
+}
+
+static int hevc_alloc_slice_contexts(HEVCContext *s)
+{
+    int i;
+
+    if (s->sList[1])
+        return 0;
+
+    for (i = 1; i < s->threads_number; i++) {
+        s->sList[i]      = av_malloc(sizeof(HEVCContext));
+        s->HEVClcList[i] = av_mallocz(sizeof(HEVCLocalContext));
+        if (!s->sList[i] || !s->HEVClcList[i]) {
+            for (; i > 0; i--) {
+                av_freep(&s->sList[i]);
+                av_freep(&s->HEVClcList[i]);
+            }
+            return AVERROR(ENOMEM);
+        }
+        memcpy(s->sList[i], s, sizeof(HEVCContext));
+        s->sList[i]->HEVClc = s->HEVClcList[i];
+    }
+    return 0;
+}
+
 static int hls_slice_data(HEVCContext *s)
 {
     int arg[2];
     int ret[2];
 
+    if (s->filter_mt) {
+        int res = hevc_alloc_slice_contexts(s);
+        if (res < 0)
+            return res;
+
+        memcpy(s->sList[1], s, sizeof(HEVCContext));
+        s->sList[1]->HEVClc = s->HEVClcList[1];
+        s->filter_slice_done = 0;
+
+        s->avctx->execute2(s->avctx, hls_decode_entry_filter_mt, NULL, ret, 2);
+        return ret[0];
+    }
+
     arg[0] = 0;
     arg[1] = 1;
 
@@ -2538,14 +2691,9 @@ static int hls_slice_data_wpp(HEVCContext *s, const H2645NAL *nal)
 
     ff_alloc_entries(s->avctx, s->sh.num_entry_point_offsets + 1);
 
-    if (!s->sList[1]) {
-        for (i = 1; i < s->threads_number; i++) {
-            s->sList[i] = av_malloc(sizeof(HEVCContext));
-            memcpy(s->sList[i], s, sizeof(HEVCContext));
-            s->HEVClcList[i] = av_mallocz(sizeof(HEVCLocalContext));
-            s->sList[i]->HEVClc = s->HEVClcList[i];
-        }
-    }
+    res = hevc_alloc_slice_contexts(s);
+    if (res < 0)
+        goto error;
 
     offset = (lc->gb.index >> 3);
 
@@ -2761,6 +2909,12 @@ static int hevc_frame_start(HEVCContext *s)
     s->is_decoded        = 0;
     s->first_nal_type    = s->nal_unit_type;
 
+    s->filter_mt         = s->threads_number > 1 &&
+                           !s->ps.pps->tiles_enabled_flag &&
+                           !s->ps.pps->entropy_coding_sync_enabled_flag;
+    s->filter_row        = 0;
+    s->filter_rows_ready = 0;
+
     s->no_rasl_output_flag = IS_IDR(s) || IS_BLA(s) || (s->nal_unit_type == HEVC_NAL_CRA_NUT && s->last_eos);
 
     if (s->ps.pps->tiles_enabled_flag)
@@ -3198,6 +3352,11 @@ static av_cold int hevc_decode_free(AVCodecContext *avctx)
     HEVCContext       *s = avctx->priv_data;
     int i;
 
+#if HAVE_THREADS
+    pthread_mutex_destroy(&s->filter_progress_mutex);
+    pthread_cond_destroy(&s->filter_progress_cond);
+#endif
+
     pic_arrays_free(s);
 
     av_freep(&s->sei.picture_hash.md5_ctx);
@@ -3252,6 +3411,11 @@ static av_cold int hevc_init_context(AVCodecContext *avctx)
 
     s->avctx = avctx;
 
+#if HAVE_THREADS
+    pthread_mutex_init(&s->filter_progress_mutex, NULL);
+    pthread_cond_init(&s->filter_progress_cond, NULL);
+#endif
+
     s->HEVClc = av_mallocz(sizeof(HEVCLocalContext));
     if (!s->HEVClc)
         goto fail;
@@ -3345,7 +3509,7 @@ static int hevc_update_thread_context(AVCodecContext *dst,
     }
 
     if (s->ps.sps != s0->ps.sps)
-        if ((ret = set_sps(s, s0->ps.sps, src->pix_fmt)) < 0)
+        if ((ret = set_sps(s, s0->ps.sps, src->pix_fmt, s0)) < 0)
             return ret;
 
     s->seq_decode = s0->seq_decode;
@@ -3427,6 +3591,53 @@ static av_cold int hevc_init_thread_copy(AVCodecContext *avctx)
     return 0;
 }
 
+static int64_t hevc_memory_usage(AVCodecContext *avctx)
+{
+    HEVCContext *s = avctx->priv_data;
+    const HEVCSPS *sps = s->ps.sps;
+    int64_t size = HEVC_CONTEXTS;
+    int i;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(s->ps.vps_list); i++)
+        size += ff_buffer_shared_size(s->ps.vps_list[i]);
+    for (i = 0; i < FF_ARRAY_ELEMS(s->ps.sps_list); i++)
+        size += ff_buffer_shared_size(s->ps.sps_list[i]);
+    for (i = 0; i < FF_ARRAY_ELEMS(s->ps.pps_list); i++)
+        size += ff_buffer_shared_size(s->ps.pps_list[i]);
+    size += ff_buffer_shared_size(s->shared_pools_ref);
+
+    for (i = 0; i < s->threads_number; i++) {
+        if (s->HEVClcList[i])
+            size += sizeof(HEVCLocalContext);
+        if (i && s->sList[i])
+            size += sizeof(HEVCContext);
+    }
+
+    if (sps && s->sao) {
+        int pic_size_in_ctb = ((sps->width  >> sps->log2_min_cb_size) + 1) *
+                              ((sps->height >> sps->log2_min_cb_size) + 1);
+        int ctb_count       = sps->ctb_width * sps->ctb_height;
+
+        size += ctb_count * (sizeof(*s->sao) + sizeof(*s->deblock) + 1) +
+                2 * sps->min_cb_width * sps->min_cb_height +
+                sps->min_tb_width * sps->min_tb_height +
+                sps->min_pu_width * sps->min_pu_height +
+                (sps->min_pu_width + 1) * (sps->min_pu_height + 1) +
+                pic_size_in_ctb * (sizeof(*s->tab_slice_address) + sizeof(*s->qp_y_tab)) +
+                2 * s->bs_width * s->bs_height;
+
+        if (s->sao_pixel_buffer_h[0]) {
+            int c_count = sps->chroma_format_idc ? 3 : 1;
+
+            for (i = 0; i < c_count; i++)
+                size += (2 * (sps->width  >> sps->hshift[i]) * sps->ctb_height +
+                         2 * (sps->height >> sps->vshift[i]) * sps->ctb_width) << sps->pixel_shift;
+        }
+    }
+
+    return size;
+}
+
 static void hevc_decode_flush(AVCodecContext *avctx)
 {
     HEVCContext *s = avctx->priv_data;
@@ -3466,8 +3677,10 @@ AVCodec ff_hevc_decoder = {
     .flush                 = hevc_decode_flush,
     .update_thread_context = hevc_update_thread_context,
     .init_thread_copy      = hevc_init_thread_copy,
+    .memory_usage          = hevc_memory_usage,
     .capabilities          = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_DELAY |
                              AV_CODEC_CAP_SLICE_THREADS | AV_CODEC_CAP_FRAME_THREADS,
-    .caps_internal         = FF_CODEC_CAP_INIT_THREADSAFE | FF_CODEC_CAP_EXPORTS_CROPPING,
+    .caps_internal         = FF_CODEC_CAP_INIT_THREADSAFE | FF_CODEC_CAP_EXPORTS_CROPPING |
+                             FF_CODEC_CAP_FRAME_SLICE_THREADS,
     .profiles              = NULL_IF_CONFIG_SMALL(ff_hevc_profiles),
 };
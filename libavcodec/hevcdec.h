@@ -26,6 +26,7 @@
 #include <stdatomic.h>
 
 #include "libavutil/buffer.h"
+#include "libavutil/thread.h"
 
 #include "avcodec.h"
 #include "bswapdsp.h"
@@ -379,6 +380,17 @@ typedef struct HEVCLocalContext {
     int boundary_flags;
 } HEVCLocalContext;
 
+/**
+ * Buffer pools for the per-frame tables, shared by the frame threads
+ * decoding with the same dimensions.
+ */
+typedef struct HEVCSharedPools {
+    int min_pu_size;
+    int ctb_count;
+    AVBufferPool *tab_mvf_pool;
+    AVBufferPool *rpl_tab_pool;
+} HEVCSharedPools;
+
 typedef struct HEVCContext {
     const AVClass *c;  // needed by private avoptions
     AVCodecContext *avctx;
@@ -406,6 +418,7 @@ typedef struct HEVCContext {
 
     HEVCParamSets ps;
 
+    AVBufferRef  *shared_pools_ref; ///< HEVCSharedPools the pools below belong to
     AVBufferPool *tab_mvf_pool;
     AVBufferPool *rpl_tab_pool;
 
@@ -467,6 +480,19 @@ typedef struct HEVCContext {
     int enable_parallel_tiles;
     atomic_int wpp_err;
 
+    /**
+     * The loop filter of the current frame runs in a slice thread job of its
+     * own, lagging one CTB row behind the reconstruction.
+     */
+    int filter_mt;
+    int filter_row;         ///< next CTB row to be loop filtered
+    int filter_rows_ready;  ///< number of CTB rows which can be loop filtered
+    int filter_slice_done;  ///< the reconstruction of the current slice has finished
+#if HAVE_THREADS
+    pthread_mutex_t filter_progress_mutex;
+    pthread_cond_t  filter_progress_cond;
+#endif
+
     const uint8_t *data;
 
     H2645Packet pkt;
@@ -68,6 +68,11 @@
  * Codec initializes slice-based threading with a main function
  */
 #define FF_CODEC_CAP_SLICE_THREAD_HAS_MF    (1 << 5)
+/**
+ * The decoder supports slice threading within each frame thread, i.e. its
+ * slice threads report the frame progress for frame threading.
+ */
+#define FF_CODEC_CAP_FRAME_SLICE_THREADS    (1 << 6)
 
 #ifdef TRACE
 #   define ff_tlog(ctx, ...) av_log(ctx, AV_LOG_TRACE, __VA_ARGS__)
@@ -164,6 +169,12 @@ typedef struct AVCodecInternal {
 
     void *thread_ctx;
 
+    /**
+     * Slice threading context. Separate from thread_ctx, as frame threads
+     * may use slice threading themselves.
+     */
+    void *slice_thread_ctx;
+
     DecodeSimpleContext ds;
     DecodeFilterContext filter;
 
@@ -367,6 +378,13 @@ int ff_set_dimensions(AVCodecContext *s, int width, int height);
  */
 int ff_set_sar(AVCodecContext *avctx, AVRational sar);
 
+/**
+ * Return the part of the size of a buffer which is accounted to one of its
+ * references, i.e. the size divided by the number of references, 0 for NULL.
+ * Used by AVCodec.memory_usage for buffers shared between contexts.
+ */
+int64_t ff_buffer_shared_size(const AVBufferRef *buf);
+
 /**
  * Add or update AV_FRAME_DATA_MATRIXENCODING side data.
  */
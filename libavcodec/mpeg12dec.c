@@ -1088,6 +1088,7 @@ static av_cold int mpeg_decode_init(AVCodecContext *avctx)
     s->repeat_field                = 0;
     s->mpeg_enc_ctx.codec_id       = avctx->codec->id;
     avctx->color_range             = AVCOL_RANGE_MPEG;
+    avctx->internal->allocate_progress = 1;
     return 0;
 }
 
@@ -1097,6 +1098,8 @@ static int mpeg_decode_update_thread_context(AVCodecContext *avctx,
 {
     Mpeg1Context *ctx = avctx->priv_data, *ctx_from = avctx_from->priv_data;
     MpegEncContext *s = &ctx->mpeg_enc_ctx, *s1 = &ctx_from->mpeg_enc_ctx;
+    uint8_t *a53_caption  = ctx->a53_caption;
+    int a53_caption_size  = ctx->a53_caption_size;
     int err;
 
     if (avctx == avctx_from               ||
@@ -1108,14 +1111,53 @@ static int mpeg_decode_update_thread_context(AVCodecContext *avctx,
     if (err)
         return err;
 
-    if (!ctx->mpeg_enc_ctx_allocated)
-        memcpy(s + 1, s1 + 1, sizeof(Mpeg1Context) - sizeof(MpegEncContext));
+    /* Sequence, GOP and picture header state persists across packets;
+     * the pending closed captions belong to the thread that parsed them. */
+    memcpy(s + 1, s1 + 1, sizeof(Mpeg1Context) - sizeof(MpegEncContext));
+    ctx->a53_caption      = a53_caption;
+    ctx->a53_caption_size = a53_caption_size;
+
+    memcpy(s->intra_matrix,        s1->intra_matrix,        sizeof(s->intra_matrix));
+    memcpy(s->chroma_intra_matrix, s1->chroma_intra_matrix, sizeof(s->chroma_intra_matrix));
+    memcpy(s->inter_matrix,        s1->inter_matrix,        sizeof(s->inter_matrix));
+    memcpy(s->chroma_inter_matrix, s1->chroma_inter_matrix, sizeof(s->chroma_inter_matrix));
+    s->aspect_ratio_info = s1->aspect_ratio_info;
+    s->frame_rate_index  = s1->frame_rate_index;
+    s->bit_rate          = s1->bit_rate;
+    s->closed_gop        = s1->closed_gop;
+    s->swap_uv           = s1->swap_uv;
+    s->codec_id          = s1->codec_id;
+    avctx->codec_id      = avctx_from->codec_id;
+
+    /* The previous packet ended after the first field of a picture, the
+     * second one is decoded by this thread. */
+    if (s1->first_field && s1->picture_structure != PICT_FRAME &&
+        s->current_picture_ptr) {
+        s->linesize   = s1->linesize;
+        s->uvlinesize = s1->uvlinesize;
+        ff_mpeg_er_frame_start(s);
+        memcpy(s->er.error_status_table, s1->er.error_status_table,
+               s->mb_stride * s->mb_height);
+        s->er.error_count    = s1->er.error_count;
+        s->er.error_occurred = s1->er.error_occurred;
+    }
 
     if (!(s->pict_type == AV_PICTURE_TYPE_B || s->low_delay))
         s->picture_number++;
 
     return 0;
 }
+
+static av_cold int mpeg_decode_init_thread_copy(AVCodecContext *avctx)
+{
+    Mpeg1Context *s = avctx->priv_data;
+
+    /* the context was copied from the first thread before any allocation,
+     * only the back pointer needs fixing up */
+    s->mpeg_enc_ctx.avctx = avctx;
+
+    return 0;
+}
 #endif
 
 static void quant_matrix_rebuild(uint16_t *matrix, const uint8_t *old_perm,
@@ -1679,7 +1721,10 @@ static int mpeg_field_start(MpegEncContext *s, const uint8_t *buf, int buf_size)
             s1->has_afd = 0;
         }
 
-        if (HAVE_THREADS && (avctx->active_thread_type & FF_THREAD_FRAME))
+        /* The second field of a field picture references the first one
+         * without waiting for progress, so setup ends with the second field. */
+        if (HAVE_THREADS && (avctx->active_thread_type & FF_THREAD_FRAME) &&
+            s->picture_structure == PICT_FRAME)
             ff_thread_finish_setup(avctx);
     } else { // second field
         int i;
@@ -1704,6 +1749,9 @@ static int mpeg_field_start(MpegEncContext *s, const uint8_t *buf, int buf_size)
                 s->current_picture.f->data[i] +=
                     s->current_picture_ptr->f->linesize[i];
         }
+
+        if (HAVE_THREADS && (avctx->active_thread_type & FF_THREAD_FRAME))
+            ff_thread_finish_setup(avctx);
     }
 
     if (avctx->hwaccel) {
@@ -1875,7 +1923,9 @@ static int mpeg_decode_slice(MpegEncContext *s, int mb_y,
             int left;
 
             ff_mpeg_draw_horiz_band(s, mb_size * (s->mb_y >> field_pic), mb_size);
-            ff_mpv_report_decode_progress(s);
+            /* rows of a first field leave the other field's lines undecoded */
+            if (!s->first_field)
+                ff_mpv_report_decode_progress(s);
 
             s->mb_x  = 0;
             s->mb_y += 1 << field_pic;
@@ -2874,10 +2924,11 @@ AVCodec ff_mpeg1video_decoder = {
     .decode                = mpeg_decode_frame,
     .capabilities          = AV_CODEC_CAP_DRAW_HORIZ_BAND | AV_CODEC_CAP_DR1 |
                              AV_CODEC_CAP_TRUNCATED | AV_CODEC_CAP_DELAY |
-                             AV_CODEC_CAP_SLICE_THREADS,
+                             AV_CODEC_CAP_SLICE_THREADS | AV_CODEC_CAP_FRAME_THREADS,
     .caps_internal         = FF_CODEC_CAP_SKIP_FRAME_FILL_PARAM,
     .flush                 = flush,
     .max_lowres            = 3,
+    .init_thread_copy      = ONLY_IF_THREADS_ENABLED(mpeg_decode_init_thread_copy),
     .update_thread_context = ONLY_IF_THREADS_ENABLED(mpeg_decode_update_thread_context)
 };
 
@@ -2892,11 +2943,13 @@ AVCodec ff_mpeg2video_decoder = {
     .decode         = mpeg_decode_frame,
     .capabilities   = AV_CODEC_CAP_DRAW_HORIZ_BAND | AV_CODEC_CAP_DR1 |
                       AV_CODEC_CAP_TRUNCATED | AV_CODEC_CAP_DELAY |
-                      AV_CODEC_CAP_SLICE_THREADS,
+                      AV_CODEC_CAP_SLICE_THREADS | AV_CODEC_CAP_FRAME_THREADS,
     .caps_internal  = FF_CODEC_CAP_SKIP_FRAME_FILL_PARAM,
     .flush          = flush,
     .max_lowres     = 3,
     .profiles       = NULL_IF_CONFIG_SMALL(ff_mpeg2_video_profiles),
+    .init_thread_copy      = ONLY_IF_THREADS_ENABLED(mpeg_decode_init_thread_copy),
+    .update_thread_context = ONLY_IF_THREADS_ENABLED(mpeg_decode_update_thread_context),
 };
 
 //legacy decoder
@@ -2556,7 +2556,9 @@ void mpv_reconstruct_mb_internal(MpegEncContext *s, int16_t block[12][64],
             if(!s->encoding){
 
                 if(HAVE_THREADS && s->avctx->active_thread_type&FF_THREAD_FRAME) {
-                    if (s->mv_dir & MV_DIR_FORWARD) {
+                    /* the second field of an MPEG-2 I frame has no previous
+                     * picture and only references the first field */
+                    if (s->mv_dir & MV_DIR_FORWARD && s->last_picture_ptr) {
                         ff_thread_await_progress(&s->last_picture_ptr->tf,
                                                  lowest_referenced_row(s, 0),
                                                  0);
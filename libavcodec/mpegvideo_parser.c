@@ -93,6 +93,8 @@ static void mpegvideo_extract_headers(AVCodecParserContext *s,
                         frame_rate_ext_d = (buf[5] & 0x1f);
                         pc->progressive_sequence = buf[1] & (1 << 3);
                         avctx->has_b_frames= !(buf[5] >> 7);
+                        avctx->profile = buf[0] & 7;
+                        avctx->level   = buf[1] >> 4;
 
                         chroma_format = (buf[1] >> 1) & 3;
                         switch (chroma_format) {
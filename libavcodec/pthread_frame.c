@@ -44,6 +44,7 @@
 #include "libavutil/mem.h"
 #include "libavutil/opt.h"
 #include "libavutil/thread.h"
+#include "libavutil/threadpool_internal.h"
 
 enum {
     ///< Set when the thread is awaiting a packet.
@@ -109,6 +110,8 @@ typedef struct PerThreadContext {
     int async_serializing;
 
     atomic_int debug_threads;       ///< Set if the FF_DEBUG_THREADS option is set.
+
+    AVThreadPoolJob pool_job;       ///< Decoding of one packet, when running on a thread pool.
 } PerThreadContext;
 
 /**
@@ -135,6 +138,8 @@ typedef struct FrameThreadContext {
                                     * Set for the first N packets, where N is the number of threads.
                                     * While it is set, ff_thread_en/decode_frame won't return any results.
                                     */
+
+    AVThreadPoolClient *pool_client; ///< Set when the threads run on AVCodecContext.thread_pool.
 } FrameThreadContext;
 
 #define THREAD_SAFE_CALLBACKS(avctx) \
@@ -159,81 +164,104 @@ static void async_unlock(FrameThreadContext *fctx)
 }
 
 /**
- * Codec worker thread.
+ * Decode the packet submitted to a thread, called with p->mutex held.
  *
  * Automatically calls ff_thread_finish_setup() if the codec does
  * not provide an update_thread_context method, or if the codec returns
  * before calling it.
  */
-static attribute_align_arg void *frame_worker_thread(void *arg)
+static void frame_worker_decode(PerThreadContext *p)
 {
-    PerThreadContext *p = arg;
     AVCodecContext *avctx = p->avctx;
     const AVCodec *codec = avctx->codec;
 
-    pthread_mutex_lock(&p->mutex);
-    while (1) {
-        while (atomic_load(&p->state) == STATE_INPUT_READY && !p->die)
-            pthread_cond_wait(&p->input_cond, &p->mutex);
+    if (!codec->update_thread_context && THREAD_SAFE_CALLBACKS(avctx))
+        ff_thread_finish_setup(avctx);
 
-        if (p->die) break;
+    /* If a decoder supports hwaccel, then it must call ff_get_format().
+     * Since that call must happen before ff_thread_finish_setup(), the
+     * decoder is required to implement update_thread_context() and call
+     * ff_thread_finish_setup() manually. Therefore the above
+     * ff_thread_finish_setup() call did not happen and hwaccel_serializing
+     * cannot be true here. */
+    av_assert0(!p->hwaccel_serializing);
+
+    /* if the previous thread uses hwaccel then we take the lock to ensure
+     * the threads don't run concurrently */
+    if (avctx->hwaccel) {
+        pthread_mutex_lock(&p->parent->hwaccel_mutex);
+        p->hwaccel_serializing = 1;
+    }
 
-        if (!codec->update_thread_context && THREAD_SAFE_CALLBACKS(avctx))
-            ff_thread_finish_setup(avctx);
-
-        /* If a decoder supports hwaccel, then it must call ff_get_format().
-         * Since that call must happen before ff_thread_finish_setup(), the
-         * decoder is required to implement update_thread_context() and call
-         * ff_thread_finish_setup() manually. Therefore the above
-         * ff_thread_finish_setup() call did not happen and hwaccel_serializing
-         * cannot be true here. */
-        av_assert0(!p->hwaccel_serializing);
-
-        /* if the previous thread uses hwaccel then we take the lock to ensure
-         * the threads don't run concurrently */
-        if (avctx->hwaccel) {
-            pthread_mutex_lock(&p->parent->hwaccel_mutex);
-            p->hwaccel_serializing = 1;
-        }
+    av_frame_unref(p->frame);
+    p->got_frame = 0;
+    p->result = codec->decode(avctx, p->frame, &p->got_frame, &p->avpkt);
 
+    if ((p->result < 0 || !p->got_frame) && p->frame->buf[0]) {
+        if (avctx->internal->allocate_progress)
+            av_log(avctx, AV_LOG_ERROR, "A frame threaded decoder did not "
+                   "free the frame on failure. This is a bug, please report it.\n");
         av_frame_unref(p->frame);
-        p->got_frame = 0;
-        p->result = codec->decode(avctx, p->frame, &p->got_frame, &p->avpkt);
+    }
 
-        if ((p->result < 0 || !p->got_frame) && p->frame->buf[0]) {
-            if (avctx->internal->allocate_progress)
-                av_log(avctx, AV_LOG_ERROR, "A frame threaded decoder did not "
-                       "free the frame on failure. This is a bug, please report it.\n");
-            av_frame_unref(p->frame);
-        }
+    if (atomic_load(&p->state) == STATE_SETTING_UP)
+        ff_thread_finish_setup(avctx);
+
+    if (p->hwaccel_serializing) {
+        p->hwaccel_serializing = 0;
+        pthread_mutex_unlock(&p->parent->hwaccel_mutex);
+    }
 
-        if (atomic_load(&p->state) == STATE_SETTING_UP)
-            ff_thread_finish_setup(avctx);
+    if (p->async_serializing) {
+        p->async_serializing = 0;
 
-        if (p->hwaccel_serializing) {
-            p->hwaccel_serializing = 0;
-            pthread_mutex_unlock(&p->parent->hwaccel_mutex);
-        }
+        async_unlock(p->parent);
+    }
 
-        if (p->async_serializing) {
-            p->async_serializing = 0;
+    pthread_mutex_lock(&p->progress_mutex);
 
-            async_unlock(p->parent);
-        }
+    atomic_store(&p->state, STATE_INPUT_READY);
 
-        pthread_mutex_lock(&p->progress_mutex);
+    pthread_cond_broadcast(&p->progress_cond);
+    pthread_cond_signal(&p->output_cond);
+    pthread_mutex_unlock(&p->progress_mutex);
+}
 
-        atomic_store(&p->state, STATE_INPUT_READY);
+/**
+ * Codec worker thread.
+ */
+static attribute_align_arg void *frame_worker_thread(void *arg)
+{
+    PerThreadContext *p = arg;
 
-        pthread_cond_broadcast(&p->progress_cond);
-        pthread_cond_signal(&p->output_cond);
-        pthread_mutex_unlock(&p->progress_mutex);
+    pthread_mutex_lock(&p->mutex);
+    while (1) {
+        while (atomic_load(&p->state) == STATE_INPUT_READY && !p->die)
+            pthread_cond_wait(&p->input_cond, &p->mutex);
+
+        if (p->die) break;
+
+        frame_worker_decode(p);
     }
     pthread_mutex_unlock(&p->mutex);
 
     return NULL;
 }
 
+/**
+ * Thread pool job decoding one packet. Jobs of the same codec are started in
+ * the order the packets were submitted, so a frame only waits for frames
+ * which are already being decoded.
+ */
+static void frame_worker_job(void *arg, int lane)
+{
+    PerThreadContext *p = arg;
+
+    pthread_mutex_lock(&p->mutex);
+    frame_worker_decode(p);
+    pthread_mutex_unlock(&p->mutex);
+}
+
 /**
  * Update the next thread's AVCodecContext with values from the reference thread's context.
  *
@@ -304,7 +332,7 @@ FF_ENABLE_DEPRECATION_WARNINGS
     }
 
     if (for_user) {
-        dst->delay       = src->thread_count - 1;
+        dst->delay       = dst->thread_count - 1;
 #if FF_API_CODED_FRAME
 FF_DISABLE_DEPRECATION_WARNINGS
         dst->coded_frame = src->coded_frame;
@@ -393,6 +421,10 @@ static int submit_packet(PerThreadContext *p, AVCodecContext *user_avctx,
     if (!avpkt->size && !(codec->capabilities & AV_CODEC_CAP_DELAY))
         return 0;
 
+    // the previous job on this thread may still be finishing in the pool
+    if (fctx->pool_client)
+        avpriv_threadpool_wait(fctx->pool_client, &p->pool_job);
+
     pthread_mutex_lock(&p->mutex);
 
     ret = update_context_from_user(p->avctx, user_avctx);
@@ -434,6 +466,11 @@ static int submit_packet(PerThreadContext *p, AVCodecContext *user_avctx,
     pthread_cond_signal(&p->input_cond);
     pthread_mutex_unlock(&p->mutex);
 
+    if (fctx->pool_client) {
+        p->pool_job.nb_lanes = 1;
+        avpriv_threadpool_submit(fctx->pool_client, &p->pool_job);
+    }
+
     /*
      * If the client doesn't have a thread-safe get_buffer(),
      * then decoding threads call back to the main thread,
@@ -576,7 +613,9 @@ void ff_thread_report_progress(ThreadFrame *f, int n, int field)
 
     pthread_mutex_lock(&p->progress_mutex);
 
-    atomic_store_explicit(&progress[field], n, memory_order_release);
+    /* With slice threads, progress can be reported by several threads. */
+    if (atomic_load_explicit(&progress[field], memory_order_relaxed) < n)
+        atomic_store_explicit(&progress[field], n, memory_order_release);
 
     pthread_cond_broadcast(&p->progress_cond);
     pthread_mutex_unlock(&p->progress_mutex);
@@ -654,6 +693,31 @@ static void park_frame_worker_threads(FrameThreadContext *fctx, int thread_count
     async_lock(fctx);
 }
 
+/**
+ * Log the memory used by the codec contexts of all frame threads, including
+ * the contexts themselves, see AVCodec.memory_usage.
+ * The worker threads must be parked.
+ */
+static void log_memory_usage(AVCodecContext *avctx, int thread_count)
+{
+    FrameThreadContext *fctx = avctx->internal->thread_ctx;
+    const AVCodec *codec = avctx->codec;
+    int64_t size = 0;
+    int i;
+
+    for (i = 0; i < thread_count; i++) {
+        PerThreadContext *p = &fctx->threads[i];
+
+        size += sizeof(*p) + sizeof(*p->avctx) + sizeof(*p->avctx->internal) +
+                codec->priv_data_size;
+        if (codec->memory_usage)
+            size += codec->memory_usage(p->avctx);
+    }
+
+    av_log(avctx, AV_LOG_DEBUG, "Codec memory usage: %"PRId64" bytes in %d contexts\n",
+           size, thread_count);
+}
+
 void ff_frame_thread_free(AVCodecContext *avctx, int thread_count)
 {
     FrameThreadContext *fctx = avctx->internal->thread_ctx;
@@ -662,6 +726,13 @@ void ff_frame_thread_free(AVCodecContext *avctx, int thread_count)
 
     park_frame_worker_threads(fctx, thread_count);
 
+    /* skipped when called from a failed ff_frame_thread_init(), the last
+     * thread is only started once its context is fully set up */
+    if (avctx->debug & FF_DEBUG_BUFFERS &&
+        (fctx->threads[thread_count - 1].thread_init ||
+         fctx->threads[thread_count - 1].pool_job.func))
+        log_memory_usage(avctx, thread_count);
+
     if (fctx->prev_thread && fctx->prev_thread != fctx->threads)
         if (update_context_from_thread(fctx->threads->avctx, fctx->prev_thread->avctx, 0) < 0) {
             av_log(avctx, AV_LOG_ERROR, "Final thread update failed\n");
@@ -672,6 +743,9 @@ void ff_frame_thread_free(AVCodecContext *avctx, int thread_count)
     for (i = 0; i < thread_count; i++) {
         PerThreadContext *p = &fctx->threads[i];
 
+        if (fctx->pool_client)
+            avpriv_threadpool_wait(fctx->pool_client, &p->pool_job);
+
         pthread_mutex_lock(&p->mutex);
         p->die = 1;
         pthread_cond_signal(&p->input_cond);
@@ -684,6 +758,9 @@ void ff_frame_thread_free(AVCodecContext *avctx, int thread_count)
         if (codec->close && p->avctx)
             codec->close(p->avctx);
 
+        if (p->avctx && p->avctx->internal && p->avctx->internal->slice_thread_ctx)
+            ff_slice_thread_free(p->avctx);
+
         release_delayed_buffers(p);
         av_frame_free(&p->frame);
     }
@@ -713,6 +790,7 @@ void ff_frame_thread_free(AVCodecContext *avctx, int thread_count)
     }
 
     av_freep(&fctx->threads);
+    avpriv_threadpool_client_free(&fctx->pool_client);
     pthread_mutex_destroy(&fctx->buffer_mutex);
     pthread_mutex_destroy(&fctx->hwaccel_mutex);
     pthread_mutex_destroy(&fctx->async_mutex);
@@ -728,6 +806,7 @@ void ff_frame_thread_free(AVCodecContext *avctx, int thread_count)
 int ff_frame_thread_init(AVCodecContext *avctx)
 {
     int thread_count = avctx->thread_count;
+    int slice_thread_count = avctx->slice_thread_count;
     const AVCodec *codec = avctx->codec;
     AVCodecContext *src = avctx;
     FrameThreadContext *fctx;
@@ -738,16 +817,25 @@ int ff_frame_thread_init(AVCodecContext *avctx)
 #endif
 
     if (!thread_count) {
-        int nb_cpus = av_cpu_count();
+        int nb_cpus = avctx->thread_pool ? avpriv_threadpool_nb_threads(avctx->thread_pool)
+                                         : av_cpu_count();
 #if FF_API_DEBUG_MV
         if ((avctx->debug & (FF_DEBUG_VIS_QP | FF_DEBUG_VIS_MB_TYPE)) || avctx->debug_mv)
             nb_cpus = 1;
 #endif
         // use number of cores + 1 as thread count if there is more than one
-        if (nb_cpus > 1)
+        if (nb_cpus > 1 && avctx->thread_type & FF_THREAD_LOW_DELAY)
+            thread_count = avctx->thread_count = 2;
+        else if (nb_cpus > 1)
             thread_count = avctx->thread_count = FFMIN(nb_cpus + 1, MAX_AUTO_THREADS);
         else
             thread_count = avctx->thread_count = 1;
+        // use the cores left over by frame threads for slice threads
+        if (!slice_thread_count)
+            slice_thread_count = nb_cpus / FFMAX(thread_count, 1);
+    } else if (avctx->thread_type & FF_THREAD_LOW_DELAY && thread_count > 2) {
+        // with two frames in flight, every frame is output after one packet
+        thread_count = avctx->thread_count = 2;
     }
 
     if (thread_count <= 1) {
@@ -755,12 +843,21 @@ int ff_frame_thread_init(AVCodecContext *avctx)
         return 0;
     }
 
+    if (slice_thread_count <= 1)
+        avctx->active_thread_type &= ~FF_THREAD_SLICE;
+    if (avctx->active_thread_type & FF_THREAD_SLICE)
+        avctx->slice_thread_count = slice_thread_count;
+
     avctx->internal->thread_ctx = fctx = av_mallocz(sizeof(FrameThreadContext));
     if (!fctx)
         return AVERROR(ENOMEM);
 
     fctx->threads = av_mallocz_array(thread_count, sizeof(PerThreadContext));
-    if (!fctx->threads) {
+    if (avctx->thread_pool)
+        fctx->pool_client = avpriv_threadpool_client_alloc(avctx->thread_pool);
+    if (!fctx->threads || (avctx->thread_pool && !fctx->pool_client)) {
+        av_freep(&fctx->threads);
+        avpriv_threadpool_client_free(&fctx->pool_client);
         av_freep(&avctx->internal->thread_ctx);
         return AVERROR(ENOMEM);
     }
@@ -808,7 +905,10 @@ int ff_frame_thread_init(AVCodecContext *avctx)
         }
         *copy->internal = *src->internal;
         copy->internal->thread_ctx = p;
+        copy->internal->slice_thread_ctx = NULL;
         copy->internal->last_pkt_props = &p->avpkt;
+        if (avctx->active_thread_type & FF_THREAD_SLICE)
+            copy->thread_count = slice_thread_count;
 
         if (!i) {
             src = copy;
@@ -832,8 +932,21 @@ int ff_frame_thread_init(AVCodecContext *avctx)
 
         if (err) goto error;
 
+        if (avctx->active_thread_type & FF_THREAD_SLICE) {
+            err = ff_slice_thread_init(copy);
+            if (!err && !copy->internal->slice_thread_ctx)
+                err = AVERROR(ENOMEM);
+            if (err) goto error;
+        }
+
         atomic_init(&p->debug_threads, (copy->debug & FF_DEBUG_THREADS) != 0);
 
+        if (fctx->pool_client) {
+            p->pool_job.func = frame_worker_job;
+            p->pool_job.priv = p;
+            continue;
+        }
+
         err = AVERROR(pthread_create(&p->thread, NULL, frame_worker_thread, p));
         p->thread_init= !err;
         if(!p->thread_init)
@@ -1160,6 +1160,22 @@ void avsubtitle_free(AVSubtitle *sub)
     memset(sub, 0, sizeof(AVSubtitle));
 }
 
+int64_t ff_buffer_shared_size(const AVBufferRef *buf)
+{
+    return buf ? buf->size / av_buffer_get_ref_count(buf) : 0;
+}
+
+static void log_memory_usage(AVCodecContext *avctx)
+{
+    const AVCodec *codec = avctx->codec;
+    int64_t size = codec->priv_data_size;
+
+    if (codec->memory_usage)
+        size += codec->memory_usage(avctx);
+
+    av_log(avctx, AV_LOG_DEBUG, "Codec memory usage: %"PRId64" bytes in 1 context\n", size);
+}
+
 av_cold int avcodec_close(AVCodecContext *avctx)
 {
     int i;
@@ -1169,11 +1185,19 @@ av_cold int avcodec_close(AVCodecContext *avctx)
 
     if (avcodec_is_open(avctx)) {
         FramePool *pool = avctx->internal->pool;
+
+        /* with frame threads, this is done by ff_frame_thread_free() once
+         * the worker threads are idle */
+        if (avctx->debug & FF_DEBUG_BUFFERS && avctx->codec &&
+            !(HAVE_THREADS && avctx->internal->thread_ctx &&
+              avctx->active_thread_type & FF_THREAD_FRAME))
+            log_memory_usage(avctx);
         if (CONFIG_FRAME_THREAD_ENCODER &&
             avctx->internal->frame_thread_encoder && avctx->thread_count > 1) {
             ff_frame_thread_encoder_free(avctx);
         }
-        if (HAVE_THREADS && avctx->internal->thread_ctx)
+        if (HAVE_THREADS && (avctx->internal->thread_ctx ||
+                             avctx->internal->slice_thread_ctx))
             ff_thread_free(avctx);
         if (avctx->codec && avctx->codec->close)
             avctx->codec->close(avctx);
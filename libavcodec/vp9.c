@@ -227,7 +227,7 @@ static int update_size(AVCodecContext *avctx, int w, int h)
     s->sb_rows   = (h + 63) >> 6;
     s->cols      = (w + 7) >> 3;
     s->rows      = (h + 7) >> 3;
-    lflvl_len    = avctx->active_thread_type == FF_THREAD_SLICE ? s->sb_rows : 1;
+    lflvl_len    = avctx->active_thread_type & FF_THREAD_SLICE ? s->sb_rows : 1;
 
 #define assign(var, type, n) var = (type) p; p += s->sb_cols * (n) * sizeof(*var)
     av_freep(&s->intra_pred_data[0]);
@@ -758,11 +758,14 @@ static int decode_frame_header(AVCodecContext *avctx,
 
         s->s.h.tiling.tile_cols = 1 << s->s.h.tiling.log2_tile_cols;
         vp9_free_entries(avctx);
-        s->active_tile_cols = avctx->active_thread_type == FF_THREAD_SLICE ?
+        s->active_tile_cols = avctx->active_thread_type & FF_THREAD_SLICE ?
                               s->s.h.tiling.tile_cols : 1;
         vp9_alloc_entries(avctx, s->sb_rows);
         if (avctx->active_thread_type == FF_THREAD_SLICE) {
             n_range_coders = 4; // max_tile_rows
+        } else if (avctx->active_thread_type & FF_THREAD_SLICE) {
+            // two-pass frames are decoded by decode_tiles() using td[0]
+            n_range_coders = FFMAX(4, s->s.h.tiling.tile_cols);
         } else {
             n_range_coders = s->s.h.tiling.tile_cols;
         }
@@ -1446,6 +1449,7 @@ int loopfilter_proc(AVCodecContext *avctx)
                                      yoff, uvoff);
             }
         }
+        ff_thread_report_progress(&s->s.frames[CUR_FRAME].tf, i, 0);
     }
     return 0;
 }
@@ -1457,7 +1461,7 @@ static int vp9_decode_frame(AVCodecContext *avctx, void *frame,
     const uint8_t *data = pkt->data;
     int size = pkt->size;
     VP9Context *s = avctx->priv_data;
-    int ret, i, j, ref;
+    int ret, i, j, ref, tile_threads;
     int retain_segmap_ref = s->s.frames[REF_FRAME_SEGMAP].segmentation_map &&
                             (!s->s.h.segmentation.enabled || !s->s.h.segmentation.update_map);
     AVFrame *f;
@@ -1556,7 +1560,9 @@ FF_ENABLE_DEPRECATION_WARNINGS
     memset(s->above_uv_nnz_ctx[1], 0, s->sb_cols * 16 >> s->ss_h);
     memset(s->above_segpred_ctx, 0, s->cols);
     s->pass = s->s.frames[CUR_FRAME].uses_2pass =
-        avctx->active_thread_type == FF_THREAD_FRAME && s->s.h.refreshctx && !s->s.h.parallelmode;
+        avctx->active_thread_type & FF_THREAD_FRAME && s->s.h.refreshctx && !s->s.h.parallelmode;
+    // two-pass frames are decoded without tile threads
+    tile_threads = HAVE_THREADS && avctx->active_thread_type & FF_THREAD_SLICE && !s->pass;
     if ((ret = update_block_buffers(avctx)) < 0) {
         av_log(avctx, AV_LOG_ERROR,
                "Failed to allocate block buffers\n");
@@ -1600,7 +1606,7 @@ FF_ENABLE_DEPRECATION_WARNINGS
         }
 
 #if HAVE_THREADS
-        if (avctx->active_thread_type == FF_THREAD_SLICE) {
+        if (tile_threads) {
             int tile_row, tile_col;
 
             av_assert1(!s->pass);
@@ -1617,13 +1623,17 @@ FF_ENABLE_DEPRECATION_WARNINGS
                         data += 4;
                         size -= 4;
                     }
-                    if (tile_size > size)
+                    if (tile_size > size) {
+                        ff_thread_report_progress(&s->s.frames[CUR_FRAME].tf, INT_MAX, 0);
                         return AVERROR_INVALIDDATA;
+                    }
                     ret = ff_vp56_init_range_decoder(&s->td[tile_col].c_b[tile_row], data, tile_size);
                     if (ret < 0)
                         return ret;
-                    if (vp56_rac_get_prob_branchy(&s->td[tile_col].c_b[tile_row], 128)) // marker bit
+                    if (vp56_rac_get_prob_branchy(&s->td[tile_col].c_b[tile_row], 128)) { // marker bit
+                        ff_thread_report_progress(&s->s.frames[CUR_FRAME].tf, INT_MAX, 0);
                         return AVERROR_INVALIDDATA;
+                    }
                     data += tile_size;
                     size -= tile_size;
                 }
@@ -1639,7 +1649,7 @@ FF_ENABLE_DEPRECATION_WARNINGS
         }
 
         // Sum all counts fields into td[0].counts for tile threading
-        if (avctx->active_thread_type == FF_THREAD_SLICE)
+        if (tile_threads)
             for (i = 1; i < s->s.h.tiling.tile_cols; i++)
                 for (j = 0; j < sizeof(s->td[i].counts) / sizeof(unsigned); j++)
                     ((unsigned *)&s->td[0].counts)[j] += ((unsigned *)&s->td[i].counts)[j];
@@ -1780,7 +1790,7 @@ AVCodec ff_vp9_decoder = {
     .close                 = vp9_decode_free,
     .decode                = vp9_decode_frame,
     .capabilities          = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_FRAME_THREADS | AV_CODEC_CAP_SLICE_THREADS,
-    .caps_internal         = FF_CODEC_CAP_SLICE_THREAD_HAS_MF,
+    .caps_internal         = FF_CODEC_CAP_SLICE_THREAD_HAS_MF | FF_CODEC_CAP_FRAME_SLICE_THREADS,
     .flush                 = vp9_decode_flush,
     .init_thread_copy      = ONLY_IF_THREADS_ENABLED(vp9_decode_init_thread_copy),
     .update_thread_context = ONLY_IF_THREADS_ENABLED(vp9_decode_update_thread_context),
@@ -860,3 +860,132 @@ INIT_XMM ssse3
 QPEL16_H_LOWPASS_L2_OP put
 QPEL16_H_LOWPASS_L2_OP avg
 %endif
+
+%if HAVE_AVX2_EXTERNAL
+; The AVX2 versions filter a whole row of 16 pixels at once, widened to words,
+; and pack two rows into one register for the output.
+
+; in: %2=src, m3=pw_5, m4=pw_16
+; out: %1=filtered row as words
+; clobbers: m5, m6, m7
+%macro FILT_H16 2
+    pmovzxbw      %1, [%2-2]
+    pmovzxbw      m5, [%2+3]
+    paddw         %1, m5
+    pmovzxbw      m5, [%2-1]
+    pmovzxbw      m6, [%2+2]
+    paddw         m5, m6
+    pmovzxbw      m6, [%2]
+    pmovzxbw      m7, [%2+1]
+    paddw         m6, m7
+    psllw         m6, 2
+    psubw         m6, m5
+    pmullw        m6, m3
+    paddw         %1, m4
+    paddw         %1, m6
+    psraw         %1, 5
+%endmacro
+
+; in: m0=two rows as bytes, %2=dstStride
+%macro STORE16x2 2
+%ifidn %1, avg
+    movu         xm1, [r0]
+    vinserti128   m1, m1, [r0+%2], 1
+    pavgb         m0, m1
+%endif
+    mova        [r0], xm0
+    vextracti128 [r0+%2], m0, 1
+%endmacro
+
+%macro QPEL16_H_LOWPASS_OP_AVX2 1
+cglobal %1_h264_qpel16_h_lowpass, 4,5,8 ; dst, src, dstStride, srcStride
+    movsxdifnidn  r2, r2d
+    movsxdifnidn  r3, r3d
+    mov          r4d, 8
+    mova          m3, [pw_5]
+    mova          m4, [pw_16]
+.loop:
+    FILT_H16      m0, r1
+    FILT_H16      m1, r1+r3
+    packuswb      m0, m1
+    vpermq        m0, m0, q3120
+    STORE16x2     %1, r2
+    lea           r1, [r1+r3*2]
+    lea           r0, [r0+r2*2]
+    dec          r4d
+    jg         .loop
+    RET
+%endmacro
+
+%macro QPEL16_H_LOWPASS_L2_OP_AVX2 1
+cglobal %1_h264_qpel16_h_lowpass_l2, 5,6,8 ; dst, src, src2, dstStride, src2Stride
+    movsxdifnidn  r3, r3d
+    movsxdifnidn  r4, r4d
+    mov          r5d, 8
+    mova          m3, [pw_5]
+    mova          m4, [pw_16]
+.loop:
+    FILT_H16      m0, r1
+    FILT_H16      m1, r1+r3
+    packuswb      m0, m1
+    vpermq        m0, m0, q3120
+    movu         xm1, [r2]
+    vinserti128   m1, m1, [r2+r4], 1
+    pavgb         m0, m1
+    STORE16x2     %1, r3
+    lea           r1, [r1+r3*2]
+    lea           r0, [r0+r3*2]
+    lea           r2, [r2+r4*2]
+    dec          r5d
+    jg         .loop
+    RET
+%endmacro
+
+; in: m0-m4=rows -2..+1 relative to the output row as words
+%macro FILT_V16 1
+    pmovzxbw      m5, [r1]
+    add           r1, r3
+    paddw         m6, m2, m3
+    psllw         m6, 2
+    psubw         m6, m1
+    psubw         m6, m4
+    pmullw        m6, [pw_5]
+    paddw         m7, m0, m5
+    paddw         m7, [pw_16]
+    paddw         m6, m7
+    psraw         m6, 5
+    packuswb      m6, m6
+    vpermq        m6, m6, q3120
+    op_%1        xm6, [r0], xm7
+    add           r0, r2
+    SWAP           0, 1, 2, 3, 4, 5
+%endmacro
+
+%macro QPEL16_V_LOWPASS_OP_AVX2 1
+cglobal %1_h264_qpel16_v_lowpass, 4,4,8 ; dst, src, dstStride, srcStride
+    movsxdifnidn  r2, r2d
+    movsxdifnidn  r3, r3d
+    sub           r1, r3
+    sub           r1, r3
+    pmovzxbw      m0, [r1]
+    pmovzxbw      m1, [r1+r3]
+    lea           r1, [r1+r3*2]
+    pmovzxbw      m2, [r1]
+    pmovzxbw      m3, [r1+r3]
+    lea           r1, [r1+r3*2]
+    pmovzxbw      m4, [r1]
+    add           r1, r3
+%rep 16
+    FILT_V16      %1
+%endrep
+    RET
+%endmacro
+
+INIT_YMM avx2
+QPEL16_H_LOWPASS_OP_AVX2 put
+QPEL16_H_LOWPASS_OP_AVX2 avg
+QPEL16_H_LOWPASS_L2_OP_AVX2 put
+QPEL16_H_LOWPASS_L2_OP_AVX2 avg
+QPEL16_V_LOWPASS_OP_AVX2 put
+QPEL16_V_LOWPASS_OP_AVX2 avg
+%endif
@@ -51,15 +51,19 @@ SECTION .text
 
 %macro WEIGHT_SETUP 0
     mova       m0, [pw_1]
-    movd       m2, r3m
-    pslld      m0, m2       ; 1<<log2_denom
-    SPLATW     m0, m0
+    movd      xm2, r3m
+    pslld      m0, xm2      ; 1<<log2_denom
+    SPLATW     m0, xm0
     shl        r5, 19       ; *8, move to upper half of dword
     lea        r5, [r5+r4*2+0x10000]
-    movd       m3, r5d      ; weight<<1 | 1+(offset<<(3))
+    movd      xm3, r5d      ; weight<<1 | 1+(offset<<(3))
+%if mmsize == 32
+    vpbroadcastd m3, xm3
+%else
     pshufd     m3, m3, 0
+%endif
     mova       m4, [pw_pixel_max]
-    paddw      m2, [sq_1]   ; log2_denom+1
+    paddw     xm2, [sq_1]   ; log2_denom+1
 %if notcpuflag(sse4)
     pxor       m7, m7
 %endif
@@ -67,7 +71,11 @@ SECTION .text
 
 %macro WEIGHT_OP 1-2
 %if %0==1
+%if mmsize == 32
+    movu        m5, [r0+%1]
+%else
     mova        m5, [r0+%1]
+%endif
     punpckhwd   m6, m5, m0
     punpcklwd   m5, m0
 %else
@@ -78,8 +86,8 @@ SECTION .text
 %endif
     pmaddwd     m5, m3
     pmaddwd     m6, m3
-    psrad       m5, m2
-    psrad       m6, m2
+    psrad       m5, xm2
+    psrad       m6, xm2
 %if cpuflag(sse4)
     packusdw    m5, m6
     pminsw      m5, m4
@@ -127,6 +135,20 @@ INIT_XMM sse2
 WEIGHT_FUNC_MM
 INIT_XMM sse4
 WEIGHT_FUNC_MM
+%if HAVE_AVX2_EXTERNAL
+; a row of 16 pixels fills one ymm register
+INIT_YMM avx2
+cglobal h264_weight_16_10
+    WEIGHT_PROLOGUE
+    WEIGHT_SETUP
+.nextrow:
+    WEIGHT_OP   0
+    movu     [r0], m5
+    add        r0, r1
+    dec        r2d
+    jnz .nextrow
+    RET
+%endif
 
 
 %macro WEIGHT_FUNC_HALF_MM 0
@@ -178,13 +200,18 @@ DECLARE_REG_TMP 7
     or         t0, 1
     shl        r6, 16
     or         r5, r6
-    movd       m4, r5d      ; weightd | weights
-    movd       m5, t0d      ; (offset+1)|1
-    movd       m6, r4m      ; log2_denom
-    pslld      m5, m6       ; (((offset<<2)+1)|1)<<log2_denom
-    paddd      m6, [sq_1]
+    movd      xm4, r5d      ; weightd | weights
+    movd      xm5, t0d      ; (offset+1)|1
+    movd      xm6, r4m      ; log2_denom
+    pslld     xm5, xm6      ; (((offset<<2)+1)|1)<<log2_denom
+    paddd     xm6, [sq_1]
+%if mmsize == 32
+    vpbroadcastd m4, xm4
+    vpbroadcastd m5, xm5
+%else
     pshufd     m4, m4, 0
     pshufd     m5, m5, 0
+%endif
     mova       m3, [pw_pixel_max]
     movifnidn r3d, r3m
 %if notcpuflag(sse4)
@@ -194,8 +221,13 @@ DECLARE_REG_TMP 7
 
 %macro BIWEIGHT 1-2
 %if %0==1
+%if mmsize == 32
+    movu       m0, [r0+%1]
+    movu       m1, [r1+%1]
+%else
     mova       m0, [r0+%1]
     mova       m1, [r1+%1]
+%endif
     punpckhwd  m2, m0, m1
     punpcklwd  m0, m1
 %else
@@ -210,8 +242,8 @@ DECLARE_REG_TMP 7
     pmaddwd    m2, m4
     paddd      m0, m5
     paddd      m2, m5
-    psrad      m0, m6
-    psrad      m2, m6
+    psrad      m0, xm6
+    psrad      m2, xm6
 %if cpuflag(sse4)
     packusdw   m0, m2
     pminsw     m0, m3
@@ -260,6 +292,20 @@ INIT_XMM sse2
 BIWEIGHT_FUNC
 INIT_XMM sse4
 BIWEIGHT_FUNC
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+cglobal h264_biweight_16_10
+    BIWEIGHT_PROLOGUE
+    BIWEIGHT_SETUP
+.nextrow:
+    BIWEIGHT  0
+    movu   [r0], m0
+    add      r0, r2
+    add      r1, r2
+    dec      r3d
+    jnz .nextrow
+    RET
+%endif
 
 %macro BIWEIGHT_FUNC_HALF 0
 cglobal h264_biweight_4_10
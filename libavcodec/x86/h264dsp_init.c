@@ -196,6 +196,8 @@ void ff_h264_biweight_ ## W ## _ ## OPT(uint8_t *dst, uint8_t *src,     \
 H264_BIWEIGHT_MMX_SSE(16)
 H264_BIWEIGHT_MMX_SSE(8)
 H264_BIWEIGHT_MMX(4)
+H264_WEIGHT(16, avx2)
+H264_BIWEIGHT(16, avx2)
 
 #define H264_WEIGHT_10(W, DEPTH, OPT)                                   \
 void ff_h264_weight_ ## W ## _ ## DEPTH ## _ ## OPT(uint8_t *dst,       \
@@ -224,6 +226,8 @@ void ff_h264_biweight_ ## W ## _ ## DEPTH ## _ ## OPT(uint8_t *dst,     \
 H264_BIWEIGHT_10_SSE(16, 10)
 H264_BIWEIGHT_10_SSE(8,  10)
 H264_BIWEIGHT_10_SSE(4,  10)
+H264_WEIGHT_10(16, 10, avx2)
+H264_BIWEIGHT_10(16, 10, avx2)
 
 av_cold void ff_h264dsp_init_x86(H264DSPContext *c, const int bit_depth,
                                  const int chroma_format_idc)
@@ -348,6 +352,10 @@ av_cold void ff_h264dsp_init_x86(H264DSPContext *c, const int bit_depth,
             c->h264_idct_add        = ff_h264_idct_add_8_avx;
             c->h264_idct_dc_add     = ff_h264_idct_dc_add_8_avx;
         }
+        if (EXTERNAL_AVX2_FAST(cpu_flags)) {
+            c->weight_h264_pixels_tab[0]   = ff_h264_weight_16_avx2;
+            c->biweight_h264_pixels_tab[0] = ff_h264_biweight_16_avx2;
+        }
     } else if (bit_depth == 10) {
         if (EXTERNAL_MMXEXT(cpu_flags)) {
 #if ARCH_X86_32
@@ -443,6 +451,10 @@ av_cold void ff_h264dsp_init_x86(H264DSPContext *c, const int bit_depth,
             c->h264_h_loop_filter_luma_intra   = ff_deblock_h_luma_intra_10_avx;
 #endif /* HAVE_ALIGNED_STACK */
         }
+        if (EXTERNAL_AVX2_FAST(cpu_flags)) {
+            c->weight_h264_pixels_tab[0]   = ff_h264_weight_16_10_avx2;
+            c->biweight_h264_pixels_tab[0] = ff_h264_biweight_16_10_avx2;
+        }
     }
 #endif
 }
@@ -154,6 +154,7 @@ static int config_output(AVFilterLink *outlink)
         av_opt_set_int(aresample->swr, "ich", inlink->channels, 0);
     if (!outlink->channel_layout)
         av_opt_set_int(aresample->swr, "och", outlink->channels, 0);
+    swr_set_thread_pool(aresample->swr, ctx->graph->thread_pool);
 
     ret = swr_init(aresample->swr);
     if (ret < 0)
@@ -46,6 +46,7 @@
 #include "libavutil/samplefmt.h"
 #include "libavutil/pixfmt.h"
 #include "libavutil/rational.h"
+#include "libavutil/threadpool.h"
 
 #include "libavfilter/version.h"
 
@@ -911,6 +912,15 @@ typedef struct AVFilterGraph {
 
     char *aresample_swr_opts; ///< swr options to use for the auto-inserted aresample filters, Access ONLY through AVOptions
 
+    /**
+     * Thread pool to run the slice threaded filters of this graph on, instead
+     * of threads created for the graph. May be set by the caller before adding
+     * any filters to the filtergraph; it must stay valid until the graph is
+     * freed. nb_threads then limits the number of jobs run at once, with
+     * zero meaning the size of the pool plus the calling thread.
+     */
+    AVThreadPool *thread_pool;
+
     /**
      * Private fields
      *
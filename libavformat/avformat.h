@@ -1474,6 +1474,17 @@ typedef struct AVFormatContext {
 #define AVFMT_FLAG_FAST_SEEK   0x80000 ///< Enable fast, but inaccurate seeks for some formats
 #define AVFMT_FLAG_SHORTEST   0x100000 ///< Stop muxing when the shortest stream stops.
 #define AVFMT_FLAG_AUTO_BSF   0x200000 ///< Wait for packet data before writing a header, and add bitstream filters as requested by the muxer
+/**
+ * Let avformat_find_stream_info() take the dimensions and pixel format of
+ * video streams from their parsers and not decode frames for them when the
+ * parser provides enough information.
+ *
+ * The decoder delay (has_b_frames) is not determined then, so this is meant
+ * for containers which store DTS, e.g. MPEG-TS. If the parser has not
+ * provided the parameters by the end of probing, the buffered packets of
+ * the stream are decoded instead (not possible with AVFMT_FLAG_NOBUFFER).
+ */
+#define AVFMT_FLAG_FAST_PROBE 0x400000
 
     /**
      * Maximum size of the data read from input for determining
@@ -1435,7 +1435,11 @@ resync:
         if (size > ast->remaining)
             size = ast->remaining;
         avi->last_pkt_pos = avio_tell(pb);
-        err               = av_get_packet(pb, pkt, size);
+        /* The DV demuxer and GAB2 subtitles take over the packet data. */
+        if (avi->dv_demux || st->codecpar->codec_type == AVMEDIA_TYPE_SUBTITLE)
+            err = av_get_packet(pb, pkt, size);
+        else
+            err = ff_get_packet_ref(pb, pkt, size);
         if (err < 0)
             return err;
         size = err;
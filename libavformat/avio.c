@@ -57,6 +57,9 @@ static const AVOption options[] = {
     {"protocol_whitelist", "List of protocols that are allowed to be used", OFFSET(protocol_whitelist), AV_OPT_TYPE_STRING, { .str = NULL },  CHAR_MIN, CHAR_MAX, D },
     {"protocol_blacklist", "List of protocols that are not allowed to be used", OFFSET(protocol_blacklist), AV_OPT_TYPE_STRING, { .str = NULL },  CHAR_MIN, CHAR_MAX, D },
     {"rw_timeout", "Timeout for IO operations (in microseconds)", offsetof(URLContext, rw_timeout), AV_OPT_TYPE_INT64, { .i64 = 0 }, 0, INT64_MAX, AV_OPT_FLAG_ENCODING_PARAM | AV_OPT_FLAG_DECODING_PARAM },
+    {"avio_flags", "Flags for the AVIOContext using this protocol", OFFSET(avio_flags), AV_OPT_TYPE_FLAGS, { .i64 = 0 }, 0, INT_MAX, D|E, "avio_flags" },
+        {"async", "read ahead / write behind on a background thread", 0, AV_OPT_TYPE_CONST, { .i64 = URL_AVIO_FLAG_ASYNC }, 0, 0, D|E, "avio_flags" },
+    {"async_buffer_size", "Size of the asynchronous I/O buffer", OFFSET(async_buffer_size), AV_OPT_TYPE_INT, { .i64 = 4 << 20 }, 64 << 10, INT_MAX, D|E },
     { NULL }
 };
 
@@ -650,6 +653,14 @@ int ffurl_get_short_seek(URLContext *h)
     return h->prot->url_get_short_seek(h);
 }
 
+int ffurl_get_buffer_ref(URLContext *h, int64_t pos, int size,
+                         AVBufferRef **buf, uint8_t **data)
+{
+    if (!h->prot->url_get_buffer_ref)
+        return AVERROR(ENOSYS);
+    return h->prot->url_get_buffer_ref(h, pos, size, buf, data);
+}
+
 int ffurl_shutdown(URLContext *h, int flags)
 {
     if (!h->prot->url_shutdown)
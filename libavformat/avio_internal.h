@@ -53,6 +53,20 @@ int ffio_init_context(AVIOContext *s,
  */
 int ffio_read_indirect(AVIOContext *s, unsigned char *buf, int size, const unsigned char **data);
 
+/**
+ * Read size bytes from AVIOContext without copying them, if the underlying
+ * protocol can give access to its data in place (e.g. a memory mapped
+ * file, see ffurl_get_buffer_ref()).
+ * @param s IO context
+ * @param size number of bytes requested
+ * @param buf if not NULL, set to a new reference to a buffer containing the
+ *    data, which is writable and followed by zeroed padding
+ * @param data address at which to store the pointer to the data
+ * @return size on success, AVERROR(ENOSYS) if the data is not available
+ *    in place, in which case nothing was read, or another AVERROR
+ */
+int ffio_read_buffer_ref(AVIOContext *s, int size, AVBufferRef **buf, uint8_t **data);
+
 void ffio_fill(AVIOContext *s, int b, int count);
 
 static av_always_inline void ffio_wfourcc(AVIOContext *pb, const uint8_t *s)
@@ -132,6 +146,57 @@ int ffio_open_dyn_packet_buf(AVIOContext **s, int max_packet_size);
  */
 int ffio_fdopen(AVIOContext **s, URLContext *h);
 
+/**
+ * Return the URLContext associated with the AVIOContext
+ *
+ * @param s IO context
+ * @return pointer to URLContext or NULL, if s was not created by
+ * ffio_fdopen() or does asynchronous I/O, in which case the URLContext
+ * belongs to the background thread
+ */
+struct URLContext *ffio_geturlcontext(AVIOContext *s);
+
+typedef struct FFIOAsync FFIOAsync;
+
+/**
+ * Start a background thread reading ahead from, or writing behind to, the
+ * URLContext h through a ring buffer of buffer_size bytes.
+ * h must not be opened in read+write mode.
+ *
+ * @return 0 on success, AVERROR(ENOSYS) if threads are not available
+ */
+int ffio_async_open(FFIOAsync **a, URLContext *h, int buffer_size);
+
+/**
+ * ffurl_read() replacement, serving prefetched data.
+ */
+int ffio_async_read(FFIOAsync *a, uint8_t *buf, int size);
+
+/**
+ * ffurl_write() replacement, only blocks while the ring buffer is full.
+ * Errors of the background writes are returned by the following calls.
+ */
+int ffio_async_write(FFIOAsync *a, const uint8_t *buf, int size);
+
+/**
+ * ffurl_seek() replacement. In write mode all queued data is written first.
+ */
+int64_t ffio_async_seek(FFIOAsync *a, int64_t pos, int whence);
+
+/**
+ * Wait until all queued data has been written. No-op in read mode.
+ *
+ * @return the first write error, if any
+ */
+int ffio_async_flush(FFIOAsync *a);
+
+/**
+ * Write out all queued data and stop the background thread.
+ *
+ * @return the first write error, if any
+ */
+int ffio_async_close(FFIOAsync **a);
+
 /**
  * Open a write-only fake memory stream. The written data is not stored
  * anywhere - this is only used for measuring the amount of data
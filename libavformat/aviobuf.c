@@ -44,6 +44,7 @@
 
 typedef struct AVIOInternal {
     URLContext *h;
+    FFIOAsync *async;
 } AVIOInternal;
 
 static void *ff_avio_child_next(void *obj, void *prev)
@@ -233,10 +234,21 @@ void avio_write(AVIOContext *s, const unsigned char *buf, int size)
     }
 }
 
+static int io_write_packet(void *opaque, uint8_t *buf, int buf_size);
+
 void avio_flush(AVIOContext *s)
 {
     int seekback = s->write_flag ? FFMIN(0, s->buf_ptr - s->buf_ptr_max) : 0;
     flush_buffer(s);
+    if (s->write_packet == io_write_packet) {
+        AVIOInternal *internal = s->opaque;
+        /* make the data visible to anyone else opening the resource */
+        if (internal->async) {
+            int ret = ffio_async_flush(internal->async);
+            if (ret < 0 && !s->error)
+                s->error = ret;
+        }
+    }
     if (seekback)
         avio_seek(s, seekback, SEEK_CUR);
 }
@@ -691,12 +703,51 @@ int ffio_read_size(AVIOContext *s, unsigned char *buf, int size)
     return ret;
 }
 
+int ffio_read_buffer_ref(AVIOContext *s, int size, AVBufferRef **buf, uint8_t **data)
+{
+    URLContext *h = ffio_geturlcontext(s);
+    AVIOInternal *internal;
+    int64_t pos, res;
+    int ret;
+
+    if (!h || s->write_flag || s->update_checksum || size <= 0)
+        return AVERROR(ENOSYS);
+    internal = s->opaque;
+    if (internal->async)
+        return AVERROR(ENOSYS);
+
+    pos = avio_tell(s);
+    if (pos < 0)
+        return pos;
+    ret = ffurl_get_buffer_ref(h, pos, size, buf, data);
+    if (ret < 0)
+        return ret;
+
+    if (s->buf_end - s->buf_ptr >= size) {
+        s->buf_ptr += size;
+    } else {
+        /* Move the protocol straight past the data instead of refilling the
+         * buffer with bytes the caller already has. */
+        if ((res = s->seek(s->opaque, pos + size, SEEK_SET)) < 0) {
+            if (buf)
+                av_buffer_unref(buf);
+            return res;
+        }
+        s->buf_end = s->buf_ptr = s->buf_ptr_max = s->buffer;
+        s->pos = pos + size;
+        s->eof_reached = 0;
+    }
+    return size;
+}
+
 int ffio_read_indirect(AVIOContext *s, unsigned char *buf, int size, const unsigned char **data)
 {
     if (s->buf_end - s->buf_ptr >= size && !s->write_flag) {
         *data = s->buf_ptr;
         s->buf_ptr += size;
         return size;
+    } else if (ffio_read_buffer_ref(s, size, NULL, (uint8_t **)data) == size) {
+        return size;
     } else {
         *data = buf;
         return avio_read(s, buf, size);
@@ -876,31 +927,40 @@ uint64_t ffio_read_varlen(AVIOContext *bc){
 static int io_read_packet(void *opaque, uint8_t *buf, int buf_size)
 {
     AVIOInternal *internal = opaque;
+    if (internal->async)
+        return ffio_async_read(internal->async, buf, buf_size);
     return ffurl_read(internal->h, buf, buf_size);
 }
 
 static int io_write_packet(void *opaque, uint8_t *buf, int buf_size)
 {
     AVIOInternal *internal = opaque;
+    if (internal->async)
+        return ffio_async_write(internal->async, buf, buf_size);
     return ffurl_write(internal->h, buf, buf_size);
 }
 
 static int64_t io_seek(void *opaque, int64_t offset, int whence)
 {
     AVIOInternal *internal = opaque;
+    if (internal->async)
+        return ffio_async_seek(internal->async, offset, whence);
     return ffurl_seek(internal->h, offset, whence);
 }
 
 static int io_short_seek(void *opaque)
 {
     AVIOInternal *internal = opaque;
+    /* the URLContext is owned by the worker thread */
+    if (internal->async)
+        return 0;
     return ffurl_get_short_seek(internal->h);
 }
 
 static int io_read_pause(void *opaque, int pause)
 {
     AVIOInternal *internal = opaque;
-    if (!internal->h->prot->url_read_pause)
+    if (internal->async || !internal->h->prot->url_read_pause)
         return AVERROR(ENOSYS);
     return internal->h->prot->url_read_pause(internal->h, pause);
 }
@@ -913,11 +973,23 @@ static int64_t io_read_seek(void *opaque, int stream_index, int64_t timestamp, i
     return internal->h->prot->url_read_seek(internal->h, stream_index, timestamp, flags);
 }
 
+URLContext *ffio_geturlcontext(AVIOContext *s)
+{
+    AVIOInternal *internal;
+    if (s->av_class != &ff_avio_class)
+        return NULL;
+    internal = s->opaque;
+    if (internal && s->read_packet == io_read_packet && !internal->async)
+        return internal->h;
+    else
+        return NULL;
+}
+
 int ffio_fdopen(AVIOContext **s, URLContext *h)
 {
     AVIOInternal *internal = NULL;
     uint8_t *buffer = NULL;
-    int buffer_size, max_packet_size;
+    int buffer_size, max_packet_size, ret;
 
     max_packet_size = h->max_packet_size;
     if (max_packet_size) {
@@ -935,6 +1007,24 @@ int ffio_fdopen(AVIOContext **s, URLContext *h)
 
     internal->h = h;
 
+    if (h->avio_flags & URL_AVIO_FLAG_ASYNC) {
+        /* seekable protocols only use max_packet_size as a write size hint */
+        if ((max_packet_size && h->is_streamed) || !h->prot || h->prot->url_read_seek ||
+            (h->flags & AVIO_FLAG_READ_WRITE) == AVIO_FLAG_READ_WRITE) {
+            av_log(h, AV_LOG_WARNING, "Asynchronous I/O is not supported "
+                   "in this mode, ignoring\n");
+        } else {
+            ret = ffio_async_open(&internal->async, h, h->async_buffer_size);
+            if (ret == AVERROR(ENOSYS)) {
+                av_log(h, AV_LOG_WARNING, "Asynchronous I/O is not available, ignoring\n");
+            } else if (ret < 0) {
+                av_freep(&internal);
+                av_freep(&buffer);
+                return ret;
+            }
+        }
+    }
+
     *s = avio_alloc_context(buffer, buffer_size, h->flags & AVIO_FLAG_WRITE,
                             internal, io_read_packet, io_write_packet, io_seek);
     if (!*s)
@@ -966,6 +1056,8 @@ int ffio_fdopen(AVIOContext **s, URLContext *h)
     (*s)->av_class = &ff_avio_class;
     return 0;
 fail:
+    if (internal)
+        ffio_async_close(&internal->async);
     av_freep(&internal);
     av_freep(&buffer);
     return AVERROR(ENOMEM);
@@ -1113,6 +1205,7 @@ int avio_close(AVIOContext *s)
 {
     AVIOInternal *internal;
     URLContext *h;
+    int ret;
 
     if (!s)
         return 0;
@@ -1120,6 +1213,7 @@ int avio_close(AVIOContext *s)
     avio_flush(s);
     internal = s->opaque;
     h        = internal->h;
+    ret      = ffio_async_close(&internal->async);
 
     av_freep(&s->opaque);
     av_freep(&s->buffer);
@@ -1131,6 +1225,10 @@ int avio_close(AVIOContext *s)
 
     avio_context_free(&s);
 
+    if (ret < 0) {
+        ffurl_close(h);
+        return ret;
+    }
     return ffurl_close(h);
 }
 
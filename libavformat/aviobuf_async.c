@@ -0,0 +1,369 @@
+/*
+ * Asynchronous read-ahead and write-behind for AVIOContext
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Background thread moving data between a ring buffer and a URLContext.
+ *
+ * Readers get data prefetched into the ring buffer; seeks inside the
+ * buffered range, or a little ahead of it, are served without touching
+ * the protocol. Writers only copy into the ring buffer, the worker writes
+ * it out; flushing, seeking and closing act as barriers and wait for it to drain.
+ */
+
+#include "config.h"
+
+#include "libavutil/error.h"
+#include "libavutil/fifo.h"
+#include "libavutil/mem.h"
+#include "libavutil/thread.h"
+
+#include "avio_internal.h"
+#include "url.h"
+
+#if HAVE_THREADS
+
+#define ASYNC_CHUNK_SIZE        (64 * 1024)
+#define ASYNC_SHORT_SEEK        (256 * 1024)
+
+struct FFIOAsync {
+    URLContext     *h;
+    int             write_flag;
+
+    AVFifoBuffer   *fifo;
+    uint8_t        *chunk;          ///< data being transferred by the worker
+    int64_t         pos;            ///< read: protocol position of the fifo end
+    int64_t         size;           ///< read: resource size at open time
+
+    int             busy;           ///< write: the worker is writing a chunk
+    int             eof;
+    int             error;
+    int             abort_request;
+
+    int             seek_request;
+    int64_t         seek_pos;
+    int             seek_whence;
+    int64_t         seek_ret;
+
+    pthread_t       thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond_main;
+    pthread_cond_t  cond_worker;
+};
+
+/* called and returning with the mutex locked */
+static void async_read_chunk(FFIOAsync *a)
+{
+    int len = FFMIN(av_fifo_space(a->fifo), ASYNC_CHUNK_SIZE);
+    int ret;
+
+    pthread_mutex_unlock(&a->mutex);
+    ret = ffurl_read(a->h, a->chunk, len);
+    pthread_mutex_lock(&a->mutex);
+
+    if (ret > 0) {
+        av_fifo_generic_write(a->fifo, a->chunk, ret, NULL);
+        a->pos += ret;
+    } else {
+        a->eof = 1;
+        if (ret < 0 && ret != AVERROR_EOF)
+            a->error = ret;
+    }
+}
+
+/* called and returning with the mutex locked */
+static void async_write_chunk(FFIOAsync *a)
+{
+    int len = FFMIN(av_fifo_size(a->fifo), ASYNC_CHUNK_SIZE);
+    int ret;
+
+    av_fifo_generic_read(a->fifo, a->chunk, len, NULL);
+    a->busy = 1;
+    pthread_mutex_unlock(&a->mutex);
+    ret = ffurl_write(a->h, a->chunk, len);
+    pthread_mutex_lock(&a->mutex);
+    a->busy = 0;
+
+    if (ret < 0)
+        a->error = ret;
+}
+
+static void *async_worker(void *arg)
+{
+    FFIOAsync *a = arg;
+
+    pthread_mutex_lock(&a->mutex);
+    while (!a->abort_request) {
+        if (a->seek_request) {
+            int64_t ret = ffurl_seek(a->h, a->seek_pos, a->seek_whence);
+            if (ret >= 0) {
+                av_fifo_reset(a->fifo);
+                a->pos   = ret;
+                a->eof   = 0;
+                a->error = 0;
+            }
+            a->seek_ret     = ret;
+            a->seek_request = 0;
+        } else if (a->write_flag && av_fifo_size(a->fifo) && !a->error) {
+            async_write_chunk(a);
+        } else if (!a->write_flag && av_fifo_space(a->fifo) && !a->eof) {
+            async_read_chunk(a);
+        } else {
+            pthread_cond_wait(&a->cond_worker, &a->mutex);
+            continue;
+        }
+        pthread_cond_signal(&a->cond_main);
+    }
+    pthread_mutex_unlock(&a->mutex);
+
+    return NULL;
+}
+
+/* wait until everything queued has been written, mutex must be held */
+static int async_drain(FFIOAsync *a)
+{
+    while ((av_fifo_size(a->fifo) || a->busy) && !a->error)
+        pthread_cond_wait(&a->cond_main, &a->mutex);
+    return a->error;
+}
+
+int ffio_async_open(FFIOAsync **pa, URLContext *h, int buffer_size)
+{
+    FFIOAsync *a;
+    int ret;
+
+    *pa = NULL;
+    if ((h->flags & AVIO_FLAG_READ_WRITE) == AVIO_FLAG_READ_WRITE)
+        return AVERROR(ENOSYS);
+
+    a = av_mallocz(sizeof(*a));
+    if (!a)
+        return AVERROR(ENOMEM);
+
+    a->h          = h;
+    a->write_flag = !!(h->flags & AVIO_FLAG_WRITE);
+    a->fifo       = av_fifo_alloc(FFMAX(buffer_size, ASYNC_CHUNK_SIZE));
+    a->chunk      = av_malloc(ASYNC_CHUNK_SIZE);
+    if (!a->fifo || !a->chunk) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+    if (!a->write_flag)
+        a->size = ffurl_size(h);
+
+    if ((ret = pthread_mutex_init(&a->mutex, NULL))) {
+        ret = AVERROR(ret);
+        goto fail;
+    }
+    if ((ret = pthread_cond_init(&a->cond_main, NULL))) {
+        ret = AVERROR(ret);
+        goto cond_main_fail;
+    }
+    if ((ret = pthread_cond_init(&a->cond_worker, NULL))) {
+        ret = AVERROR(ret);
+        goto cond_worker_fail;
+    }
+    if ((ret = pthread_create(&a->thread, NULL, async_worker, a))) {
+        ret = AVERROR(ret);
+        goto thread_fail;
+    }
+
+    *pa = a;
+    return 0;
+
+thread_fail:
+    pthread_cond_destroy(&a->cond_worker);
+cond_worker_fail:
+    pthread_cond_destroy(&a->cond_main);
+cond_main_fail:
+    pthread_mutex_destroy(&a->mutex);
+fail:
+    av_fifo_freep(&a->fifo);
+    av_freep(&a->chunk);
+    av_freep(&a);
+    return ret;
+}
+
+int ffio_async_read(FFIOAsync *a, uint8_t *buf, int size)
+{
+    int ret;
+
+    pthread_mutex_lock(&a->mutex);
+    while (!av_fifo_size(a->fifo) && !a->eof)
+        pthread_cond_wait(&a->cond_main, &a->mutex);
+
+    if (av_fifo_size(a->fifo)) {
+        ret = FFMIN(size, av_fifo_size(a->fifo));
+        av_fifo_generic_read(a->fifo, buf, ret, NULL);
+        pthread_cond_signal(&a->cond_worker);
+    } else {
+        ret = a->error ? a->error : AVERROR_EOF;
+    }
+    pthread_mutex_unlock(&a->mutex);
+
+    return ret;
+}
+
+int ffio_async_write(FFIOAsync *a, const uint8_t *buf, int size)
+{
+    int ret = size;
+
+    pthread_mutex_lock(&a->mutex);
+    while (size > 0 && !a->error) {
+        int len = FFMIN(size, av_fifo_space(a->fifo));
+        if (!len) {
+            pthread_cond_wait(&a->cond_main, &a->mutex);
+            continue;
+        }
+        av_fifo_generic_write(a->fifo, (void *)buf, len, NULL);
+        buf  += len;
+        size -= len;
+        pthread_cond_signal(&a->cond_worker);
+    }
+    if (a->error)
+        ret = a->error;
+    pthread_mutex_unlock(&a->mutex);
+
+    return ret;
+}
+
+int64_t ffio_async_seek(FFIOAsync *a, int64_t pos, int whence)
+{
+    int64_t ret;
+
+    pthread_mutex_lock(&a->mutex);
+
+    if (a->write_flag) {
+        ret = async_drain(a);
+        pthread_mutex_unlock(&a->mutex);
+        /* the worker is idle until more data is queued */
+        return ret < 0 ? ret : ffurl_seek(a->h, pos, whence);
+    }
+
+    if (whence == AVSEEK_SIZE) {
+        pthread_mutex_unlock(&a->mutex);
+        return a->size;
+    }
+    if (whence == SEEK_CUR) {
+        pos   += a->pos - av_fifo_size(a->fifo);
+        whence = SEEK_SET;
+    }
+
+    while (whence == SEEK_SET) {
+        int64_t start = a->pos - av_fifo_size(a->fifo);
+
+        if (pos >= start && pos <= a->pos) {
+            av_fifo_drain(a->fifo, pos - start);
+            pthread_cond_signal(&a->cond_worker);
+            pthread_mutex_unlock(&a->mutex);
+            return pos;
+        }
+        /* just ahead of the prefetched data, let the worker catch up */
+        if (pos < a->pos || pos - a->pos > ASYNC_SHORT_SEEK || a->eof)
+            break;
+        av_fifo_drain(a->fifo, av_fifo_size(a->fifo));
+        pthread_cond_signal(&a->cond_worker);
+        pthread_cond_wait(&a->cond_main, &a->mutex);
+    }
+
+    a->seek_request = 1;
+    a->seek_pos     = pos;
+    a->seek_whence  = whence;
+    pthread_cond_signal(&a->cond_worker);
+    while (a->seek_request)
+        pthread_cond_wait(&a->cond_main, &a->mutex);
+    ret = a->seek_ret;
+    pthread_mutex_unlock(&a->mutex);
+
+    return ret;
+}
+
+int ffio_async_flush(FFIOAsync *a)
+{
+    int ret = 0;
+
+    pthread_mutex_lock(&a->mutex);
+    if (a->write_flag)
+        ret = async_drain(a);
+    pthread_mutex_unlock(&a->mutex);
+
+    return ret;
+}
+
+int ffio_async_close(FFIOAsync **pa)
+{
+    FFIOAsync *a = *pa;
+    int ret = 0;
+
+    if (!a)
+        return 0;
+
+    pthread_mutex_lock(&a->mutex);
+    if (a->write_flag)
+        ret = async_drain(a);
+    a->abort_request = 1;
+    pthread_cond_signal(&a->cond_worker);
+    pthread_mutex_unlock(&a->mutex);
+
+    pthread_join(a->thread, NULL);
+    pthread_cond_destroy(&a->cond_worker);
+    pthread_cond_destroy(&a->cond_main);
+    pthread_mutex_destroy(&a->mutex);
+    av_fifo_freep(&a->fifo);
+    av_freep(&a->chunk);
+    av_freep(pa);
+
+    return ret;
+}
+
+#else /* HAVE_THREADS */
+
+int ffio_async_open(FFIOAsync **pa, URLContext *h, int buffer_size)
+{
+    *pa = NULL;
+    return AVERROR(ENOSYS);
+}
+
+int ffio_async_read(FFIOAsync *a, uint8_t *buf, int size)
+{
+    return AVERROR(ENOSYS);
+}
+
+int ffio_async_write(FFIOAsync *a, const uint8_t *buf, int size)
+{
+    return AVERROR(ENOSYS);
+}
+
+int64_t ffio_async_seek(FFIOAsync *a, int64_t pos, int whence)
+{
+    return AVERROR(ENOSYS);
+}
+
+int ffio_async_flush(FFIOAsync *a)
+{
+    return 0;
+}
+
+int ffio_async_close(FFIOAsync **pa)
+{
+    return 0;
+}
+
+#endif /* HAVE_THREADS */
@@ -1458,7 +1458,8 @@ end:
 static int save_avio_options(AVFormatContext *s)
 {
     DASHContext *c = s->priv_data;
-    const char *opts[] = { "headers", "user_agent", "user-agent", "cookies", NULL }, **opt = opts;
+    const char *opts[] = { "headers", "user_agent", "user-agent", "cookies",
+                           "connection_pool", "pool_idle_timeout", NULL }, **opt = opts;
     uint8_t *buf = NULL;
     int ret = 0;
 
@@ -51,6 +51,14 @@ typedef struct Segment {
     int n;
 } Segment;
 
+/* A run of contiguous segments with equal durations, written as one
+ * SegmentTimeline S element. */
+typedef struct TimelineRun {
+    int64_t time;
+    int duration;
+    int nb_segments;
+} TimelineRun;
+
 typedef struct AdaptationSet {
     char id[10];
     enum AVMediaType media_type;
@@ -68,6 +76,10 @@ typedef struct OutputStream {
     int init_range_length;
     int nb_segments, segments_size, segment_index;
     Segment **segments;
+    TimelineRun *runs;
+    int nb_runs, runs_size;
+    int written_len;      // bytes of ctx->pb already written to out in streaming mode
+    int64_t chunk_duration;
     int64_t first_pts, start_pts, max_pts;
     int64_t last_dts;
     int bit_rate;
@@ -100,6 +112,9 @@ typedef struct DASHContext {
     AVRational min_frame_rate, max_frame_rate;
     int ambiguous_frame_rate;
     const char *utc_timing_url;
+    int streaming;
+    int64_t frag_duration;
+    int connection_pool;
 } DASHContext;
 
 static struct codec_string {
@@ -200,10 +215,11 @@ static int flush_dynbuf(OutputStream *os, int *range_length)
     av_write_frame(os->ctx, NULL);
     avio_flush(os->ctx->pb);
 
-    // write out to file
+    // write out to file, except what was already streamed out
     *range_length = avio_close_dyn_buf(os->ctx->pb, &buffer);
     os->ctx->pb = NULL;
-    avio_write(os->out, buffer, *range_length);
+    avio_write(os->out, buffer + os->written_len, *range_length - os->written_len);
+    os->written_len = 0;
     av_free(buffer);
 
     // re-open buffer
@@ -251,10 +267,33 @@ static void dash_free(AVFormatContext *s)
         for (j = 0; j < os->nb_segments; j++)
             av_free(os->segments[j]);
         av_free(os->segments);
+        av_free(os->runs);
     }
     av_freep(&c->streams);
 }
 
+static void set_http_options(AVDictionary **options, DASHContext *c)
+{
+    if (c->connection_pool)
+        av_dict_set(options, "connection_pool", "1", 0);
+}
+
+static int is_streaming(DASHContext *c, OutputStream *os)
+{
+    return c->streaming && !strcmp(os->format_name, "mp4");
+}
+
+static void write_availability_offset(AVIOContext *out, DASHContext *c, OutputStream *os)
+{
+    int64_t seg_duration = c->last_duration ? c->last_duration : c->min_seg_duration;
+    int64_t chunk_duration = c->frag_duration ? c->frag_duration : os->chunk_duration;
+
+    // chunks of a segment are available before the segment is complete
+    if (is_streaming(c, os) && seg_duration > chunk_duration)
+        avio_printf(out, "availabilityTimeOffset=\"%.3f\" availabilityTimeComplete=\"false\" ",
+                    (double)(seg_duration - chunk_duration) / AV_TIME_BASE);
+}
+
 static void output_segment_list(OutputStream *os, AVIOContext *out, DASHContext *c)
 {
     int i, start_index = 0, start_number = 1;
@@ -268,35 +307,41 @@ static void output_segment_list(OutputStream *os, AVIOContext *out, DASHContext
         avio_printf(out, "\t\t\t\t<SegmentTemplate timescale=\"%d\" ", timescale);
         if (!c->use_timeline)
             avio_printf(out, "duration=\"%"PRId64"\" ", c->last_duration);
+        write_availability_offset(out, c, os);
         avio_printf(out, "initialization=\"%s\" media=\"%s\" startNumber=\"%d\">\n", c->init_seg_name, c->media_seg_name, c->use_timeline ? start_number : 1);
         if (c->use_timeline) {
             int64_t cur_time = 0;
+            int skip = start_index, first = 1;
             avio_printf(out, "\t\t\t\t\t<SegmentTimeline>\n");
-            for (i = start_index; i < os->nb_segments; ) {
-                Segment *seg = os->segments[i];
-                int repeat = 0;
+            for (i = 0; i < os->nb_runs; i++) {
+                TimelineRun *run = &os->runs[i];
+                int64_t time = run->time + (int64_t)skip * run->duration;
+                int repeat = run->nb_segments - 1 - skip;
+                if (repeat < 0) {
+                    skip -= run->nb_segments;
+                    continue;
+                }
+                skip = 0;
                 avio_printf(out, "\t\t\t\t\t\t<S ");
-                if (i == start_index || seg->time != cur_time) {
-                    cur_time = seg->time;
-                    avio_printf(out, "t=\"%"PRId64"\" ", seg->time);
+                if (first || time != cur_time) {
+                    cur_time = time;
+                    avio_printf(out, "t=\"%"PRId64"\" ", time);
                 }
-                avio_printf(out, "d=\"%d\" ", seg->duration);
-                while (i + repeat + 1 < os->nb_segments &&
-                       os->segments[i + repeat + 1]->duration == seg->duration &&
-                       os->segments[i + repeat + 1]->time == os->segments[i + repeat]->time + os->segments[i + repeat]->duration)
-                    repeat++;
+                first = 0;
+                avio_printf(out, "d=\"%d\" ", run->duration);
                 if (repeat > 0)
                     avio_printf(out, "r=\"%d\" ", repeat);
                 avio_printf(out, "/>\n");
-                i += 1 + repeat;
-                cur_time += (1 + repeat) * seg->duration;
+                cur_time += (1 + repeat) * run->duration;
             }
             avio_printf(out, "\t\t\t\t\t</SegmentTimeline>\n");
         }
         avio_printf(out, "\t\t\t\t</SegmentTemplate>\n");
     } else if (c->single_file) {
         avio_printf(out, "\t\t\t\t<BaseURL>%s</BaseURL>\n", os->initfile);
-        avio_printf(out, "\t\t\t\t<SegmentList timescale=\"%d\" duration=\"%"PRId64"\" startNumber=\"%d\">\n", AV_TIME_BASE, c->last_duration, start_number);
+        avio_printf(out, "\t\t\t\t<SegmentList timescale=\"%d\" duration=\"%"PRId64"\" ", AV_TIME_BASE, c->last_duration);
+        write_availability_offset(out, c, os);
+        avio_printf(out, "startNumber=\"%d\">\n", start_number);
         avio_printf(out, "\t\t\t\t\t<Initialization range=\"%"PRId64"-%"PRId64"\" />\n", os->init_start_pos, os->init_start_pos + os->init_range_length - 1);
         for (i = start_index; i < os->nb_segments; i++) {
             Segment *seg = os->segments[i];
@@ -307,7 +352,9 @@ static void output_segment_list(OutputStream *os, AVIOContext *out, DASHContext
         }
         avio_printf(out, "\t\t\t\t</SegmentList>\n");
     } else {
-        avio_printf(out, "\t\t\t\t<SegmentList timescale=\"%d\" duration=\"%"PRId64"\" startNumber=\"%d\">\n", AV_TIME_BASE, c->last_duration, start_number);
+        avio_printf(out, "\t\t\t\t<SegmentList timescale=\"%d\" duration=\"%"PRId64"\" ", AV_TIME_BASE, c->last_duration);
+        write_availability_offset(out, c, os);
+        avio_printf(out, "startNumber=\"%d\">\n", start_number);
         avio_printf(out, "\t\t\t\t\t<Initialization sourceURL=\"%s\" />\n", os->initfile);
         for (i = start_index; i < os->nb_segments; i++) {
             Segment *seg = os->segments[i];
@@ -569,6 +616,7 @@ static int write_manifest(AVFormatContext *s, int final)
 {
     DASHContext *c = s->priv_data;
     AVIOContext *out;
+    AVDictionary *opts = NULL;
     char temp_filename[1024];
     int ret, i;
     const char *proto = avio_find_protocol_name(s->filename);
@@ -580,7 +628,9 @@ static int write_manifest(AVFormatContext *s, int final)
         av_log(s, AV_LOG_ERROR, "Cannot use rename on non file protocol, this may lead to races and temporary partial files\n");
 
     snprintf(temp_filename, sizeof(temp_filename), use_rename ? "%s.tmp" : "%s", s->filename);
-    ret = s->io_open(s, &out, temp_filename, AVIO_FLAG_WRITE, NULL);
+    set_http_options(&opts, c);
+    ret = s->io_open(s, &out, temp_filename, AVIO_FLAG_WRITE, &opts);
+    av_dict_free(&opts);
     if (ret < 0) {
         av_log(s, AV_LOG_ERROR, "Unable to open %s for writing\n", temp_filename);
         return ret;
@@ -774,12 +824,22 @@ static int dash_init(AVFormatContext *s)
             ff_dash_fill_tmpl_params(os->initfile, sizeof(os->initfile), c->init_seg_name, i, 0, os->bit_rate, 0);
         }
         snprintf(filename, sizeof(filename), "%s%s", c->dirname, os->initfile);
-        ret = s->io_open(s, &os->out, filename, AVIO_FLAG_WRITE, NULL);
+        set_http_options(&opts, c);
+        ret = s->io_open(s, &os->out, filename, AVIO_FLAG_WRITE, &opts);
+        av_dict_free(&opts);
         if (ret < 0)
             return ret;
         os->init_start_pos = 0;
 
-        if (!strcmp(os->format_name, "mp4")) {
+        if (is_streaming(c, os)) {
+            // write each fragment to the segment file as soon as it is cut
+            if (c->frag_duration) {
+                av_dict_set(&opts, "movflags", "frag_custom+dash+delay_moov", 0);
+                dict_set_int(&opts, "frag_duration", c->frag_duration, 0);
+            } else {
+                av_dict_set(&opts, "movflags", "frag_custom+dash+delay_moov+frag_every_frame", 0);
+            }
+        } else if (!strcmp(os->format_name, "mp4")) {
             av_dict_set(&opts, "movflags", "frag_custom+dash+delay_moov", 0);
         } else {
             dict_set_int(&opts, "cluster_time_limit", c->min_seg_duration / 1000, 0);
@@ -849,6 +909,18 @@ static int dash_write_header(AVFormatContext *s)
     return ret;
 }
 
+/* Drop all segments along with the timeline runs describing them, so that
+ * both lists stay consistent after an allocation failure. */
+static void reset_segments(OutputStream *os)
+{
+    int i;
+
+    for (i = 0; i < os->nb_segments; i++)
+        av_freep(&os->segments[i]);
+    os->nb_segments = 0;
+    os->nb_runs     = 0;
+}
+
 static int add_segment(OutputStream *os, const char *file,
                        int64_t time, int duration,
                        int64_t start_pos, int64_t range_length,
@@ -862,6 +934,17 @@ static int add_segment(OutputStream *os, const char *file,
                                os->segments_size)) < 0) {
             os->segments_size = 0;
             os->nb_segments = 0;
+            os->nb_runs = 0;
+            return err;
+        }
+    }
+    /* Make room for a new run before adding the segment; the segment may
+     * still extend the last run. */
+    if (os->nb_runs >= os->runs_size) {
+        os->runs_size = (os->runs_size + 1) * 2;
+        if ((err = av_reallocp_array(&os->runs, os->runs_size, sizeof(*os->runs))) < 0) {
+            os->runs_size = 0;
+            reset_segments(os);
             return err;
         }
     }
@@ -880,9 +963,42 @@ static int add_segment(OutputStream *os, const char *file,
     seg->index_length = index_length;
     os->segments[os->nb_segments++] = seg;
     os->segment_index++;
+
+    if (os->nb_runs) {
+        TimelineRun *run = &os->runs[os->nb_runs - 1];
+        if (run->duration == seg->duration &&
+            run->time + (int64_t)run->nb_segments * run->duration == seg->time) {
+            run->nb_segments++;
+            return 0;
+        }
+    }
+    os->runs[os->nb_runs].time        = seg->time;
+    os->runs[os->nb_runs].duration    = seg->duration;
+    os->runs[os->nb_runs].nb_segments = 1;
+    os->nb_runs++;
     return 0;
 }
 
+static void remove_segments(OutputStream *os, int remove)
+{
+    int i;
+
+    os->nb_segments -= remove;
+    memmove(os->segments, os->segments + remove, os->nb_segments * sizeof(*os->segments));
+
+    for (i = 0; i < os->nb_runs && remove > 0; i++) {
+        TimelineRun *run = &os->runs[i];
+        int n = FFMIN(remove, run->nb_segments);
+        run->time        += (int64_t)n * run->duration;
+        run->nb_segments -= n;
+        remove           -= n;
+        if (run->nb_segments)
+            break;
+    }
+    os->nb_runs -= i;
+    memmove(os->runs, os->runs + i, os->nb_runs * sizeof(*os->runs));
+}
+
 static void write_styp(AVIOContext *pb)
 {
     avio_wb32(pb, 24);
@@ -955,6 +1071,7 @@ static int dash_flush(AVFormatContext *s, int final, int stream)
         OutputStream *os = &c->streams[i];
         char filename[1024] = "", full_path[1024], temp_path[1024];
         int range_length, index_length = 0;
+        AVDictionary *opts = NULL;
 
         if (!os->packets_written)
             continue;
@@ -978,12 +1095,16 @@ static int dash_flush(AVFormatContext *s, int final, int stream)
         if (!c->single_file) {
             ff_dash_fill_tmpl_params(filename, sizeof(filename), c->media_seg_name, i, os->segment_index, os->bit_rate, os->start_pts);
             snprintf(full_path, sizeof(full_path), "%s%s", c->dirname, filename);
-            snprintf(temp_path, sizeof(temp_path), use_rename ? "%s.tmp" : "%s", full_path);
-            ret = s->io_open(s, &os->out, temp_path, AVIO_FLAG_WRITE, NULL);
-            if (ret < 0)
-                break;
-            if (!strcmp(os->format_name, "mp4"))
-                write_styp(os->ctx->pb);
+            snprintf(temp_path, sizeof(temp_path), use_rename && !is_streaming(c, os) ? "%s.tmp" : "%s", full_path);
+            if (!os->out) {
+                set_http_options(&opts, c);
+                ret = s->io_open(s, &os->out, temp_path, AVIO_FLAG_WRITE, &opts);
+                av_dict_free(&opts);
+                if (ret < 0)
+                    break;
+                if (!strcmp(os->format_name, "mp4"))
+                    write_styp(os->ctx->pb);
+            }
         } else {
             snprintf(full_path, sizeof(full_path), "%s%s", c->dirname, os->initfile);
         }
@@ -998,7 +1119,7 @@ static int dash_flush(AVFormatContext *s, int final, int stream)
         } else {
             ff_format_io_close(s, &os->out);
 
-            if (use_rename) {
+            if (use_rename && !is_streaming(c, os)) {
                 ret = avpriv_io_move(temp_path, full_path);
                 if (ret < 0)
                     break;
@@ -1034,8 +1155,7 @@ static int dash_flush(AVFormatContext *s, int final, int stream)
                     unlink(filename);
                     av_free(os->segments[j]);
                 }
-                os->nb_segments -= remove;
-                memmove(os->segments, os->segments + remove, os->nb_segments * sizeof(*os->segments));
+                remove_segments(os, remove);
             }
         }
     }
@@ -1045,6 +1165,43 @@ static int dash_flush(AVFormatContext *s, int final, int stream)
     return ret;
 }
 
+/* Write the fragments cut so far to the segment file in streaming mode. */
+static int write_streaming_chunk(AVFormatContext *s, int stream)
+{
+    DASHContext *c = s->priv_data;
+    OutputStream *os = &c->streams[stream];
+    AVDictionary *opts = NULL;
+    uint8_t *buffer;
+    int ret, len;
+
+    // the moov is written once the first packet is known
+    if (!os->init_range_length && (ret = flush_init_segment(s, os)) < 0)
+        return ret;
+
+    if (!os->out) {
+        char filename[1024], full_path[1024];
+
+        // the segment is written under its final name, so that it can be
+        // read while it is being written
+        ff_dash_fill_tmpl_params(filename, sizeof(filename), c->media_seg_name, stream, os->segment_index, os->bit_rate, os->start_pts);
+        snprintf(full_path, sizeof(full_path), "%s%s", c->dirname, filename);
+        set_http_options(&opts, c);
+        ret = s->io_open(s, &os->out, full_path, AVIO_FLAG_WRITE, &opts);
+        av_dict_free(&opts);
+        if (ret < 0)
+            return ret;
+        write_styp(os->ctx->pb);
+    }
+
+    len = avio_get_dyn_buf(os->ctx->pb, &buffer);
+    if (len > os->written_len) {
+        avio_write(os->out, buffer + os->written_len, len - os->written_len);
+        avio_flush(os->out);
+        os->written_len = len;
+    }
+    return 0;
+}
+
 static int dash_write_packet(AVFormatContext *s, AVPacket *pkt)
 {
     DASHContext *c = s->priv_data;
@@ -1117,7 +1274,14 @@ static int dash_write_packet(AVFormatContext *s, AVPacket *pkt)
     else
         os->max_pts = FFMAX(os->max_pts, pkt->pts + pkt->duration);
     os->packets_written++;
-    return ff_write_chained(os->ctx, 0, pkt, s, 0);
+    if (is_streaming(c, os))
+        os->chunk_duration = FFMAX(os->chunk_duration,
+                                   av_rescale_q(pkt->duration, st->time_base, AV_TIME_BASE_Q));
+    if ((ret = ff_write_chained(os->ctx, 0, pkt, s, 0)) < 0)
+        return ret;
+    if (is_streaming(c, os))
+        return write_streaming_chunk(s, pkt->stream_index);
+    return 0;
 }
 
 static int dash_write_trailer(AVFormatContext *s)
@@ -1190,6 +1354,9 @@ static const AVOption options[] = {
     { "init_seg_name", "DASH-templated name to used for the initialization segment", OFFSET(init_seg_name), AV_OPT_TYPE_STRING, {.str = "init-stream$RepresentationID$.m4s"}, 0, 0, E },
     { "media_seg_name", "DASH-templated name to used for the media segments", OFFSET(media_seg_name), AV_OPT_TYPE_STRING, {.str = "chunk-stream$RepresentationID$-$Number%05d$.m4s"}, 0, 0, E },
     { "utc_timing_url", "URL of the page that will return the UTC timestamp in ISO format", OFFSET(utc_timing_url), AV_OPT_TYPE_STRING, { 0 }, 0, 0, E },
+    { "streaming", "Write mp4 fragments to the segment files as soon as they are cut", OFFSET(streaming), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, E },
+    { "frag_duration", "fragment duration in streaming mode (in microseconds), 0 for one fragment per frame", OFFSET(frag_duration), AV_OPT_TYPE_INT64, { .i64 = 0 }, 0, INT_MAX, E },
+    { "connection_pool", "reuse HTTP connections between uploads", OFFSET(connection_pool), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, E },
     { NULL },
 };
 
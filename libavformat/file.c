@@ -20,6 +20,7 @@
  */
 
 #include "libavutil/avstring.h"
+#include "libavutil/buffer.h"
 #include "libavutil/internal.h"
 #include "libavutil/opt.h"
 #include "avformat.h"
@@ -35,6 +36,9 @@
 #endif
 #include <sys/stat.h>
 #include <stdlib.h>
+#if HAVE_MMAP
+#include <sys/mman.h>
+#endif
 #include "os_support.h"
 #include "url.h"
 
@@ -65,6 +69,14 @@
 #  endif
 #endif
 
+/* Amount of data ahead of the read position the kernel is asked to
+ * prefetch when reading through a memory mapping. */
+#define MMAP_PREFETCH_SIZE (8 << 20)
+
+/* Packets smaller than this are copied, as mapping them on their own costs
+ * more than the copy. */
+#define MMAP_MIN_PACKET_SIZE (64 << 10)
+
 /* standard file protocol */
 
 typedef struct FileContext {
@@ -73,15 +85,26 @@ typedef struct FileContext {
     int trunc;
     int blocksize;
     int follow;
+    int use_mmap;
 #if HAVE_DIRENT_H
     DIR *dir;
 #endif
+#if HAVE_MMAP
+    AVBufferRef *map;       ///< whole file mapping, NULL if not mapped
+    int64_t map_size;
+    int64_t pos;            ///< read position when the file is mapped
+    int64_t prefetch_end;
+    int64_t page_size;
+#endif
 } FileContext;
 
 static const AVOption file_options[] = {
     { "truncate", "truncate existing files on write", offsetof(FileContext, trunc), AV_OPT_TYPE_BOOL, { .i64 = 1 }, 0, 1, AV_OPT_FLAG_ENCODING_PARAM },
     { "blocksize", "set I/O operation maximum block size", offsetof(FileContext, blocksize), AV_OPT_TYPE_INT, { .i64 = INT_MAX }, 1, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM },
     { "follow", "Follow a file as it is being written", offsetof(FileContext, follow), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, 1, AV_OPT_FLAG_DECODING_PARAM },
+#if HAVE_MMAP
+    { "mmap", "memory map the file for reading", offsetof(FileContext, use_mmap), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, AV_OPT_FLAG_DECODING_PARAM },
+#endif
     { NULL }
 };
 
@@ -104,11 +127,120 @@ static const AVClass pipe_class = {
     .version    = LIBAVUTIL_VERSION_INT,
 };
 
+#if HAVE_MMAP
+static void file_prefetch(FileContext *c, int64_t pos)
+{
+#ifdef MADV_WILLNEED
+    int64_t start, end;
+
+    if (pos + MMAP_PREFETCH_SIZE / 2 < c->prefetch_end)
+        return;
+    start = FFMAX(pos, c->prefetch_end) & ~(int64_t)4095;
+    end   = FFMIN(pos + MMAP_PREFETCH_SIZE, c->map_size);
+    if (start < end)
+        madvise(c->map->data + start, end - start, MADV_WILLNEED);
+    c->prefetch_end = end;
+#endif
+}
+
+static int file_read_mapped(URLContext *h, unsigned char *buf, int size)
+{
+    FileContext *c = h->priv_data;
+
+    if (c->pos >= c->map_size)
+        return AVERROR_EOF;
+    size = FFMIN(size, c->map_size - c->pos);
+    file_prefetch(c, c->pos);
+    memcpy(buf, c->map->data + c->pos, size);
+    c->pos += size;
+    return size;
+}
+
+static void file_unmap(void *opaque, uint8_t *data)
+{
+    munmap(data, (size_t)(uintptr_t)opaque);
+}
+
+static int file_get_buffer_ref(URLContext *h, int64_t pos, int size,
+                               AVBufferRef **buf, uint8_t **data)
+{
+    FileContext *c = h->priv_data;
+    int64_t offset;
+    size_t len;
+    uint8_t *map;
+
+    /* The padding must be readable too, as it is accessed by decoders. */
+    if (!c->map || pos < 0 || size <= 0 ||
+        pos > c->map_size - size - AV_INPUT_BUFFER_PADDING_SIZE)
+        return AVERROR(ENOSYS);
+    file_prefetch(c, pos);
+    if (!buf) {
+        *data = c->map->data + pos;
+        return size;
+    }
+    if (size < MMAP_MIN_PACKET_SIZE)
+        return AVERROR(ENOSYS);
+
+    /* Data handed out with a reference gets its own private mapping of the
+     * same pages: writes to it are copy-on-write, so the padding can be
+     * zeroed and the data modified in place like any packet. */
+    offset = pos & ~(c->page_size - 1);
+    len    = pos - offset + size + AV_INPUT_BUFFER_PADDING_SIZE;
+    map    = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, c->fd, offset);
+    if (map == MAP_FAILED)
+        return AVERROR(ENOSYS);
+    *buf = av_buffer_create(map, len, file_unmap, (void *)(uintptr_t)len, 0);
+    if (!*buf) {
+        munmap(map, len);
+        return AVERROR(ENOMEM);
+    }
+    *data = map + (pos - offset);
+    memset(*data + size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+    return size;
+}
+
+static void file_map(URLContext *h, const struct stat *st)
+{
+    FileContext *c = h->priv_data;
+    void *map;
+
+    if (!S_ISREG(st->st_mode) || st->st_size <= 0 ||
+        st->st_size > FFMIN(SIZE_MAX, INT64_MAX) - 1)
+        return;
+    map = mmap(NULL, st->st_size, PROT_READ, MAP_SHARED, c->fd, 0);
+    if (map == MAP_FAILED) {
+        av_log(h, AV_LOG_VERBOSE, "Cannot map file, using read(): %s\n",
+               av_err2str(AVERROR(errno)));
+        return;
+    }
+    c->map = av_buffer_create(map, st->st_size, file_unmap,
+                              (void *)(uintptr_t)st->st_size,
+                              AV_BUFFER_FLAG_READONLY);
+    if (!c->map) {
+        munmap(map, st->st_size);
+        return;
+    }
+#ifdef MADV_SEQUENTIAL
+    madvise(map, st->st_size, MADV_SEQUENTIAL);
+#endif
+    c->map_size     = st->st_size;
+    c->pos          = 0;
+    c->prefetch_end = 0;
+    c->page_size    = sysconf(_SC_PAGESIZE);
+    if (c->page_size <= 0)
+        c->page_size = 4096;
+}
+#endif /* HAVE_MMAP */
+
 static int file_read(URLContext *h, unsigned char *buf, int size)
 {
     FileContext *c = h->priv_data;
     int ret;
     size = FFMIN(size, c->blocksize);
+#if HAVE_MMAP
+    if (c->map)
+        return file_read_mapped(h, buf, size);
+#endif
     ret = read(c->fd, buf, size);
     if (ret == 0 && c->follow)
         return AVERROR(EAGAIN);
@@ -234,6 +366,12 @@ static int file_open(URLContext *h, const char *filename, int flags)
     if (!h->is_streamed && flags & AVIO_FLAG_WRITE)
         h->min_packet_size = h->max_packet_size = 262144;
 
+#if HAVE_MMAP
+    /* A file that is still growing cannot be mapped once and for all. */
+    if (c->use_mmap && !(flags & AVIO_FLAG_WRITE) && !c->follow && !h->is_streamed)
+        file_map(h, &st);
+#endif
+
     return 0;
 }
 
@@ -249,6 +387,21 @@ static int64_t file_seek(URLContext *h, int64_t pos, int whence)
         return ret < 0 ? AVERROR(errno) : (S_ISFIFO(st.st_mode) ? 0 : st.st_size);
     }
 
+#if HAVE_MMAP
+    if (c->map) {
+        if (whence == SEEK_CUR)
+            pos += c->pos;
+        else if (whence == SEEK_END)
+            pos += c->map_size;
+        else if (whence != SEEK_SET)
+            return AVERROR(EINVAL);
+        if (pos < 0)
+            return AVERROR(EINVAL);
+        c->pos = pos;
+        return pos;
+    }
+#endif
+
     ret = lseek(c->fd, pos, whence);
 
     return ret < 0 ? AVERROR(errno) : ret;
@@ -257,6 +410,10 @@ static int64_t file_seek(URLContext *h, int64_t pos, int whence)
 static int file_close(URLContext *h)
 {
     FileContext *c = h->priv_data;
+#if HAVE_MMAP
+    /* Packets may still reference the mapping, it outlives the descriptor. */
+    av_buffer_unref(&c->map);
+#endif
     return close(c->fd);
 }
 
@@ -360,6 +517,9 @@ const URLProtocol ff_file_protocol = {
     .url_open_dir        = file_open_dir,
     .url_read_dir        = file_read_dir,
     .url_close_dir       = file_close_dir,
+#if HAVE_MMAP
+    .url_get_buffer_ref  = file_get_buffer_ref,
+#endif
     .default_whitelist   = "file,crypto"
 };
 
@@ -33,6 +33,7 @@
 #include "libavutil/opt.h"
 #include "libavutil/dict.h"
 #include "libavutil/time.h"
+#include "libavutil/thread.h"
 #include "avformat.h"
 #include "internal.h"
 #include "avio_internal.h"
@@ -46,6 +47,9 @@
 #define MPEG_TIME_BASE 90000
 #define MPEG_TIME_BASE_Q (AVRational){1, MPEG_TIME_BASE}
 
+#define PREFETCH_READ_SIZE 65536
+#define MAX_PREFETCH_SIZE  (64 << 20)
+
 /*
  * An apple http stream consists of a playlist with media segment files,
  * played sequentially. There may be several playlists with the same
@@ -78,6 +82,32 @@ struct segment {
 
 struct rendition;
 
+/*
+ * The next segment of a playlist, downloaded by a background thread while
+ * the current one is being demuxed. Data beyond MAX_PREFETCH_SIZE is read
+ * from the input once the buffered data has been consumed.
+ */
+struct segment_prefetch {
+    AVIOContext *input;
+    int seq_no;
+    char *url;
+    int64_t size;           /* bytes to read, -1 until the end of input */
+    uint8_t *data;
+    unsigned int data_size;
+    unsigned int filled;
+    unsigned int read_pos;
+    int truncated;          /* stopped at MAX_PREFETCH_SIZE */
+    int ret;                /* 0 while downloading */
+    int abort;
+    int running;            /* the input is used by the download thread */
+    AVIOInterruptCB int_cb; /* interrupt callback of the demuxer */
+#if HAVE_THREADS
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+#endif
+};
+
 enum PlaylistType {
     PLS_TYPE_UNSPECIFIED,
     PLS_TYPE_EVENT,
@@ -94,6 +124,8 @@ struct playlist {
     AVIOContext pb;
     uint8_t* read_buffer;
     AVIOContext *input;
+    struct segment_prefetch *cur_prefetch; /* replaces input if set */
+    struct segment_prefetch *prefetch;
     AVFormatContext *parent;
     int index;
     AVFormatContext *ctx;
@@ -206,8 +238,11 @@ typedef struct HLSContext {
     int strict_std_compliance;
     char *allowed_extensions;
     int max_reload;
+    int prefetch_segments;
 } HLSContext;
 
+static void free_prefetch(struct playlist *pls, struct segment_prefetch **ppf);
+
 static int read_chomp_line(AVIOContext *s, char *buf, int maxlen)
 {
     int len = ff_get_line(s, buf, maxlen);
@@ -256,6 +291,8 @@ static void free_playlist_list(HLSContext *c)
         av_freep(&pls->pb.buffer);
         if (pls->input)
             ff_format_io_close(c->ctx, &pls->input);
+        free_prefetch(pls, &pls->cur_prefetch);
+        free_prefetch(pls, &pls->prefetch);
         if (pls->ctx) {
             pls->ctx->pb = NULL;
             avformat_close_input(&pls->ctx);
@@ -878,6 +915,50 @@ enum ReadFromURLMode {
     READ_COMPLETE,
 };
 
+#if HAVE_THREADS
+static int read_prefetched(struct segment_prefetch *pf, uint8_t *buf,
+                           int buf_size, int complete)
+{
+    int len = 0, interrupted = 0, truncated, ret;
+
+    pthread_mutex_lock(&pf->lock);
+    while (len < buf_size) {
+        if (pf->read_pos < pf->filled) {
+            int size = FFMIN(buf_size - len, pf->filled - pf->read_pos);
+            memcpy(buf + len, pf->data + pf->read_pos, size);
+            pf->read_pos += size;
+            len          += size;
+            if (!complete)
+                break;
+        } else if (pf->ret) {
+            break;
+        } else {
+            int64_t t = av_gettime() + 100000;
+            struct timespec tv = { .tv_sec  =  t / 1000000,
+                                   .tv_nsec = (t % 1000000) * 1000 };
+            if (ff_check_interrupt(&pf->int_cb)) {
+                interrupted = 1;
+                break;
+            }
+            pthread_cond_timedwait(&pf->cond, &pf->lock, &tv);
+        }
+    }
+    ret       = interrupted ? AVERROR_EXIT : pf->ret;
+    truncated = pf->truncated;
+    pthread_mutex_unlock(&pf->lock);
+
+    /* The download thread is done with the input once ret is set. */
+    if (len < buf_size && !interrupted && truncated && pf->read_pos == pf->filled) {
+        int size = avio_read(pf->input, buf + len, buf_size - len);
+        if (size > 0)
+            len += size;
+        else if (!len)
+            return size;
+    }
+    return len ? len : ret;
+}
+#endif
+
 static int read_from_url(struct playlist *pls, struct segment *seg,
                          uint8_t *buf, int buf_size,
                          enum ReadFromURLMode mode)
@@ -888,6 +969,13 @@ static int read_from_url(struct playlist *pls, struct segment *seg,
     if (seg->size >= 0)
         buf_size = FFMIN(buf_size, seg->size - pls->cur_seg_offset);
 
+#if HAVE_THREADS
+    if (pls->cur_prefetch) {
+        ret = read_prefetched(pls->cur_prefetch, buf, buf_size, mode == READ_COMPLETE);
+        if (mode == READ_COMPLETE && ret != buf_size)
+            av_log(NULL, AV_LOG_ERROR, "Could not read complete segment.\n");
+    } else
+#endif
     if (mode == READ_COMPLETE) {
         ret = avio_read(pls->input, buf, buf_size);
         if (ret != buf_size)
@@ -1098,7 +1186,8 @@ static void intercept_id3(struct playlist *pls, uint8_t *buf,
         pls->is_id3_timestamped = (pls->id3_mpegts_timestamp != AV_NOPTS_VALUE);
 }
 
-static int open_input(HLSContext *c, struct playlist *pls, struct segment *seg)
+static int open_input(HLSContext *c, struct playlist *pls, struct segment *seg,
+                      AVIOContext **in)
 {
     AVDictionary *opts = NULL;
     int ret;
@@ -1122,7 +1211,7 @@ static int open_input(HLSContext *c, struct playlist *pls, struct segment *seg)
            seg->url, seg->url_offset, pls->index);
 
     if (seg->key_type == KEY_NONE) {
-        ret = open_url(pls->parent, &pls->input, seg->url, c->avio_opts, opts, &is_http);
+        ret = open_url(pls->parent, in, seg->url, c->avio_opts, opts, &is_http);
     } else if (seg->key_type == KEY_AES_128) {
         AVDictionary *opts2 = NULL;
         char iv[33], key[33], url[MAX_URL_SIZE];
@@ -1153,7 +1242,7 @@ static int open_input(HLSContext *c, struct playlist *pls, struct segment *seg)
         av_dict_set(&opts2, "key", key, 0);
         av_dict_set(&opts2, "iv", iv, 0);
 
-        ret = open_url(pls->parent, &pls->input, url, opts2, opts, &is_http);
+        ret = open_url(pls->parent, in, url, opts2, opts, &is_http);
 
         av_dict_free(&opts2);
 
@@ -1180,20 +1269,175 @@ static int open_input(HLSContext *c, struct playlist *pls, struct segment *seg)
      * noticed without the call, though.
      */
     if (ret == 0 && !is_http && seg->key_type == KEY_NONE && seg->url_offset) {
-        int64_t seekret = avio_seek(pls->input, seg->url_offset, SEEK_SET);
+        int64_t seekret = avio_seek(*in, seg->url_offset, SEEK_SET);
         if (seekret < 0) {
             av_log(pls->parent, AV_LOG_ERROR, "Unable to seek to offset %"PRId64" of HLS segment '%s'\n", seg->url_offset, seg->url);
             ret = seekret;
-            ff_format_io_close(pls->parent, &pls->input);
+            ff_format_io_close(pls->parent, in);
         }
     }
 
 cleanup:
     av_dict_free(&opts);
-    pls->cur_seg_offset = 0;
     return ret;
 }
 
+#if HAVE_THREADS
+/* The interrupt callback of the demuxer is only called while the input is
+ * used by the demuxing thread, the download thread only stops on abort. */
+static int prefetch_interrupt(void *opaque)
+{
+    struct segment_prefetch *pf = opaque;
+    int abort, running;
+
+    pthread_mutex_lock(&pf->lock);
+    abort   = pf->abort;
+    running = pf->running;
+    pthread_mutex_unlock(&pf->lock);
+    return abort || (!running && ff_check_interrupt(&pf->int_cb));
+}
+
+static void *prefetch_thread(void *arg)
+{
+    struct segment_prefetch *pf = arg;
+    int ret;
+
+    pthread_mutex_lock(&pf->lock);
+    for (;;) {
+        int size = PREFETCH_READ_SIZE;
+        uint8_t *data;
+
+        if (pf->abort) {
+            ret = AVERROR_EXIT;
+            break;
+        }
+        if (pf->size >= 0 && pf->size - pf->filled < size)
+            size = pf->size - pf->filled;
+        if (size <= 0) {
+            ret = AVERROR_EOF;
+            break;
+        }
+        if (pf->filled + size > MAX_PREFETCH_SIZE) {
+            pf->truncated = 1;
+            ret = AVERROR_EOF;
+            break;
+        }
+        data = av_fast_realloc(pf->data, &pf->data_size, pf->filled + size);
+        if (!data) {
+            ret = AVERROR(ENOMEM);
+            break;
+        }
+        pf->data = data;
+        pthread_mutex_unlock(&pf->lock);
+
+        /* Only this thread moves the buffer or writes past pf->filled. */
+        size = avio_read(pf->input, data + pf->filled, size);
+
+        pthread_mutex_lock(&pf->lock);
+        if (size <= 0) {
+            ret = size ? size : AVERROR_EOF;
+            break;
+        }
+        pf->filled += size;
+        pthread_cond_signal(&pf->cond);
+    }
+    pf->ret     = ret;
+    pf->running = 0;
+    pthread_cond_signal(&pf->cond);
+    pthread_mutex_unlock(&pf->lock);
+
+    return NULL;
+}
+
+static void free_prefetch(struct playlist *pls, struct segment_prefetch **ppf)
+{
+    struct segment_prefetch *pf = *ppf;
+
+    if (!pf)
+        return;
+    pthread_mutex_lock(&pf->lock);
+    pf->abort = 1;
+    pthread_mutex_unlock(&pf->lock);
+    pthread_join(pf->thread, NULL);
+    /* closing may still call the interrupt callback */
+    ff_format_io_close(pls->parent, &pf->input);
+    pthread_cond_destroy(&pf->cond);
+    pthread_mutex_destroy(&pf->lock);
+    av_freep(&pf->data);
+    av_freep(&pf->url);
+    av_freep(ppf);
+}
+
+/* Start downloading the segment following the current one. */
+static void start_prefetch(HLSContext *c, struct playlist *pls)
+{
+    AVFormatContext *s = pls->parent;
+    struct segment_prefetch *pf;
+    struct segment *seg, *next;
+    int ret;
+
+    if (!c->prefetch_segments || pls->prefetch ||
+        pls->cur_seq_no + 1 >= pls->start_seq_no + pls->n_segments)
+        return;
+    seg  = current_segment(pls);
+    next = pls->segments[pls->cur_seq_no + 1 - pls->start_seq_no];
+    /* A new initialization section is only loaded when opening the segment. */
+    if (next->init_section != seg->init_section)
+        return;
+
+    pf = av_mallocz(sizeof(*pf));
+    if (!pf)
+        return;
+    pf->seq_no = pls->cur_seq_no + 1;
+    pf->size   = next->size;
+    pf->url    = av_strdup(next->url);
+    pf->int_cb = s->interrupt_callback;
+    if (!pf->url)
+        goto fail;
+
+    if ((ret = pthread_mutex_init(&pf->lock, NULL)))
+        goto fail;
+    if ((ret = pthread_cond_init(&pf->cond, NULL)))
+        goto cond_fail;
+
+    /* The input, and the protocols it nests, take the interrupt callback
+     * of the demuxer when opened, give them one which can stop them on
+     * abort without calling the callback of the caller in the thread. */
+    s->interrupt_callback.callback = prefetch_interrupt;
+    s->interrupt_callback.opaque   = pf;
+    ret = open_input(c, pls, next, &pf->input);
+    s->interrupt_callback = pf->int_cb;
+    if (ret < 0)
+        goto thread_fail;
+
+    pf->running = 1;
+    if ((ret = pthread_create(&pf->thread, NULL, prefetch_thread, pf)))
+        goto thread_fail;
+    pls->prefetch = pf;
+    return;
+
+thread_fail:
+    if (pf->input)
+        ff_format_io_close(s, &pf->input);
+    pthread_cond_destroy(&pf->cond);
+cond_fail:
+    pthread_mutex_destroy(&pf->lock);
+fail:
+    av_log(s, AV_LOG_VERBOSE, "Not prefetching segment %d of playlist %d\n",
+           pf->seq_no, pls->index);
+    av_freep(&pf->url);
+    av_freep(&pf);
+}
+#else
+static void free_prefetch(struct playlist *pls, struct segment_prefetch **ppf)
+{
+}
+
+static void start_prefetch(HLSContext *c, struct playlist *pls)
+{
+}
+#endif
+
 static int update_init_section(struct playlist *pls, struct segment *seg)
 {
     static const int max_init_section_size = 1024*1024;
@@ -1210,7 +1454,8 @@ static int update_init_section(struct playlist *pls, struct segment *seg)
     if (!seg->init_section)
         return 0;
 
-    ret = open_input(c, pls, seg->init_section);
+    ret = open_input(c, pls, seg->init_section, &pls->input);
+    pls->cur_seg_offset = 0;
     if (ret < 0) {
         av_log(pls->parent, AV_LOG_WARNING,
                "Failed to open an initialization section in playlist %d\n",
@@ -1270,7 +1515,7 @@ restart:
     if (!v->needed)
         return AVERROR_EOF;
 
-    if (!v->input) {
+    if (!v->input && !v->cur_prefetch) {
         int64_t reload_interval;
         struct segment *seg;
 
@@ -1336,16 +1581,25 @@ reload:
         if (ret)
             return ret;
 
-        ret = open_input(c, v, seg);
-        if (ret < 0) {
-            if (ff_check_interrupt(c->interrupt_callback))
-                return AVERROR_EXIT;
-            av_log(v->parent, AV_LOG_WARNING, "Failed to open segment of playlist %d\n",
-                   v->index);
-            v->cur_seq_no += 1;
-            goto reload;
+        v->cur_seg_offset = 0;
+        if (v->prefetch && v->prefetch->seq_no == v->cur_seq_no &&
+            !strcmp(v->prefetch->url, seg->url)) {
+            v->cur_prefetch = v->prefetch;
+            v->prefetch     = NULL;
+        } else {
+            free_prefetch(v, &v->prefetch);
+            ret = open_input(c, v, seg, &v->input);
+            if (ret < 0) {
+                if (ff_check_interrupt(c->interrupt_callback))
+                    return AVERROR_EXIT;
+                av_log(v->parent, AV_LOG_WARNING, "Failed to open segment of playlist %d\n",
+                       v->index);
+                v->cur_seq_no += 1;
+                goto reload;
+            }
         }
         just_opened = 1;
+        start_prefetch(c, v);
     }
 
     if (v->init_sec_buf_read_offset < v->init_sec_data_len) {
@@ -1366,7 +1620,10 @@ reload:
 
         return ret;
     }
-    ff_format_io_close(v->parent, &v->input);
+    if (v->cur_prefetch)
+        free_prefetch(v, &v->cur_prefetch);
+    else
+        ff_format_io_close(v->parent, &v->input);
     v->cur_seq_no++;
 
     c->cur_seq_no = v->cur_seq_no;
@@ -1499,7 +1756,8 @@ static int save_avio_options(AVFormatContext *s)
 {
     HLSContext *c = s->priv_data;
     static const char * const opts[] = {
-        "headers", "http_proxy", "user_agent", "user-agent", "cookies", NULL };
+        "headers", "http_proxy", "user_agent", "user-agent", "cookies",
+        "connection_pool", "pool_idle_timeout", NULL };
     const char * const * opt = opts;
     uint8_t *buf;
     int ret = 0;
@@ -1869,6 +2127,8 @@ static int recheck_discard_flags(AVFormatContext *s, int first)
         } else if (first && !pls->cur_needed && pls->needed) {
             if (pls->input)
                 ff_format_io_close(pls->parent, &pls->input);
+            free_prefetch(pls, &pls->cur_prefetch);
+            free_prefetch(pls, &pls->prefetch);
             pls->needed = 0;
             changed = 1;
             av_log(s, AV_LOG_INFO, "No longer receiving playlist %d\n", i);
@@ -2103,6 +2363,8 @@ static int hls_read_seek(AVFormatContext *s, int stream_index,
         struct playlist *pls = c->playlists[i];
         if (pls->input)
             ff_format_io_close(pls->parent, &pls->input);
+        free_prefetch(pls, &pls->cur_prefetch);
+        free_prefetch(pls, &pls->prefetch);
         av_packet_unref(&pls->pkt);
         reset_packet(&pls->pkt);
         pls->pb.eof_reached = 0;
@@ -2157,6 +2419,8 @@ static const AVOption hls_options[] = {
         INT_MIN, INT_MAX, FLAGS},
     {"max_reload", "Maximum number of times a insufficient list is attempted to be reloaded",
         OFFSET(max_reload), AV_OPT_TYPE_INT, {.i64 = 1000}, 0, INT_MAX, FLAGS},
+    {"prefetch_segments", "download the next segment while demuxing the current one",
+        OFFSET(prefetch_segments), AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, FLAGS},
     {NULL}
 };
 
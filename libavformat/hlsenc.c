@@ -36,10 +36,14 @@
 #include "libavutil/mathematics.h"
 #include "libavutil/parseutils.h"
 #include "libavutil/avstring.h"
+#include "libavutil/bprint.h"
 #include "libavutil/intreadwrite.h"
 #include "libavutil/random_seed.h"
 #include "libavutil/opt.h"
 #include "libavutil/log.h"
+#include "libavutil/thread.h"
+#include "libavutil/threadmessage.h"
+#include "libavutil/time.h"
 #include "libavutil/time_internal.h"
 
 #include "avformat.h"
@@ -56,6 +60,7 @@ typedef enum {
 #define KEYSIZE 16
 #define LINE_BUFFER_SIZE 1024
 #define HLS_MICROSECOND_UNIT   1000000
+#define HLS_TASK_QUEUE_SIZE 64
 
 typedef struct HLSSegment {
     char filename[1024];
@@ -88,6 +93,33 @@ typedef enum HLSFlags {
     HLS_PERIODIC_REKEY = (1 << 12),
 } HLSFlags;
 
+/**
+ * File operations done at a segment boundary. They are executed in order,
+ * either directly or by the background worker when hls_async_io is set.
+ * The worker calls s->io_open and s->io_close concurrently with the muxing
+ * thread.
+ */
+typedef enum HLSTaskType {
+    HLS_TASK_CLOSE,     ///< close a finished segment
+    HLS_TASK_RENAME,    ///< rename filename to target
+    HLS_TASK_WRITE,     ///< write data to filename, then rename it to target if set
+    HLS_TASK_DELETE,    ///< delete filename
+    HLS_TASK_BOUNDARY,  ///< account the timing of a segment boundary
+} HLSTaskType;
+
+typedef struct HLSTask {
+    HLSTaskType type;
+    AVIOContext *pb;
+    char *filename;
+    char *target;
+    uint8_t *data;
+    int size;
+    int http_delete;
+    AVDictionary *options;
+    int64_t start_time;   ///< boundary start, in av_gettime_relative() units
+    int64_t end_time;     ///< time the muxing thread was done with the boundary
+} HLSTask;
+
 typedef enum {
     SEGMENT_TYPE_MPEGTS,
     SEGMENT_TYPE_FMP4,
@@ -146,6 +178,17 @@ typedef struct HLSContext {
     HLSSegment *segments;
     HLSSegment *last_segment;
     HLSSegment *old_segments;
+    unsigned nb_dropped;   // number of segments removed from the head of the list
+
+    /* Serialized playlist entries, only the new segments are appended to it
+     * as long as no segment is removed from the head of the list. */
+    AVBPrint body;
+    HLSSegment *body_last; // last segment serialized in body
+    unsigned body_dropped; // nb_dropped when body was started
+    int body_target_duration;
+    double body_prog_date_time;
+    const char *body_key_uri;
+    const char *body_iv_string;
 
     char *basename;
     char *base_output_dirname;
@@ -175,6 +218,17 @@ typedef struct HLSContext {
     double initial_prog_date_time;
     char current_segment_final_filename_fmt[1024]; // when renaming segments
     char *user_agent;
+    int connection_pool;
+
+    int async_io;
+#if HAVE_THREADS
+    AVThreadMessageQueue *tasks;
+    pthread_t worker;
+#endif
+    int worker_err;
+    int nb_boundaries;
+    int64_t max_stall;    // longest time the muxing thread spent on a boundary
+    int64_t max_latency;  // longest time from a boundary to its publication
 } HLSContext;
 
 static int get_int_from_double(double val)
@@ -228,7 +282,8 @@ static void set_http_options(AVFormatContext *s, AVDictionary **options, HLSCont
     }
     if (c->user_agent)
         av_dict_set(options, "user_agent", c->user_agent, 0);
-
+    if (c->connection_pool)
+        av_dict_set(options, "connection_pool", "1", 0);
 }
 
 static int replace_int_data_in_filename(char *buf, int buf_size, const char *filename, char placeholder, int64_t number)
@@ -293,15 +348,188 @@ static void write_styp(AVIOContext *pb)
     ffio_wfourcc(pb, "msix");
 }
 
+static void hls_free_task(HLSTask *task)
+{
+    av_freep(&task->filename);
+    av_freep(&task->target);
+    av_freep(&task->data);
+    av_dict_free(&task->options);
+}
+
+static int hls_run_task(AVFormatContext *s, HLSTask *task)
+{
+    HLSContext *hls = s->priv_data;
+    AVIOContext *out = NULL;
+    int64_t stall, latency;
+    int ret = 0;
+
+    switch (task->type) {
+    case HLS_TASK_CLOSE:
+        ff_format_io_close(s, &task->pb);
+        break;
+    case HLS_TASK_RENAME:
+        ff_rename(task->filename, task->target, s);
+        break;
+    case HLS_TASK_WRITE:
+        if ((ret = s->io_open(s, &out, task->filename, AVIO_FLAG_WRITE, &task->options)) < 0)
+            break;
+        avio_write(out, task->data, task->size);
+        ff_format_io_close(s, &out);
+        if (task->target)
+            ff_rename(task->filename, task->target, s);
+        break;
+    case HLS_TASK_DELETE:
+        if (task->http_delete) {
+            av_dict_set(&task->options, "method", "DELETE", 0);
+            if ((ret = hls->avf->io_open(hls->avf, &out, task->filename, AVIO_FLAG_WRITE, &task->options)) < 0)
+                break;
+            ff_format_io_close(hls->avf, &out);
+        } else if (unlink(task->filename) < 0) {
+            av_log(hls, AV_LOG_ERROR, "failed to delete old segment %s: %s\n",
+                                     task->filename, strerror(errno));
+        }
+        break;
+    case HLS_TASK_BOUNDARY:
+        stall   = task->end_time - task->start_time;
+        latency = av_gettime_relative() - task->start_time;
+        hls->nb_boundaries++;
+        hls->max_stall   = FFMAX(hls->max_stall, stall);
+        hls->max_latency = FFMAX(hls->max_latency, latency);
+        av_log(hls, AV_LOG_VERBOSE, "segment %s: muxing blocked for %.3f ms, published after %.3f ms\n",
+               task->filename, stall / 1000.0, latency / 1000.0);
+        break;
+    }
+
+    hls_free_task(task);
+    return ret;
+}
+
+#if HAVE_THREADS
+static void *hls_worker_thread(void *arg)
+{
+    AVFormatContext *s = arg;
+    HLSContext *hls = s->priv_data;
+    HLSTask task;
+    int ret;
+
+    while (av_thread_message_queue_recv(hls->tasks, &task, 0) >= 0) {
+        ret = hls_run_task(s, &task);
+        if (ret < 0 && !hls->worker_err) {
+            hls->worker_err = ret;
+            av_thread_message_queue_set_err_send(hls->tasks, ret);
+        }
+    }
+    return NULL;
+}
+
+static int hls_start_worker(AVFormatContext *s)
+{
+    HLSContext *hls = s->priv_data;
+    int ret;
+
+    ret = av_thread_message_queue_alloc(&hls->tasks, HLS_TASK_QUEUE_SIZE, sizeof(HLSTask));
+    if (ret < 0)
+        return ret;
+
+    ret = pthread_create(&hls->worker, NULL, hls_worker_thread, s);
+    if (ret) {
+        av_thread_message_queue_free(&hls->tasks);
+        return AVERROR(ret);
+    }
+    return 0;
+}
+#endif
+
+/* Wait until all queued tasks are done, later tasks are run directly. */
+static int hls_stop_worker(AVFormatContext *s)
+{
+    HLSContext *hls = s->priv_data;
+
+#if HAVE_THREADS
+    if (hls->tasks) {
+        av_thread_message_queue_set_err_recv(hls->tasks, AVERROR_EOF);
+        pthread_join(hls->worker, NULL);
+        av_thread_message_queue_free(&hls->tasks);
+    }
+#endif
+    return hls->worker_err;
+}
+
+/* Takes ownership of the task contents, also on failure. */
+static int hls_submit_task(AVFormatContext *s, HLSTask *task)
+{
+#if HAVE_THREADS
+    HLSContext *hls = s->priv_data;
+    int ret;
+
+    if (hls->tasks) {
+        ret = av_thread_message_queue_send(hls->tasks, task, 0);
+        if (ret < 0) {
+            ff_format_io_close(s, &task->pb);
+            hls_free_task(task);
+        }
+        return ret;
+    }
+#endif
+    return hls_run_task(s, task);
+}
+
+static int hls_close_file(AVFormatContext *s, AVIOContext **pb)
+{
+    HLSTask task = { .type = HLS_TASK_CLOSE, .pb = *pb };
+
+    *pb = NULL;
+    return hls_submit_task(s, &task);
+}
+
+static int hls_rename_file(AVFormatContext *s, const char *filename, const char *target)
+{
+    HLSTask task = { .type = HLS_TASK_RENAME };
+
+    task.filename = av_strdup(filename);
+    task.target   = av_strdup(target);
+    if (!task.filename || !task.target) {
+        hls_free_task(&task);
+        return AVERROR(ENOMEM);
+    }
+    return hls_submit_task(s, &task);
+}
+
+static int hls_write_file(AVFormatContext *s, const char *filename, const char *target,
+                          const uint8_t *data, int size, AVDictionary *options)
+{
+    HLSTask task = { .type = HLS_TASK_WRITE, .size = size };
+
+    task.filename = av_strdup(filename);
+    task.target   = target ? av_strdup(target) : NULL;
+    task.data     = av_memdup(data, size);
+    if (!task.filename || (target && !task.target) || (size && !task.data) ||
+        av_dict_copy(&task.options, options, 0) < 0) {
+        hls_free_task(&task);
+        return AVERROR(ENOMEM);
+    }
+    return hls_submit_task(s, &task);
+}
+
+static int hls_delete_file(AVFormatContext *s, const char *path, int http_delete)
+{
+    HLSContext *hls = s->priv_data;
+    HLSTask task = { .type = HLS_TASK_DELETE, .http_delete = http_delete };
+
+    if (!(task.filename = av_strdup(path)))
+        return AVERROR(ENOMEM);
+    if (http_delete && hls->connection_pool)
+        av_dict_set(&task.options, "connection_pool", "1", 0);
+    return hls_submit_task(s, &task);
+}
+
 static int hls_delete_old_segments(AVFormatContext *s, HLSContext *hls) {
 
     HLSSegment *segment, *previous_segment = NULL;
     float playlist_duration = 0.0f;
-    int ret = 0, path_size, sub_path_size;
+    int ret = 0, path_size, sub_path_size, http_delete;
     char *dirname = NULL, *p, *sub_path;
     char *path = NULL;
-    AVDictionary *options = NULL;
-    AVIOContext *out = NULL;
     const char *proto = NULL;
 
     segment = hls->segments;
@@ -353,15 +581,9 @@ static int hls_delete_old_segments(AVFormatContext *s, HLSContext *hls) {
         }
 
         proto = avio_find_protocol_name(s->filename);
-        if (hls->method || (proto && !av_strcasecmp(proto, "http"))) {
-            av_dict_set(&options, "method", "DELETE", 0);
-            if ((ret = hls->avf->io_open(hls->avf, &out, path, AVIO_FLAG_WRITE, &options)) < 0)
-                goto fail;
-            ff_format_io_close(hls->avf, &out);
-        } else if (unlink(path) < 0) {
-            av_log(hls, AV_LOG_ERROR, "failed to delete old segment %s: %s\n",
-                                     path, strerror(errno));
-        }
+        http_delete = hls->method || (proto && !av_strcasecmp(proto, "http"));
+        if ((ret = hls_delete_file(s, path, http_delete)) < 0)
+            goto fail;
 
         if ((segment->sub_filename[0] != '\0')) {
             sub_path_size = strlen(segment->sub_filename) + 1 + (dirname ? strlen(dirname) : 0);
@@ -374,18 +596,10 @@ static int hls_delete_old_segments(AVFormatContext *s, HLSContext *hls) {
             av_strlcpy(sub_path, dirname, sub_path_size);
             av_strlcat(sub_path, segment->sub_filename, sub_path_size);
 
-            if (hls->method || (proto && !av_strcasecmp(proto, "http"))) {
-                av_dict_set(&options, "method", "DELETE", 0);
-                if ((ret = hls->avf->io_open(hls->avf, &out, sub_path, AVIO_FLAG_WRITE, &options)) < 0) {
-                    av_free(sub_path);
-                    goto fail;
-                }
-                ff_format_io_close(hls->avf, &out);
-            } else if (unlink(sub_path) < 0) {
-                av_log(hls, AV_LOG_ERROR, "failed to delete old segment %s: %s\n",
-                                         sub_path, strerror(errno));
-            }
+            ret = hls_delete_file(s, sub_path, http_delete);
             av_free(sub_path);
+            if (ret < 0)
+                goto fail;
         }
         av_freep(&path);
         previous_segment = segment;
@@ -419,7 +633,6 @@ static int do_encrypt(AVFormatContext *s)
     HLSContext *hls = s->priv_data;
     int ret;
     int len;
-    AVIOContext *pb;
     uint8_t key[KEYSIZE];
 
     len = strlen(hls->basename) + 4 + 1;
@@ -473,11 +686,8 @@ static int do_encrypt(AVFormatContext *s)
         }
 
         ff_data_to_hex(hls->key_string, key, sizeof(key), 0);
-        if ((ret = s->io_open(s, &pb, hls->key_file, AVIO_FLAG_WRITE, NULL)) < 0)
+        if ((ret = hls_write_file(s, hls->key_file, NULL, key, KEYSIZE, NULL)) < 0)
             return ret;
-        avio_seek(pb, 0, SEEK_CUR);
-        avio_write(pb, key, KEYSIZE);
-        avio_close(pb);
     }
     return 0;
 }
@@ -738,11 +948,12 @@ static int sls_flag_check_duration_size(HLSContext *hls)
     return ret;
 }
 
-static void sls_flag_file_rename(HLSContext *hls, char *old_filename) {
+static int sls_flag_file_rename(AVFormatContext *s, HLSContext *hls, char *old_filename) {
     if ((hls->flags & (HLS_SECOND_LEVEL_SEGMENT_SIZE | HLS_SECOND_LEVEL_SEGMENT_DURATION)) &&
         strlen(hls->current_segment_final_filename_fmt)) {
-        ff_rename(old_filename, hls->avf->filename, hls);
+        return hls_rename_file(s, old_filename, hls->avf->filename);
     }
+    return 0;
 }
 
 static int sls_flag_use_localtime_filename(AVFormatContext *oc, HLSContext *c)
@@ -862,6 +1073,7 @@ static int hls_append_segment(struct AVFormatContext *s, HLSContext *hls, double
         en = hls->segments;
         hls->initial_prog_date_time += en->duration;
         hls->segments = en->next;
+        hls->nb_dropped++;
         if (en && hls->flags & HLS_DELETE_SEGMENTS &&
 #if FF_API_HLS_WRAP
                 !(hls->flags & HLS_SINGLE_FILE || hls->wrap)) {
@@ -994,15 +1206,97 @@ static void write_m3u8_head_block(HLSContext *hls, AVIOContext *out, int version
     av_log(hls, AV_LOG_VERBOSE, "EXT-X-MEDIA-SEQUENCE:%"PRId64"\n", sequence);
 }
 
-static void hls_rename_temp_file(AVFormatContext *s, AVFormatContext *oc)
+static int hls_rename_temp_file(AVFormatContext *s, AVFormatContext *oc)
 {
     size_t len = strlen(oc->filename);
     char final_filename[sizeof(oc->filename)];
+    int ret;
 
     av_strlcpy(final_filename, oc->filename, len);
     final_filename[len-4] = '\0';
-    ff_rename(oc->filename, final_filename, s);
+    ret = hls_rename_file(s, oc->filename, final_filename);
     oc->filename[len-4] = '\0';
+    return ret;
+}
+
+/* Hand a playlist rendered in memory over for writing. */
+static int hls_publish_playlist(AVFormatContext *s, AVIOContext **pb, const char *filename,
+                                const char *target, AVDictionary *options)
+{
+    uint8_t *buf;
+    int ret, size;
+
+    size = avio_close_dyn_buf(*pb, &buf);
+    *pb = NULL;
+    ret = hls_write_file(s, filename, target, buf, size, options);
+    av_free(buf);
+    return ret;
+}
+
+/* Serialize the playlist entry of en at the end of hls->body. */
+static void hls_append_playlist_entry(HLSContext *hls, HLSSegment *en, int byterange_mode)
+{
+    if (hls->body_target_duration <= en->duration)
+        hls->body_target_duration = get_int_from_double(en->duration);
+
+    if ((hls->encrypt || hls->key_info_file) && (!hls->body_key_uri || strcmp(en->key_uri, hls->body_key_uri) ||
+                                av_strcasecmp(en->iv_string, hls->body_iv_string))) {
+        av_bprintf(&hls->body, "#EXT-X-KEY:METHOD=AES-128,URI=\"%s\"", en->key_uri);
+        if (*en->iv_string)
+            av_bprintf(&hls->body, ",IV=0x%s", en->iv_string);
+        av_bprintf(&hls->body, "\n");
+        hls->body_key_uri = en->key_uri;
+        hls->body_iv_string = en->iv_string;
+    }
+
+    if (en->discont) {
+        av_bprintf(&hls->body, "#EXT-X-DISCONTINUITY\n");
+    }
+
+    if ((hls->segment_type == SEGMENT_TYPE_FMP4) && (en == hls->segments)) {
+        av_bprintf(&hls->body, "#EXT-X-MAP:URI=\"%s\"", hls->fmp4_init_filename);
+        if (hls->flags & HLS_SINGLE_FILE) {
+            av_bprintf(&hls->body, ",BYTERANGE=\"%"PRId64"@%"PRId64"\"", en->size, en->pos);
+        }
+        av_bprintf(&hls->body, "\n");
+    } else {
+        if (hls->flags & HLS_ROUND_DURATIONS)
+            av_bprintf(&hls->body, "#EXTINF:%ld,\n",  lrint(en->duration));
+        else
+            av_bprintf(&hls->body, "#EXTINF:%f,\n", en->duration);
+        if (byterange_mode)
+            av_bprintf(&hls->body, "#EXT-X-BYTERANGE:%"PRId64"@%"PRId64"\n",
+                       en->size, en->pos);
+    }
+    if (hls->flags & HLS_PROGRAM_DATE_TIME) {
+        time_t tt, wrongsecs;
+        int milli;
+        struct tm *tm, tmpbuf;
+        char buf0[128], buf1[128];
+        tt = (int64_t)hls->body_prog_date_time;
+        milli = av_clip(lrint(1000*(hls->body_prog_date_time - tt)), 0, 999);
+        tm = localtime_r(&tt, &tmpbuf);
+        strftime(buf0, sizeof(buf0), "%Y-%m-%dT%H:%M:%S", tm);
+        if (!strftime(buf1, sizeof(buf1), "%z", tm) || buf1[1]<'0' ||buf1[1]>'2') {
+            int tz_min, dst = tm->tm_isdst;
+            tm = gmtime_r(&tt, &tmpbuf);
+            tm->tm_isdst = dst;
+            wrongsecs = mktime(tm);
+            tz_min = (abs(wrongsecs - tt) + 30) / 60;
+            snprintf(buf1, sizeof(buf1),
+                     "%c%02d%02d",
+                     wrongsecs <= tt ? '+' : '-',
+                     tz_min / 60,
+                     tz_min % 60);
+        }
+        av_bprintf(&hls->body, "#EXT-X-PROGRAM-DATE-TIME:%s.%03d%s\n", buf0, milli, buf1);
+        hls->body_prog_date_time += en->duration;
+    }
+    if (!((hls->segment_type == SEGMENT_TYPE_FMP4) && (en == hls->segments))) {
+        if (hls->baseurl)
+            av_bprintf(&hls->body, "%s", hls->baseurl);
+        av_bprintf(&hls->body, "%s\n", en->filename);
+    }
 }
 
 static int hls_window(AVFormatContext *s, int last)
@@ -1019,10 +1313,7 @@ static int hls_window(AVFormatContext *s, int last)
     const char *proto = avio_find_protocol_name(s->filename);
     int use_rename = proto && !strcmp(proto, "file");
     static unsigned warned_non_file;
-    char *key_uri = NULL;
-    char *iv_string = NULL;
     AVDictionary *options = NULL;
-    double prog_date_time = hls->initial_prog_date_time;
     int byterange_mode = (hls->flags & HLS_SINGLE_FILE) || (hls->max_seg_size > 0);
 
     if (byterange_mode) {
@@ -1039,13 +1330,23 @@ static int hls_window(AVFormatContext *s, int last)
 
     set_http_options(s, &options, hls);
     snprintf(temp_filename, sizeof(temp_filename), use_rename ? "%s.tmp" : "%s", s->filename);
-    if ((ret = s->io_open(s, &out, temp_filename, AVIO_FLAG_WRITE, &options)) < 0)
+    if ((ret = avio_open_dyn_buf(&out)) < 0)
         goto fail;
 
-    for (en = hls->segments; en; en = en->next) {
-        if (target_duration <= en->duration)
-            target_duration = get_int_from_double(en->duration);
+    if (!hls->body_last || hls->body_dropped != hls->nb_dropped) {
+        av_bprint_clear(&hls->body);
+        hls->body_last            = NULL;
+        hls->body_dropped         = hls->nb_dropped;
+        hls->body_target_duration = 0;
+        hls->body_prog_date_time  = hls->initial_prog_date_time;
+        hls->body_key_uri         = NULL;
+        hls->body_iv_string       = NULL;
+    }
+    for (en = hls->body_last ? hls->body_last->next : hls->segments; en; en = en->next) {
+        hls_append_playlist_entry(hls, en, byterange_mode);
+        hls->body_last = en;
     }
+    target_duration = hls->body_target_duration;
 
     hls->discontinuity_set = 0;
     write_m3u8_head_block(hls, out, version, target_duration, sequence);
@@ -1059,72 +1360,17 @@ static int hls_window(AVFormatContext *s, int last)
         avio_printf(out, "#EXT-X-DISCONTINUITY\n");
         hls->discontinuity_set = 1;
     }
-    for (en = hls->segments; en; en = en->next) {
-        if ((hls->encrypt || hls->key_info_file) && (!key_uri || strcmp(en->key_uri, key_uri) ||
-                                    av_strcasecmp(en->iv_string, iv_string))) {
-            avio_printf(out, "#EXT-X-KEY:METHOD=AES-128,URI=\"%s\"", en->key_uri);
-            if (*en->iv_string)
-                avio_printf(out, ",IV=0x%s", en->iv_string);
-            avio_printf(out, "\n");
-            key_uri = en->key_uri;
-            iv_string = en->iv_string;
-        }
-
-        if (en->discont) {
-            avio_printf(out, "#EXT-X-DISCONTINUITY\n");
-        }
-
-        if ((hls->segment_type == SEGMENT_TYPE_FMP4) && (en == hls->segments)) {
-            avio_printf(out, "#EXT-X-MAP:URI=\"%s\"", hls->fmp4_init_filename);
-            if (hls->flags & HLS_SINGLE_FILE) {
-                avio_printf(out, ",BYTERANGE=\"%"PRId64"@%"PRId64"\"", en->size, en->pos);
-            }
-            avio_printf(out, "\n");
-        } else {
-            if (hls->flags & HLS_ROUND_DURATIONS)
-                avio_printf(out, "#EXTINF:%ld,\n",  lrint(en->duration));
-            else
-                avio_printf(out, "#EXTINF:%f,\n", en->duration);
-            if (byterange_mode)
-                avio_printf(out, "#EXT-X-BYTERANGE:%"PRId64"@%"PRId64"\n",
-                            en->size, en->pos);
-        }
-        if (hls->flags & HLS_PROGRAM_DATE_TIME) {
-            time_t tt, wrongsecs;
-            int milli;
-            struct tm *tm, tmpbuf;
-            char buf0[128], buf1[128];
-            tt = (int64_t)prog_date_time;
-            milli = av_clip(lrint(1000*(prog_date_time - tt)), 0, 999);
-            tm = localtime_r(&tt, &tmpbuf);
-            strftime(buf0, sizeof(buf0), "%Y-%m-%dT%H:%M:%S", tm);
-            if (!strftime(buf1, sizeof(buf1), "%z", tm) || buf1[1]<'0' ||buf1[1]>'2') {
-                int tz_min, dst = tm->tm_isdst;
-                tm = gmtime_r(&tt, &tmpbuf);
-                tm->tm_isdst = dst;
-                wrongsecs = mktime(tm);
-                tz_min = (abs(wrongsecs - tt) + 30) / 60;
-                snprintf(buf1, sizeof(buf1),
-                         "%c%02d%02d",
-                         wrongsecs <= tt ? '+' : '-',
-                         tz_min / 60,
-                         tz_min % 60);
-            }
-            avio_printf(out, "#EXT-X-PROGRAM-DATE-TIME:%s.%03d%s\n", buf0, milli, buf1);
-            prog_date_time += en->duration;
-        }
-        if (!((hls->segment_type == SEGMENT_TYPE_FMP4) && (en == hls->segments))) {
-            if (hls->baseurl)
-                avio_printf(out, "%s", hls->baseurl);
-            avio_printf(out, "%s\n", en->filename);
-        }
+    if (!av_bprint_is_complete(&hls->body)) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
     }
+    avio_write(out, hls->body.str, hls->body.len);
 
     if (last && (hls->flags & HLS_OMIT_ENDLIST)==0)
         avio_printf(out, "#EXT-X-ENDLIST\n");
 
     if( hls->vtt_m3u8_name ) {
-        if ((ret = s->io_open(s, &sub_out, hls->vtt_m3u8_name, AVIO_FLAG_WRITE, &options)) < 0)
+        if ((ret = avio_open_dyn_buf(&sub_out)) < 0)
             goto fail;
         write_m3u8_head_block(hls, sub_out, version, target_duration, sequence);
 
@@ -1143,12 +1389,14 @@ static int hls_window(AVFormatContext *s, int last)
 
     }
 
+    ret = hls_publish_playlist(s, &out, temp_filename, use_rename ? s->filename : NULL, options);
+    if (ret >= 0 && sub_out)
+        ret = hls_publish_playlist(s, &sub_out, hls->vtt_m3u8_name, NULL, options);
+
 fail:
     av_dict_free(&options);
-    ff_format_io_close(s, &out);
-    ff_format_io_close(s, &sub_out);
-    if (ret >= 0 && use_rename)
-        ff_rename(temp_filename, s->filename, s);
+    ffio_free_dyn_buf(&out);
+    ffio_free_dyn_buf(&sub_out);
     return ret;
 }
 
@@ -1356,6 +1604,8 @@ static int hls_write_header(AVFormatContext *s)
         av_log(hls, AV_LOG_DEBUG, "start_number evaluated to %"PRId64"\n", hls->start_sequence);
     }
 
+    av_bprint_init(&hls->body, 0, AV_BPRINT_SIZE_UNLIMITED);
+
     hls->sequence       = hls->start_sequence;
     hls->recording_time = (hls->init_time ? hls->init_time : hls->time) * AV_TIME_BASE;
     hls->start_pts      = AV_NOPTS_VALUE;
@@ -1568,6 +1818,18 @@ static int hls_write_header(AVFormatContext *s)
         }
         avpriv_set_pts_info(outer_st, inner_st->pts_wrap_bits, inner_st->time_base.num, inner_st->time_base.den);
     }
+
+    if (ret >= 0 && hls->async_io) {
+#if HAVE_THREADS
+        int err = hls_start_worker(s);
+        if (err < 0) {
+            ret = err;
+            goto fail;
+        }
+#else
+        av_log(s, AV_LOG_WARNING, "hls_async_io requires threading support, ignoring it\n");
+#endif
+    }
 fail:
 
     av_dict_free(&options);
@@ -1642,8 +1904,10 @@ static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
     if (hls->fmp4_init_mode || can_split && av_compare_ts(pkt->pts - hls->start_pts, st->time_base,
                                    end_pts, AV_TIME_BASE_Q) >= 0) {
         int64_t new_start_pos;
+        int64_t boundary_start = av_gettime_relative();
         char *old_filename = av_strdup(hls->avf->filename);
         int byterange_mode = (hls->flags & HLS_SINGLE_FILE) || (hls->max_seg_size > 0);
+        HLSTask boundary = { .type = HLS_TASK_BOUNDARY };
 
         if (!old_filename) {
             return AVERROR(ENOMEM);
@@ -1655,16 +1919,20 @@ static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
         hls->size = new_start_pos - hls->start_pos;
 
         if (!byterange_mode) {
-            ff_format_io_close(s, &oc->pb);
-            if (hls->vtt_avf) {
-                ff_format_io_close(s, &hls->vtt_avf->pb);
+            ret = hls_close_file(s, &oc->pb);
+            if (ret >= 0 && hls->vtt_avf) {
+                ret = hls_close_file(s, &hls->vtt_avf->pb);
             }
         }
-        if ((hls->flags & HLS_TEMP_FILE) && oc->filename[0]) {
+        if (ret >= 0 && (hls->flags & HLS_TEMP_FILE) && oc->filename[0]) {
             if (!(hls->flags & HLS_SINGLE_FILE) || (hls->max_seg_size <= 0))
                 if ((hls->avf->oformat->priv_class && hls->avf->priv_data) && hls->segment_type != SEGMENT_TYPE_FMP4)
                     av_opt_set(hls->avf->priv_data, "mpegts_flags", "resend_headers", 0);
-            hls_rename_temp_file(s, oc);
+            ret = hls_rename_temp_file(s, oc);
+        }
+        if (ret < 0) {
+            av_free(old_filename);
+            return ret;
         }
 
         if (hls->fmp4_init_mode) {
@@ -1689,8 +1957,9 @@ static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
         } else if (hls->max_seg_size > 0) {
             if (hls->start_pos >= hls->max_seg_size) {
                 hls->sequence++;
-                sls_flag_file_rename(hls, old_filename);
-                ret = hls_start(s);
+                ret = sls_flag_file_rename(s, hls, old_filename);
+                if (ret >= 0)
+                    ret = hls_start(s);
                 hls->start_pos = 0;
                 /* When split segment by byte, the duration is short than hls_time,
                  * so it is not enough one segment duration as hls_time, */
@@ -1698,8 +1967,9 @@ static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
             }
             hls->number++;
         } else {
-            sls_flag_file_rename(hls, old_filename);
-            ret = hls_start(s);
+            ret = sls_flag_file_rename(s, hls, old_filename);
+            if (ret >= 0)
+                ret = hls_start(s);
         }
         av_free(old_filename);
 
@@ -1711,6 +1981,14 @@ static int hls_write_packet(AVFormatContext *s, AVPacket *pkt)
             if ((ret = hls_window(s, 0)) < 0) {
                 return ret;
             }
+
+        boundary.filename = av_strdup(hls->last_segment ? hls->last_segment->filename : "");
+        if (!boundary.filename)
+            return AVERROR(ENOMEM);
+        boundary.start_time = boundary_start;
+        boundary.end_time   = av_gettime_relative();
+        if ((ret = hls_submit_task(s, &boundary)) < 0)
+            return ret;
     }
 
     ret = ff_write_chained(oc, stream_index, pkt, s, 0);
@@ -1724,11 +2002,18 @@ static int hls_write_trailer(struct AVFormatContext *s)
     AVFormatContext *oc = hls->avf;
     AVFormatContext *vtt_oc = hls->vtt_avf;
     char *old_filename = av_strdup(hls->avf->filename);
+    int ret, err;
 
     if (!old_filename) {
         return AVERROR(ENOMEM);
     }
 
+    /* the final segment and playlist are written directly */
+    ret = hls_stop_worker(s);
+    if (hls->nb_boundaries)
+        av_log(s, AV_LOG_VERBOSE, "%d segment boundaries, muxing blocked for at most %.3f ms, "
+               "published after at most %.3f ms\n", hls->nb_boundaries,
+               hls->max_stall / 1000.0, hls->max_latency / 1000.0);
 
     av_write_trailer(oc);
     if (oc->pb) {
@@ -1743,7 +2028,9 @@ static int hls_write_trailer(struct AVFormatContext *s)
         hls_append_segment(s, hls, hls->duration + hls->dpp, hls->start_pos, hls->size);
     }
 
-    sls_flag_file_rename(hls, old_filename);
+    err = sls_flag_file_rename(s, hls, old_filename);
+    if (err < 0 && ret >= 0)
+        ret = err;
 
     if (vtt_oc) {
         if (vtt_oc->pb)
@@ -1769,7 +2056,15 @@ static int hls_write_trailer(struct AVFormatContext *s)
     hls_free_segments(hls->segments);
     hls_free_segments(hls->old_segments);
     av_free(old_filename);
-    return 0;
+    return ret;
+}
+
+static void hls_deinit(AVFormatContext *s)
+{
+    HLSContext *hls = s->priv_data;
+
+    hls_stop_worker(s);
+    av_bprint_finalize(&hls->body, NULL);
 }
 
 #define OFFSET(x) offsetof(HLSContext, x)
@@ -1823,6 +2118,8 @@ static const AVOption options[] = {
     {"epoch", "seconds since epoch", 0, AV_OPT_TYPE_CONST, {.i64 = HLS_START_SEQUENCE_AS_SECONDS_SINCE_EPOCH }, INT_MIN, INT_MAX, E, "start_sequence_source_type" },
     {"datetime", "current datetime as YYYYMMDDhhmmss", 0, AV_OPT_TYPE_CONST, {.i64 = HLS_START_SEQUENCE_AS_FORMATTED_DATETIME }, INT_MIN, INT_MAX, E, "start_sequence_source_type" },
     {"http_user_agent", "override User-Agent field in HTTP header", OFFSET(user_agent), AV_OPT_TYPE_STRING, {.str = NULL},  0, 0,    E},
+    {"connection_pool", "reuse HTTP connections between uploads", OFFSET(connection_pool), AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, E},
+    {"hls_async_io", "finalize segments and publish playlists in a background thread", OFFSET(async_io), AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, E},
     { NULL },
 };
 
@@ -1846,5 +2143,6 @@ AVOutputFormat ff_hls_muxer = {
     .write_header   = hls_write_header,
     .write_packet   = hls_write_packet,
     .write_trailer  = hls_write_trailer,
+    .deinit         = hls_deinit,
     .priv_class     = &hls_class,
 };
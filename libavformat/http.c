@@ -30,6 +30,7 @@
 #include "libavutil/opt.h"
 #include "libavutil/time.h"
 #include "libavutil/parseutils.h"
+#include "libavutil/thread.h"
 
 #include "avformat.h"
 #include "http.h"
@@ -51,6 +52,11 @@
 #define HTTP_MUTLI    2
 #define MAX_EXPIRY    19
 #define WHITESPACES " \n\t\r"
+/* Maximum number of idle connections kept in the pool. */
+#define MAX_POOL_SIZE 32
+/* Maximum size of a reply body read to make a connection reusable after
+ * sending data. */
+#define MAX_DRAIN_SIZE 65536
 typedef enum {
     LOWER_PROTO,
     READ_HEADERS,
@@ -58,6 +64,68 @@ typedef enum {
     FINISH
 }HandshakeState;
 
+/* A persistent connection to a server, which can be kept in the process-wide
+ * pool of idle connections once a request is complete. Nested protocols
+ * copy the interrupt callback of the connection when it is opened, so it is
+ * routed through int_cb, which is updated for the current user. */
+typedef struct HTTPPoolConnection {
+    URLContext *hd;         ///< set while the connection is in the pool
+    char *key;              ///< lower protocol URL and options, see pool_key()
+    AVIOInterruptCB int_cb;
+    AVIOInterruptCB pool_int_cb;
+    int64_t expiry;
+    struct HTTPPoolConnection *next;
+} HTTPPoolConnection;
+
+static HTTPPoolConnection *pool;
+static int pool_size;
+typedef struct HTTPPoolStats {
+    uint64_t opened, reused, released, expired, stale;
+} HTTPPoolStats;
+
+static HTTPPoolStats pool_stats;
+static AVMutex pool_mutex;
+static AVOnce pool_init_once = AV_ONCE_INIT;
+
+#if HAVE_THREADS
+/* Amount of data a worker reads from its connection at once. */
+#define PARALLEL_READ_SIZE 65536
+
+typedef struct HTTPChunk {
+    uint8_t *data;
+    int64_t index;          ///< number of the chunk held by the slot, -1 if none
+    int size;
+    int filled;
+    int busy;               ///< a worker is filling the slot
+    int err;
+} HTTPChunk;
+
+typedef struct HTTPParallelWorker {
+    struct HTTPParallel *p;
+    URLContext *hd;         ///< persistent connection of the worker
+    AVIOInterruptCB int_cb;
+    pthread_t thread;
+} HTTPParallelWorker;
+
+/* Byte ranges fetched ahead of the read position over several connections.
+ * The file is split into chunks of chunk_size bytes and the chunks of the
+ * window [base, base + nb_chunks) are fetched by the workers, lowest first. */
+typedef struct HTTPParallel {
+    URLContext *h;
+    HTTPParallelWorker *workers;
+    int nb_workers;
+    HTTPChunk *chunks;
+    int nb_chunks;
+    int chunk_size;
+    int64_t nb_total_chunks;
+    int64_t base;
+    int abort;
+    int interrupted;        ///< the interrupt callback of h fired in the reading thread
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} HTTPParallel;
+#endif
+
 typedef struct HTTPContext {
     const AVClass *class;
     URLContext *hd;
@@ -123,6 +191,14 @@ typedef struct HTTPContext {
     int is_multi_client;
     HandshakeState handshake_step;
     int is_connected_server;
+    int parallel;
+    int parallel_chunk_size;
+#if HAVE_THREADS
+    HTTPParallel *par;
+#endif
+    int connection_pool;
+    int pool_idle_timeout;
+    HTTPPoolConnection *conn;   ///< set if hd may be returned to the pool
 } HTTPContext;
 
 #define OFFSET(x) offsetof(HTTPContext, x)
@@ -163,6 +239,10 @@ static const AVOption options[] = {
     { "listen", "listen on HTTP", OFFSET(listen), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, 2, D | E },
     { "resource", "The resource requested by a client", OFFSET(resource), AV_OPT_TYPE_STRING, { .str = NULL }, 0, 0, E },
     { "reply_code", "The http status code to return to a client", OFFSET(reply_code), AV_OPT_TYPE_INT, { .i64 = 200}, INT_MIN, 599, E},
+    { "parallel", "number of connections fetching byte ranges in parallel", OFFSET(parallel), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, 64, D },
+    { "parallel_chunk_size", "size of the byte ranges fetched in parallel", OFFSET(parallel_chunk_size), AV_OPT_TYPE_INT, { .i64 = 1 << 20 }, 65536, INT_MAX / 2, D },
+    { "connection_pool", "keep connections open and share them between requests to the same server", OFFSET(connection_pool), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, D | E },
+    { "pool_idle_timeout", "time in seconds after which idle pooled connections are closed", OFFSET(pool_idle_timeout), AV_OPT_TYPE_INT, { .i64 = 5 }, 0, 3600, D | E },
     { NULL }
 };
 
@@ -170,6 +250,10 @@ static int http_connect(URLContext *h, const char *path, const char *local_path,
                         const char *hoststr, const char *auth,
                         const char *proxyauth, int *new_location);
 static int http_read_header(URLContext *h, int *new_location);
+static int http_buf_read(URLContext *h, uint8_t *buf, int size);
+#if HAVE_THREADS
+static int http_parallel_start(URLContext *h);
+#endif
 
 void ff_http_init_auth_state(URLContext *dest, const URLContext *src)
 {
@@ -181,6 +265,222 @@ void ff_http_init_auth_state(URLContext *dest, const URLContext *src)
            sizeof(HTTPAuthState));
 }
 
+static void pool_init(void)
+{
+    ff_mutex_init(&pool_mutex, NULL);
+}
+
+static int pool_interrupt(void *opaque)
+{
+    HTTPPoolConnection *conn = opaque;
+    return ff_check_interrupt(&conn->int_cb);
+}
+
+static void pool_free_connection(HTTPPoolConnection **pconn)
+{
+    HTTPPoolConnection *conn = *pconn;
+
+    if (!conn)
+        return;
+    ffurl_closep(&conn->hd);
+    av_freep(&conn->key);
+    av_freep(pconn);
+}
+
+/* An idle connection has nothing to read, unless the server closed it. */
+static int pool_connection_alive(URLContext *hd)
+{
+    struct pollfd p = { .fd = ffurl_get_file_handle(hd), .events = POLLIN };
+
+    if (p.fd < 0)
+        return 1;
+    return !poll(&p, 1, 0);
+}
+
+/* Remove expired connections from the pool, called with the lock held. */
+static HTTPPoolConnection *pool_expire(int64_t now)
+{
+    HTTPPoolConnection **p = &pool, *expired = NULL;
+
+    while (*p) {
+        HTTPPoolConnection *conn = *p;
+        if (conn->expiry <= now || (pool_size > MAX_POOL_SIZE && !conn->next)) {
+            *p         = conn->next;
+            conn->next = expired;
+            expired    = conn;
+            pool_size--;
+            pool_stats.expired++;
+        } else {
+            p = &conn->next;
+        }
+    }
+    return expired;
+}
+
+static void pool_close_list(HTTPPoolConnection *list)
+{
+    while (list) {
+        HTTPPoolConnection *next = list->next;
+        pool_free_connection(&list);
+        list = next;
+    }
+}
+
+/* Connections are only shared between requests which would have opened the
+ * lower protocol the same way: the key is its URL (e.g. tls://host:port)
+ * followed by the options passed on to it, such as the TLS certificate and
+ * verification options or the socket timeouts. */
+static char *pool_key(URLContext *h, const char *url)
+{
+    HTTPContext *s = h->priv_data;
+    char *opts = NULL, *key;
+
+    if (av_dict_get_string(s->chained_options, &opts, '=', '&') < 0)
+        return NULL;
+    key = av_asprintf("%s?%s", url, opts ? opts : "");
+    av_free(opts);
+    return key;
+}
+
+/* Take an idle connection to url out of the pool, if there is one. */
+static void pool_get_connection(URLContext *h, const char *url, const char *key)
+{
+    HTTPContext *s = h->priv_data;
+    HTTPPoolConnection *conn, **p, *expired;
+    HTTPPoolStats stats;
+    int idle;
+
+    ff_thread_once(&pool_init_once, pool_init);
+
+    for (;;) {
+        ff_mutex_lock(&pool_mutex);
+        expired = pool_expire(av_gettime_relative());
+        for (p = &pool; *p && strcmp((*p)->key, key); p = &(*p)->next)
+            ;
+        conn = *p;
+        if (conn) {
+            *p = conn->next;
+            pool_size--;
+        }
+        ff_mutex_unlock(&pool_mutex);
+        pool_close_list(expired);
+
+        if (!conn)
+            return;
+        if (pool_connection_alive(conn->hd))
+            break;
+        ff_mutex_lock(&pool_mutex);
+        pool_stats.stale++;
+        ff_mutex_unlock(&pool_mutex);
+        pool_free_connection(&conn);
+    }
+
+    ff_mutex_lock(&pool_mutex);
+    pool_stats.reused++;
+    stats = pool_stats;
+    idle  = pool_size;
+    ff_mutex_unlock(&pool_mutex);
+    av_log(h, AV_LOG_VERBOSE, "Reusing connection to %s, pool: %d idle, "
+           "%"PRIu64" opened, %"PRIu64" reused, %"PRIu64" expired, %"PRIu64" stale\n",
+           url, idle, stats.opened, stats.reused, stats.expired, stats.stale);
+
+    pool_free_connection(&s->conn);
+    conn->int_cb = h->interrupt_callback;
+    conn->next   = NULL;
+    s->hd        = conn->hd;
+    conn->hd     = NULL;
+    s->conn      = conn;
+}
+
+/* Open a new connection which can be returned to the pool later. */
+static int pool_open_connection(URLContext *h, const char *url, const char *key,
+                                AVDictionary **options)
+{
+    HTTPContext *s = h->priv_data;
+    HTTPPoolConnection *conn = s->conn;
+    int ret;
+
+    ff_thread_once(&pool_init_once, pool_init);
+
+    if (!conn) {
+        conn = s->conn = av_mallocz(sizeof(*conn));
+        if (!conn)
+            return AVERROR(ENOMEM);
+        conn->pool_int_cb.callback = pool_interrupt;
+        conn->pool_int_cb.opaque   = conn;
+    }
+    av_freep(&conn->key);
+    if (!(conn->key = av_strdup(key)))
+        return AVERROR(ENOMEM);
+    conn->int_cb = h->interrupt_callback;
+
+    ret = ffurl_open_whitelist(&s->hd, url, AVIO_FLAG_READ_WRITE,
+                               &conn->pool_int_cb, options,
+                               h->protocol_whitelist, h->protocol_blacklist, h);
+    if (ret >= 0) {
+        ff_mutex_lock(&pool_mutex);
+        pool_stats.opened++;
+        ff_mutex_unlock(&pool_mutex);
+    }
+    return ret;
+}
+
+/* Return the connection to the pool, the current request must be complete. */
+static void pool_release_connection(URLContext *h)
+{
+    HTTPContext *s = h->priv_data;
+    HTTPPoolConnection *conn = s->conn, *expired;
+    int64_t now = av_gettime_relative();
+
+    conn->hd     = s->hd;
+    conn->int_cb = (AVIOInterruptCB){ NULL, NULL };
+    conn->expiry = now + s->pool_idle_timeout * (int64_t)1000000;
+    s->hd        = NULL;
+    s->conn      = NULL;
+
+    ff_mutex_lock(&pool_mutex);
+    conn->next = pool;
+    pool       = conn;
+    pool_size++;
+    pool_stats.released++;
+    expired = pool_expire(now);
+    ff_mutex_unlock(&pool_mutex);
+    pool_close_list(expired);
+}
+
+/* Check whether the connection of a finished request can be reused, reading
+ * the reply to sent data first. */
+static int http_connection_reusable(URLContext *h)
+{
+    HTTPContext *s = h->priv_data;
+    uint8_t buf[4096];
+    int new_location, ret;
+
+    if (!s->hd || !s->conn || s->listen || s->icy_metaint)
+        return 0;
+
+    if (h->flags & AVIO_FLAG_WRITE) {
+        if (!s->end_chunked_post && !s->post_data)
+            return 0;
+        if (!s->end_header && http_read_header(h, &new_location) < 0)
+            return 0;
+        if (s->chunksize != UINT64_MAX || s->filesize > MAX_DRAIN_SIZE)
+            return 0;
+        while (s->off < s->filesize) {
+            ret = http_buf_read(h, buf, FFMIN(sizeof(buf), s->filesize - s->off));
+            if (ret <= 0)
+                return 0;
+        }
+        if (s->http_code >= 300)
+            av_log(h, AV_LOG_WARNING, "HTTP error %d\n", s->http_code);
+    }
+
+    /* The whole reply body must have been read. */
+    return !s->willclose && s->chunksize == UINT64_MAX &&
+           s->buf_ptr == s->buf_end &&
+           s->off == (s->end_off ? s->end_off : s->filesize);
+}
+
 static int http_open_cnx_internal(URLContext *h, AVDictionary **options)
 {
     const char *path, *proxy_path, *lower_proto = "tcp", *local_path;
@@ -188,8 +488,10 @@ static int http_open_cnx_internal(URLContext *h, AVDictionary **options)
     char auth[1024], proxyauth[1024] = "";
     char path1[MAX_URL_SIZE];
     char buf[1024], urlbuf[MAX_URL_SIZE];
-    int port, use_proxy, err, location_changed = 0;
+    int port, use_proxy, err, location_changed = 0, reused;
     HTTPContext *s = h->priv_data;
+    char *key = NULL;
+    uint64_t off = s->off;
 
     av_url_split(proto, sizeof(proto), auth, sizeof(auth),
                  hostname, sizeof(hostname), &port,
@@ -226,20 +528,41 @@ static int http_open_cnx_internal(URLContext *h, AVDictionary **options)
 
     ff_url_join(buf, sizeof(buf), lower_proto, NULL, hostname, port, NULL);
 
+    if (!s->hd && s->connection_pool) {
+        if (!(key = pool_key(h, buf)))
+            return AVERROR(ENOMEM);
+        pool_get_connection(h, buf, key);
+    }
+    reused = s->hd && s->conn;
+    if (reused)
+        s->http_code = 0;
     if (!s->hd) {
-        err = ffurl_open_whitelist(&s->hd, buf, AVIO_FLAG_READ_WRITE,
-                                   &h->interrupt_callback, options,
-                                   h->protocol_whitelist, h->protocol_blacklist, h);
+        if (s->connection_pool)
+            err = pool_open_connection(h, buf, key, options);
+        else
+            err = ffurl_open_whitelist(&s->hd, buf, AVIO_FLAG_READ_WRITE,
+                                       &h->interrupt_callback, options,
+                                       h->protocol_whitelist, h->protocol_blacklist, h);
         if (err < 0)
-            return err;
+            goto end;
     }
 
     err = http_connect(h, path, local_path, hoststr,
                        auth, proxyauth, &location_changed);
-    if (err < 0)
-        return err;
-
-    return location_changed;
+    if (err < 0 && reused && !s->http_code) {
+        /* The server closed the pooled connection meanwhile. */
+        ffurl_closep(&s->hd);
+        s->off = off;
+        if ((err = pool_open_connection(h, buf, key, options)) < 0)
+            goto end;
+        err = http_connect(h, path, local_path, hoststr,
+                           auth, proxyauth, &location_changed);
+    }
+    if (err >= 0)
+        err = location_changed;
+end:
+    av_free(key);
+    return err;
 }
 
 /* return non zero if error */
@@ -517,8 +840,14 @@ static int http_open(URLContext *h, const char *uri, int flags,
         return http_listen(h, uri, flags, options);
     }
     ret = http_open_cnx(h, options);
-    if (ret < 0)
+    if (ret < 0) {
         av_dict_free(&s->chained_options);
+        return ret;
+    }
+#if HAVE_THREADS
+    if (s->parallel > 1 && !(flags & AVIO_FLAG_WRITE))
+        http_parallel_start(h);
+#endif
     return ret;
 }
 
@@ -1173,7 +1502,7 @@ static int http_connect(URLContext *h, const char *path, const char *local_path,
                            "Expect: 100-continue\r\n");
 
     if (!has_header(s->headers, "\r\nConnection: ")) {
-        if (s->multiple_requests)
+        if (s->multiple_requests || s->connection_pool)
             len += av_strlcpy(headers + len, "Connection: keep-alive\r\n",
                               sizeof(headers) - len);
         else
@@ -1493,10 +1822,361 @@ static int store_icy(URLContext *h, int size)
     return FFMIN(size, remaining);
 }
 
+#if HAVE_THREADS
+/* The interrupt callback of the caller is only called from the reading
+ * thread, the workers follow its result. */
+static int http_parallel_interrupt(void *opaque)
+{
+    HTTPParallel *p = ((HTTPParallelWorker *)opaque)->p;
+    int ret;
+
+    pthread_mutex_lock(&p->lock);
+    ret = p->abort || p->interrupted;
+    pthread_mutex_unlock(&p->lock);
+    return ret;
+}
+
+/* Request the bytes [start, end) on the connection of the worker, reusing it
+ * if the previous response allows it. */
+static int http_parallel_request(HTTPParallelWorker *w, int64_t start, int64_t end)
+{
+    URLContext *h = w->p->h;
+    HTTPContext *s = h->priv_data, *ws;
+    AVDictionary *options = NULL;
+    int ret;
+
+    if (w->hd) {
+        ws = w->hd->priv_data;
+        /* Only a 206 reply is known to end exactly with the requested range. */
+        if (ws->willclose || ws->http_code != 206)
+            ffurl_closep(&ws->hd);
+        ws->off     = start;
+        ws->end_off = end;
+        ret = http_open_cnx(w->hd, &options);
+        av_dict_free(&options);
+        return ret;
+    }
+
+    if ((ret = ffurl_alloc(&w->hd, s->location, AVIO_FLAG_READ, &w->int_cb)) < 0)
+        return ret;
+    if ((ret = av_opt_copy(w->hd, h)) < 0 ||
+        (ret = av_opt_copy(w->hd->priv_data, s)) < 0)
+        goto fail;
+    ff_http_init_auth_state(w->hd, h);
+    ws = w->hd->priv_data;
+    av_freep(&ws->location);
+    ws->parallel          = 0;
+    ws->seekable          = 1;
+    ws->multiple_requests = 1;
+    ws->icy               = 0;
+    ws->off               = start;
+    ws->end_off           = end;
+
+    av_dict_copy(&options, s->chained_options, 0);
+    ret = ffurl_connect(w->hd, &options);
+    av_dict_free(&options);
+    if (ret >= 0)
+        return ret;
+fail:
+    ffurl_closep(&w->hd);
+    return ret;
+}
+
+static int http_parallel_chunk_dropped(HTTPParallel *p, HTTPChunk *chunk, int64_t idx)
+{
+    return p->abort || chunk->index != idx || idx < p->base;
+}
+
+static int http_parallel_fetch(HTTPParallelWorker *w, HTTPChunk *chunk, int64_t idx)
+{
+    HTTPParallel *p = w->p;
+    int64_t start = idx * p->chunk_size;
+    int filled = 0, dropped = 0, attempt, ret;
+
+    /* Retry once on a new connection, e.g. after the server closed an idle
+     * persistent one, resuming where the previous attempt stopped. */
+    for (attempt = 0; attempt < 2; attempt++) {
+        ret = http_parallel_request(w, start + filled, start + chunk->size);
+        while (ret >= 0 && filled < chunk->size) {
+            ret = http_read_stream(w->hd, chunk->data + filled,
+                                   FFMIN(PARALLEL_READ_SIZE, chunk->size - filled));
+            if (ret <= 0) {
+                ret = ret ? ret : AVERROR(EIO);
+                break;
+            }
+            filled += ret;
+
+            pthread_mutex_lock(&p->lock);
+            dropped = http_parallel_chunk_dropped(p, chunk, idx);
+            if (!dropped)
+                chunk->filled = filled;
+            pthread_cond_broadcast(&p->cond);
+            pthread_mutex_unlock(&p->lock);
+            if (dropped) {
+                /* The rest of the response is not needed any more. */
+                ffurl_closep(&w->hd);
+                return 0;
+            }
+        }
+        if (ret >= 0)
+            return 0;
+        ffurl_closep(&w->hd);
+        if (ret == AVERROR_EXIT)
+            break;
+    }
+    return ret;
+}
+
+static void *http_parallel_worker(void *arg)
+{
+    HTTPParallelWorker *w = arg;
+    HTTPParallel *p = w->p;
+    HTTPContext *s = p->h->priv_data;
+
+    pthread_mutex_lock(&p->lock);
+    while (!p->abort) {
+        HTTPChunk *chunk = NULL;
+        int64_t idx, end = FFMIN(p->base + p->nb_chunks, p->nb_total_chunks);
+        int ret;
+
+        for (idx = p->base; idx < end; idx++) {
+            HTTPChunk *c = &p->chunks[idx % p->nb_chunks];
+            if (c->index != idx && !c->busy) {
+                chunk = c;
+                break;
+            }
+        }
+        if (!chunk) {
+            pthread_cond_wait(&p->cond, &p->lock);
+            continue;
+        }
+        chunk->index  = idx;
+        chunk->size   = FFMIN(p->chunk_size, s->filesize - idx * p->chunk_size);
+        chunk->filled = 0;
+        chunk->err    = 0;
+        chunk->busy   = 1;
+        pthread_mutex_unlock(&p->lock);
+
+        ret = http_parallel_fetch(w, chunk, idx);
+
+        pthread_mutex_lock(&p->lock);
+        if (ret == AVERROR_EXIT && !p->interrupted &&
+            !http_parallel_chunk_dropped(p, chunk, idx)) {
+            /* The reader has resumed since, fetch the chunk again. */
+            chunk->index = -1;
+        } else if (ret < 0 && !http_parallel_chunk_dropped(p, chunk, idx)) {
+            av_log(p->h, AV_LOG_ERROR, "Failed to fetch bytes %"PRId64"-%"PRId64": %s\n",
+                   idx * p->chunk_size, idx * p->chunk_size + chunk->size - 1,
+                   av_err2str(ret));
+            chunk->err = ret;
+        }
+        chunk->busy = 0;
+        pthread_cond_broadcast(&p->cond);
+    }
+    pthread_mutex_unlock(&p->lock);
+
+    return NULL;
+}
+
+static void http_parallel_stop(HTTPContext *s)
+{
+    HTTPParallel *p = s->par;
+    int i;
+
+    if (!p)
+        return;
+
+    pthread_mutex_lock(&p->lock);
+    p->abort = 1;
+    pthread_cond_broadcast(&p->cond);
+    pthread_mutex_unlock(&p->lock);
+
+    for (i = 0; i < p->nb_workers; i++) {
+        pthread_join(p->workers[i].thread, NULL);
+        ffurl_closep(&p->workers[i].hd);
+    }
+    for (i = 0; i < p->nb_chunks; i++)
+        av_freep(&p->chunks[i].data);
+    av_freep(&p->chunks);
+    av_freep(&p->workers);
+    pthread_cond_destroy(&p->cond);
+    pthread_mutex_destroy(&p->lock);
+    av_freep(&s->par);
+}
+
+static int http_parallel_start(URLContext *h)
+{
+    HTTPContext *s = h->priv_data;
+    const char *proto = avio_find_protocol_name(s->location);
+    HTTPParallel *p;
+    int i, ret;
+
+    /* Only plain, seekable resources of known size can be split, and the
+     * workers must not be redirected to another protocol. */
+    if (h->is_streamed || s->listen || s->post_data || s->end_off ||
+        !proto || strcmp(proto, h->prot->name) ||
+        s->filesize == UINT64_MAX || !s->filesize || s->filesize > INT64_MAX ||
+        s->chunksize != UINT64_MAX || s->icy_metaint
+#if CONFIG_ZLIB
+        || s->compressed
+#endif
+        ) {
+        av_log(h, AV_LOG_VERBOSE, "Resource cannot be fetched in parallel\n");
+        return AVERROR(ENOSYS);
+    }
+
+    p = s->par = av_mallocz(sizeof(*p));
+    if (!p)
+        return AVERROR(ENOMEM);
+    p->h               = h;
+    p->chunk_size      = s->parallel_chunk_size;
+    p->nb_total_chunks = (s->filesize + p->chunk_size - 1) / p->chunk_size;
+    p->base            = s->off / p->chunk_size;
+    p->nb_chunks       = 2 * s->parallel;
+    p->chunks          = av_mallocz_array(p->nb_chunks, sizeof(*p->chunks));
+    p->workers         = av_mallocz_array(s->parallel, sizeof(*p->workers));
+    if (!p->chunks || !p->workers) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+    for (i = 0; i < p->nb_chunks; i++) {
+        p->chunks[i].index = -1;
+        if (!(p->chunks[i].data = av_malloc(p->chunk_size))) {
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+    }
+
+    if ((ret = pthread_mutex_init(&p->lock, NULL))) {
+        ret = AVERROR(ret);
+        goto fail;
+    }
+    if ((ret = pthread_cond_init(&p->cond, NULL))) {
+        pthread_mutex_destroy(&p->lock);
+        ret = AVERROR(ret);
+        goto fail;
+    }
+    for (i = 0; i < s->parallel; i++) {
+        HTTPParallelWorker *w = &p->workers[i];
+        w->p                 = p;
+        w->int_cb.callback   = http_parallel_interrupt;
+        w->int_cb.opaque     = w;
+        if ((ret = pthread_create(&w->thread, NULL, http_parallel_worker, w))) {
+            av_log(h, AV_LOG_ERROR, "Failed to create worker thread\n");
+            if (!p->nb_workers) {
+                pthread_cond_destroy(&p->cond);
+                pthread_mutex_destroy(&p->lock);
+                ret = AVERROR(ret);
+                goto fail;
+            }
+            break;
+        }
+        p->nb_workers++;
+    }
+
+    /* The data is read through the workers from now on. */
+    ffurl_closep(&s->hd);
+    av_log(h, AV_LOG_VERBOSE, "Fetching %"PRIu64" bytes over %d connections "
+           "in chunks of %d bytes\n", s->filesize, p->nb_workers, p->chunk_size);
+    return 0;
+
+fail:
+    if (p->chunks)
+        for (i = 0; i < p->nb_chunks; i++)
+            av_freep(&p->chunks[i].data);
+    av_freep(&p->chunks);
+    av_freep(&p->workers);
+    av_freep(&s->par);
+    return ret;
+}
+
+static int http_parallel_read(URLContext *h, uint8_t *buf, int size)
+{
+    HTTPContext *s = h->priv_data;
+    HTTPParallel *p = s->par;
+    int64_t idx = s->off / p->chunk_size;
+    int off = s->off % p->chunk_size;
+    HTTPChunk *chunk = &p->chunks[idx % p->nb_chunks];
+    int i, ret;
+
+    if (s->off >= s->filesize)
+        return AVERROR_EOF;
+
+    pthread_mutex_lock(&p->lock);
+    if (p->interrupted) {
+        /* Refetch what the interruption made the workers give up. */
+        p->interrupted = 0;
+        for (i = 0; i < p->nb_chunks; i++) {
+            if (p->chunks[i].err == AVERROR_EXIT) {
+                p->chunks[i].index = -1;
+                p->chunks[i].err   = 0;
+            }
+        }
+        pthread_cond_broadcast(&p->cond);
+    }
+    if (idx < p->base || idx >= p->base + p->nb_chunks) {
+        /* Restart fetching at the new position. */
+        for (i = 0; i < p->nb_chunks; i++) {
+            p->chunks[i].index = -1;
+            p->chunks[i].err   = 0;
+        }
+        p->base = idx;
+        pthread_cond_broadcast(&p->cond);
+    } else if (idx > p->base) {
+        p->base = idx;
+        pthread_cond_broadcast(&p->cond);
+    }
+    while (chunk->index != idx || (!chunk->err && chunk->filled <= off)) {
+        int64_t t = av_gettime() + 100000;
+        struct timespec tv = { .tv_sec  =  t / 1000000,
+                               .tv_nsec = (t % 1000000) * 1000 };
+        if (ff_check_interrupt(&h->interrupt_callback)) {
+            p->interrupted = 1;
+            pthread_cond_broadcast(&p->cond);
+            pthread_mutex_unlock(&p->lock);
+            return AVERROR_EXIT;
+        }
+        pthread_cond_timedwait(&p->cond, &p->lock, &tv);
+    }
+    ret = chunk->err ? chunk->err : FFMIN(size, chunk->filled - off);
+    pthread_mutex_unlock(&p->lock);
+
+    if (ret > 0) {
+        /* The slot cannot be reused before the read position leaves it. */
+        memcpy(buf, chunk->data + off, ret);
+        s->off += ret;
+    }
+    return ret;
+}
+
+static int64_t http_parallel_seek(URLContext *h, int64_t off, int whence)
+{
+    HTTPContext *s = h->priv_data;
+
+    if (whence == AVSEEK_SIZE)
+        return s->filesize;
+    else if (whence == SEEK_CUR)
+        off += s->off;
+    else if (whence == SEEK_END)
+        off += s->filesize;
+    else if (whence != SEEK_SET)
+        return AVERROR(EINVAL);
+    if (off < 0)
+        return AVERROR(EINVAL);
+    s->off = off;
+    return off;
+}
+#endif /* HAVE_THREADS */
+
 static int http_read(URLContext *h, uint8_t *buf, int size)
 {
     HTTPContext *s = h->priv_data;
 
+#if HAVE_THREADS
+    if (s->par)
+        return http_parallel_read(h, buf, size);
+#endif
+
     if (s->icy_metaint > 0) {
         size = store_icy(h, size);
         if (size < 0)
@@ -1563,12 +2243,19 @@ static int http_close(URLContext *h)
     av_freep(&s->inflate_buffer);
 #endif /* CONFIG_ZLIB */
 
+#if HAVE_THREADS
+    http_parallel_stop(s);
+#endif
+
     if (!s->end_chunked_post)
         /* Close the write direction by sending the end of chunked encoding. */
         ret = http_shutdown(h, h->flags);
 
+    if (s->connection_pool && http_connection_reusable(h))
+        pool_release_connection(h);
     if (s->hd)
         ffurl_closep(&s->hd);
+    pool_free_connection(&s->conn);
     av_dict_free(&s->chained_options);
     return ret;
 }
@@ -1577,6 +2264,7 @@ static int64_t http_seek_internal(URLContext *h, int64_t off, int whence, int fo
 {
     HTTPContext *s = h->priv_data;
     URLContext *old_hd = s->hd;
+    HTTPPoolConnection *old_conn = s->conn;
     uint64_t old_off = s->off;
     uint8_t old_buf[BUFFER_SIZE];
     int old_buf_size, ret;
@@ -1607,7 +2295,8 @@ static int64_t http_seek_internal(URLContext *h, int64_t off, int whence, int fo
     /* we save the old context in case the seek fails */
     old_buf_size = s->buf_end - s->buf_ptr;
     memcpy(old_buf, s->buf_ptr, old_buf_size);
-    s->hd = NULL;
+    s->hd   = NULL;
+    s->conn = NULL;
 
     /* if it fails, continue on old connection */
     if ((ret = http_open_cnx(h, &options)) < 0) {
@@ -1615,29 +2304,44 @@ static int64_t http_seek_internal(URLContext *h, int64_t off, int whence, int fo
         memcpy(s->buffer, old_buf, old_buf_size);
         s->buf_ptr = s->buffer;
         s->buf_end = s->buffer + old_buf_size;
+        pool_free_connection(&s->conn);
         s->hd      = old_hd;
+        s->conn    = old_conn;
         s->off     = old_off;
         return ret;
     }
     av_dict_free(&options);
+    /* The old connection uses the interrupt callback of old_conn. */
     ffurl_close(old_hd);
+    pool_free_connection(&old_conn);
     return off;
 }
 
 static int64_t http_seek(URLContext *h, int64_t off, int whence)
 {
+#if HAVE_THREADS
+    HTTPContext *s = h->priv_data;
+    if (s->par)
+        return http_parallel_seek(h, off, whence);
+#endif
     return http_seek_internal(h, off, whence, 0);
 }
 
 static int http_get_file_handle(URLContext *h)
 {
     HTTPContext *s = h->priv_data;
+    if (!s->hd)
+        return AVERROR(ENOSYS);
     return ffurl_get_file_handle(s->hd);
 }
 
 static int http_get_short_seek(URLContext *h)
 {
     HTTPContext *s = h->priv_data;
+#if HAVE_THREADS
+    if (s->par)
+        return s->par->chunk_size;
+#endif
     return ffurl_get_short_seek(s->hd);
 }
 
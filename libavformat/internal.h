@@ -448,6 +448,14 @@ int ff_framehash_write_header(AVFormatContext *s);
  */
 int ff_read_packet(AVFormatContext *s, AVPacket *pkt);
 
+/**
+ * Like av_get_packet(), but reference the data in place without copying it
+ * when the protocol allows it (see ffio_read_buffer_ref()). pkt->data then
+ * does not point to the start of pkt->buf, so this must only be used by
+ * demuxers which do not free or reallocate pkt->data themselves.
+ */
+int ff_get_packet_ref(AVIOContext *s, AVPacket *pkt, int size);
+
 /**
  * Interleave a packet per dts in an output media file.
  *
@@ -6527,7 +6527,13 @@ static int mov_read_packet(AVFormatContext *s, AVPacket *pkt)
             goto retry;
         }
 
-        ret = av_get_packet(sc->pb, pkt, sample->size);
+        /* AAX and CENC samples are decrypted in place below, which would
+         * copy every page of a mapped packet anyway. */
+        if ((mov->dv_demux && sc->dv_audio_container) ||
+            mov->aax_mode || sc->cenc.aes_ctr)
+            ret = av_get_packet(sc->pb, pkt, sample->size);
+        else
+            ret = ff_get_packet_ref(sc->pb, pkt, sample->size);
         if (ret < 0) {
             if (should_retry(sc->pb, ret)) {
                 mov_current_sample_dec(sc);
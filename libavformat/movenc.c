@@ -21,6 +21,15 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include "config.h"
+
+#if HAVE_COPY_FILE_RANGE
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
+#include <errno.h>
+#include <unistd.h>
+#endif
 #include <stdint.h>
 #include <inttypes.h>
 
@@ -54,12 +63,14 @@
 #include "hevc.h"
 #include "rtpenc.h"
 #include "mov_chan.h"
+#include "url.h"
 #include "vpcc.h"
 
 static const AVOption options[] = {
     { "movflags", "MOV muxer flags", offsetof(MOVMuxContext, flags), AV_OPT_TYPE_FLAGS, {.i64 = 0}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
     { "rtphint", "Add RTP hint tracks", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_RTP_HINT}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
     { "moov_size", "maximum moov size so it can be placed at the begin", offsetof(MOVMuxContext, reserved_moov_size), AV_OPT_TYPE_INT, {.i64 = 0}, 0, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, 0 },
+    { "expected_duration", "Expected duration, used to reserve space for the moov atom with faststart", offsetof(MOVMuxContext, expected_duration), AV_OPT_TYPE_DURATION, {.i64 = 0}, 0, INT64_MAX, AV_OPT_FLAG_ENCODING_PARAM },
     { "empty_moov", "Make the initial moov atom empty", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_EMPTY_MOOV}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
     { "frag_keyframe", "Fragment at video keyframes", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_FRAG_KEYFRAME}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
     { "separate_moof", "Write separate moof/mdat atoms for each track", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_SEPARATE_MOOF}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
@@ -78,6 +89,7 @@ static const AVOption options[] = {
     { "use_metadata_tags", "Use mdta atom for metadata.", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_USE_MDTA}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
     { "skip_trailer", "Skip writing the mfra/tfra/mfro trailer for fragmented files", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_SKIP_TRAILER}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
     { "negative_cts_offsets", "Use negative CTS offsets (reducing the need for edit lists)", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_NEGATIVE_CTS_OFFSETS}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
+    { "frag_every_frame", "Fragment at every frame", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_FRAG_EVERY_FRAME}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
     FF_RTP_FLAG_OPTS(MOVMuxContext, rtp_flags),
     { "skip_iods", "Skip writing iods atom.", offsetof(MOVMuxContext, iods_skip), AV_OPT_TYPE_BOOL, {.i64 = 1}, 0, 1, AV_OPT_FLAG_ENCODING_PARAM},
     { "iods_audio_profile", "iods audio profile atom.", offsetof(MOVMuxContext, iods_audio_profile), AV_OPT_TYPE_INT, {.i64 = -1}, -1, 255, AV_OPT_FLAG_ENCODING_PARAM},
@@ -5347,7 +5359,8 @@ static int mov_write_single_packet(AVFormatContext *s, AVPacket *pkt)
              (mov->max_fragment_size && mov->mdat_size + size >= mov->max_fragment_size) ||
              (mov->flags & FF_MOV_FLAG_FRAG_KEYFRAME &&
               par->codec_type == AVMEDIA_TYPE_VIDEO &&
-              trk->entry && pkt->flags & AV_PKT_FLAG_KEY)) {
+              trk->entry && pkt->flags & AV_PKT_FLAG_KEY) ||
+             (mov->flags & FF_MOV_FLAG_FRAG_EVERY_FRAME && trk->entry)) {
             if (frag_duration >= mov->min_fragment_duration) {
                 // Set the duration of this track to line up with the next
                 // sample in this track. This avoids relying on AVPacket
@@ -5789,7 +5802,8 @@ static int mov_init(AVFormatContext *s)
     if (mov->max_fragment_duration || mov->max_fragment_size ||
         mov->flags & (FF_MOV_FLAG_EMPTY_MOOV |
                       FF_MOV_FLAG_FRAG_KEYFRAME |
-                      FF_MOV_FLAG_FRAG_CUSTOM))
+                      FF_MOV_FLAG_FRAG_CUSTOM |
+                      FF_MOV_FLAG_FRAG_EVERY_FRAME))
         mov->flags |= FF_MOV_FLAG_FRAGMENT;
 
     /* Set other implicit flags immediately */
@@ -6070,6 +6084,45 @@ static int mov_init(AVFormatContext *s)
     return 0;
 }
 
+/*
+ * Estimate the moov size for the expected duration, assuming every sample
+ * is stored in its own chunk with 64-bit offsets and has its own stts entry.
+ * The sample rates are taken from the stream parameters, so more samples
+ * than this (e.g. variable frame rate video) can still exceed the estimate,
+ * in which case the second pass is run.
+ */
+static int estimate_moov_size(AVFormatContext *s)
+{
+    MOVMuxContext *mov = s->priv_data;
+    double duration = mov->expected_duration / (double)AV_TIME_BASE;
+    double size = 4096;
+    int i;
+
+    for (i = 0; i < mov->nb_streams; i++) {
+        MOVTrack *track = &mov->tracks[i];
+        AVCodecParameters *par = track->par;
+        double rate = 10;
+        int entry_size = 8 + 4 + 12 + 8; /* stts, stsz, stsc, co64 */
+
+        if (!par)
+            continue;
+        size += 1024 + par->extradata_size;
+
+        if (par->codec_type == AVMEDIA_TYPE_VIDEO) {
+            AVRational fr = track->st ? track->st->avg_frame_rate : (AVRational){ 0, 1 };
+            rate        = fr.num > 0 && fr.den > 0 ? av_q2d(fr) : 60;
+            entry_size += 8 + 4; /* ctts, stss */
+        } else if (par->codec_type == AVMEDIA_TYPE_AUDIO && par->sample_rate > 0) {
+            rate = par->sample_rate / (double)(par->frame_size > 0 ? par->frame_size : 1024);
+        }
+        size += duration * rate * entry_size;
+    }
+    /* headroom for metadata */
+    size += size / 16;
+
+    return FFMIN(size, 1 << 30);
+}
+
 static int mov_write_header(AVFormatContext *s)
 {
     AVIOContext *pb = s->pb;
@@ -6148,12 +6201,20 @@ static int mov_write_header(AVFormatContext *s)
     if (mov->flags & FF_MOV_FLAG_FRAGMENT) {
         /* If no fragmentation options have been set, set a default. */
         if (!(mov->flags & (FF_MOV_FLAG_FRAG_KEYFRAME |
-                            FF_MOV_FLAG_FRAG_CUSTOM)) &&
+                            FF_MOV_FLAG_FRAG_CUSTOM |
+                            FF_MOV_FLAG_FRAG_EVERY_FRAME)) &&
             !mov->max_fragment_duration && !mov->max_fragment_size)
             mov->flags |= FF_MOV_FLAG_FRAG_KEYFRAME;
     } else {
-        if (mov->flags & FF_MOV_FLAG_FASTSTART)
+        if (mov->flags & FF_MOV_FLAG_FASTSTART) {
             mov->reserved_header_pos = avio_tell(pb);
+            if (mov->expected_duration > 0) {
+                mov->faststart_reserve = estimate_moov_size(s);
+                avio_wb32(pb, mov->faststart_reserve);
+                ffio_wfourcc(pb, "free");
+                ffio_fill(pb, 0, mov->faststart_reserve - 8);
+            }
+        }
         mov_write_mdat_tag(pb, mov);
     }
 
@@ -6288,6 +6349,49 @@ static int compute_sidx_size(AVFormatContext *s)
     return sidx_size;
 }
 
+#if HAVE_COPY_FILE_RANGE
+/*
+ * Move the data in [start, end) forward by shift bytes inside the kernel.
+ * Copying backwards in chunks of at most shift bytes keeps source and
+ * destination apart. Returns AVERROR(ENOSYS) if nothing could be copied
+ * this way, so the caller can fall back to a userspace copy.
+ */
+static int shift_data_in_kernel(AVIOContext *read_pb, AVIOContext *write_pb,
+                                int64_t start, int64_t end, int shift)
+{
+    URLContext *rh = ffio_geturlcontext(read_pb);
+    URLContext *wh = ffio_geturlcontext(write_pb);
+    int64_t pos = end;
+    int rfd, wfd;
+
+    if (!rh || !wh)
+        return AVERROR(ENOSYS);
+    rfd = ffurl_get_file_handle(rh);
+    wfd = ffurl_get_file_handle(wh);
+    if (rfd < 0 || wfd < 0)
+        return AVERROR(ENOSYS);
+
+    while (pos > start) {
+        int64_t len = FFMIN(shift, pos - start);
+        loff_t in   = pos - len;
+        loff_t out  = in + shift;
+
+        pos -= len;
+        while (len > 0) {
+            ssize_t n = copy_file_range(rfd, &in, wfd, &out, len, 0);
+            if (n <= 0) {
+                int err = n < 0 ? AVERROR(errno) : AVERROR(EIO);
+                if (pos + len == end)
+                    return AVERROR(ENOSYS);
+                return err;
+            }
+            len -= n;
+        }
+    }
+    return 0;
+}
+#endif
+
 static int shift_data(AVFormatContext *s)
 {
     int ret = 0, moov_size;
@@ -6325,6 +6429,17 @@ static int shift_data(AVFormatContext *s)
     /* mark the end of the shift to up to the last data we wrote, and get ready
      * for writing */
     pos_end = avio_tell(s->pb);
+
+#if HAVE_COPY_FILE_RANGE
+    ret = shift_data_in_kernel(read_pb, s->pb, mov->reserved_header_pos,
+                               pos_end, moov_size);
+    if (ret != AVERROR(ENOSYS)) {
+        ff_format_io_close(s, &read_pb);
+        goto end;
+    }
+    ret = 0;
+#endif
+
     avio_seek(s->pb, mov->reserved_header_pos + moov_size, SEEK_SET);
 
     /* start reading at where the new moov will be placed */
@@ -6418,6 +6533,27 @@ static int mov_write_trailer(AVFormatContext *s)
         }
         avio_seek(pb, mov->reserved_moov_size > 0 ? mov->reserved_header_pos : moov_pos, SEEK_SET);
 
+        if (mov->faststart_reserve) {
+            int64_t size;
+            if ((res = get_moov_size(s)) < 0)
+                return res;
+            size = mov->faststart_reserve - res;
+            if (size == 0 || size >= 8) {
+                avio_seek(pb, mov->reserved_header_pos, SEEK_SET);
+                if ((res = mov_write_moov_tag(pb, mov, s)) < 0)
+                    return res;
+                /* the payload of the free atom is already zeroed */
+                if (size) {
+                    avio_wb32(pb, size);
+                    ffio_wfourcc(pb, "free");
+                }
+                avio_seek(pb, moov_pos, SEEK_SET);
+                return 0;
+            }
+            av_log(s, AV_LOG_WARNING, "%d bytes reserved for the moov atom, but "
+                   "%d needed\n", mov->faststart_reserve, res);
+        }
+
         if (mov->flags & FF_MOV_FLAG_FASTSTART) {
             av_log(s, AV_LOG_INFO, "Starting second pass: moving the moov atom to the beginning of the file\n");
             res = shift_data(s);
@@ -155,10 +155,23 @@ struct MpegTSContext {
     unsigned int nb_prg;
     struct Program *prg;
 
+    /** set if some program has discard=AVDISCARD_ALL */
+    int discard_any;
+    /** bumped whenever the result of discard_pid() may change */
+    unsigned discard_gen;
+    /** discard_gen << 1 | discard_pid() result, per pid */
+    unsigned discard_cache[NB_PID_MAX];
+    /** AVProgram.discard == AVDISCARD_ALL, as of the last check */
+    uint8_t *prg_discard;
+    unsigned int prg_discard_size;
+    int nb_prg_discard;
+
     int8_t crc_validity[NB_PID_MAX];
     /** filters for various streams specified by PMT + for the PAT and PMT */
     MpegTSFilter *pids[NB_PID_MAX];
     int current_pid;
+
+    AVBufferPool *pools[32];
 };
 
 #define MPEGTS_OPTIONS \
@@ -276,6 +289,7 @@ static void clear_program(MpegTSContext *ts, unsigned int programid)
     int i;
 
     clear_avprogram(ts, programid);
+    ts->discard_gen++;
     for (i = 0; i < ts->nb_prg; i++)
         if (ts->prg[i].id == programid) {
             ts->prg[i].nb_pids = 0;
@@ -287,6 +301,7 @@ static void clear_programs(MpegTSContext *ts)
 {
     av_freep(&ts->prg);
     ts->nb_prg = 0;
+    ts->discard_gen++;
 }
 
 static void add_pat_entry(MpegTSContext *ts, unsigned int programid)
@@ -301,6 +316,7 @@ static void add_pat_entry(MpegTSContext *ts, unsigned int programid)
     p->nb_pids = 0;
     p->pmt_found = 0;
     ts->nb_prg++;
+    ts->discard_gen++;
 }
 
 static void add_pid_to_pmt(MpegTSContext *ts, unsigned int programid,
@@ -319,6 +335,7 @@ static void add_pid_to_pmt(MpegTSContext *ts, unsigned int programid,
             return;
 
     p->pids[p->nb_pids++] = pid;
+    ts->discard_gen++;
 }
 
 static void set_pmt_found(MpegTSContext *ts, unsigned int programid)
@@ -341,6 +358,39 @@ static void set_pcr_pid(AVFormatContext *s, unsigned int programid, unsigned int
     }
 }
 
+/**
+ * Check the programs for changes of their discard setting. Must be called
+ * before handling packets, so that discard_pid() can use its cached results.
+ */
+static void update_discard_state(MpegTSContext *ts)
+{
+    AVFormatContext *s = ts->stream;
+    int k, any = 0, changed = s->nb_programs != ts->nb_prg_discard;
+    uint8_t *prg_discard;
+
+    prg_discard = av_fast_realloc(ts->prg_discard, &ts->prg_discard_size,
+                                  s->nb_programs);
+    if (!prg_discard) {
+        /* cannot track changes, recheck everything */
+        ts->discard_any = 1;
+        ts->discard_gen++;
+        return;
+    }
+    ts->prg_discard = prg_discard;
+
+    for (k = 0; k < s->nb_programs; k++) {
+        int discard = s->programs[k]->discard == AVDISCARD_ALL;
+        if (k >= ts->nb_prg_discard || prg_discard[k] != discard)
+            changed = 1;
+        prg_discard[k] = discard;
+        any           |= discard;
+    }
+    ts->nb_prg_discard = s->nb_programs;
+    ts->discard_any    = any;
+    if (changed)
+        ts->discard_gen++;
+}
+
 /**
  * @brief discard_pid() decides if the pid is to be discarded according
  *                      to caller's programs selection
@@ -352,17 +402,17 @@ static void set_pcr_pid(AVFormatContext *s, unsigned int programid, unsigned int
 static int discard_pid(MpegTSContext *ts, unsigned int pid)
 {
     int i, j, k;
-    int used = 0, discarded = 0;
+    int used = 0, discarded = 0, ret;
     struct Program *p;
 
     /* If none of the programs have .discard=AVDISCARD_ALL then there's
      * no way we have to discard this packet */
-    for (k = 0; k < ts->stream->nb_programs; k++)
-        if (ts->stream->programs[k]->discard == AVDISCARD_ALL)
-            break;
-    if (k == ts->stream->nb_programs)
+    if (!ts->discard_any)
         return 0;
 
+    if (ts->discard_cache[pid] >> 1 == ts->discard_gen)
+        return ts->discard_cache[pid] & 1;
+
     for (i = 0; i < ts->nb_prg; i++) {
         p = &ts->prg[i];
         for (j = 0; j < p->nb_pids; j++) {
@@ -380,7 +430,9 @@ static int discard_pid(MpegTSContext *ts, unsigned int pid)
         }
     }
 
-    return !used && discarded;
+    ret = !used && discarded;
+    ts->discard_cache[pid] = ts->discard_gen << 1 | ret;
+    return ret;
 }
 
 /**
@@ -878,6 +930,18 @@ static void reset_pes_packet_state(PESContext *pes)
     av_buffer_unref(&pes->buffer);
 }
 
+static AVBufferRef *buffer_pool_get(MpegTSContext *ts, int size)
+{
+    int index = av_log2(size + AV_INPUT_BUFFER_PADDING_SIZE);
+    if (!ts->pools[index]) {
+        int pool_size = FFMIN(MAX_PES_PAYLOAD + AV_INPUT_BUFFER_PADDING_SIZE, 2 << index);
+        ts->pools[index] = av_buffer_pool_init(pool_size, NULL);
+        if (!ts->pools[index])
+            return NULL;
+    }
+    return av_buffer_pool_get(ts->pools[index]);
+}
+
 static void new_data_packet(const uint8_t *buffer, int len, AVPacket *pkt)
 {
     av_init_packet(pkt);
@@ -1075,8 +1139,7 @@ static int mpegts_push_data(MpegTSFilter *filter,
                         pes->total_size = MAX_PES_PAYLOAD;
 
                     /* allocate pes buffer */
-                    pes->buffer = av_buffer_alloc(pes->total_size +
-                                                  AV_INPUT_BUFFER_PADDING_SIZE);
+                    pes->buffer = buffer_pool_get(ts, pes->total_size);
                     if (!pes->buffer)
                         return AVERROR(ENOMEM);
 
@@ -1236,8 +1299,7 @@ skip:
                     if (ret < 0)
                         return ret;
                     pes->total_size = MAX_PES_PAYLOAD;
-                    pes->buffer = av_buffer_alloc(pes->total_size +
-                                                  AV_INPUT_BUFFER_PADDING_SIZE);
+                    pes->buffer = buffer_pool_get(ts, pes->total_size);
                     if (!pes->buffer)
                         return AVERROR(ENOMEM);
                     ts->stop_parse = 1;
@@ -2225,6 +2287,7 @@ static void sdt_cb(MpegTSFilter *filter, const uint8_t *section, int section_len
                 name = getstr8(&p, p_end);
                 if (name) {
                     AVProgram *program = av_new_program(ts->stream, sid);
+                    ts->discard_gen++;
                     if (program) {
                         av_dict_set(&program->metadata, "service_name", name, 0);
                         av_dict_set(&program->metadata, "service_provider",
@@ -2256,10 +2319,12 @@ static int handle_packet(MpegTSContext *ts, const uint8_t *packet)
     int64_t pos;
 
     pid = AV_RB16(packet + 1) & 0x1fff;
-    if (pid && discard_pid(ts, pid))
+    tss = ts->pids[pid];
+    /* PSI sections are always parsed, so that the pids of discarded
+     * programs stay known when the PAT is reparsed */
+    if (pid && (!tss || tss->type != MPEGTS_SECTION) && discard_pid(ts, pid))
         return 0;
     is_start = packet[1] & 0x40;
-    tss = ts->pids[pid];
     if (ts->auto_guess && !tss && is_start) {
         add_pes_stream(ts, pid, -1);
         tss = ts->pids[pid];
@@ -2505,6 +2570,8 @@ static int handle_packets(MpegTSContext *ts, int64_t nb_packets)
         }
     }
 
+    update_discard_state(ts);
+
     ts->stop_parse = 0;
     packet_num = 0;
     memset(packet + TS_PACKET_SIZE, 0, AV_INPUT_BUFFER_PADDING_SIZE);
@@ -2800,6 +2867,10 @@ static void mpegts_free(MpegTSContext *ts)
     int i;
 
     clear_programs(ts);
+    av_freep(&ts->prg_discard);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(ts->pools); i++)
+        av_buffer_pool_uninit(&ts->pools[i]);
 
     for (i = 0; i < NB_PID_MAX; i++)
         if (ts->pids[i])
@@ -2910,6 +2981,7 @@ int avpriv_mpegts_parse_packet(MpegTSContext *ts, AVPacket *pkt,
 
     len1 = len;
     ts->pkt = pkt;
+    update_discard_state(ts);
     for (;;) {
         ts->stop_parse = 0;
         if (len < TS_PACKET_SIZE)
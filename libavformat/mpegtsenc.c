@@ -73,6 +73,10 @@ enum {
     MPEGTS_SERVICE_TYPE_ADVANCED_CODEC_DIGITAL_HDTV  = 0x19,
     MPEGTS_SERVICE_TYPE_HEVC_DIGITAL_HDTV            = 0x1F,
 };
+#define M2TS_PACKET_SIZE (TS_PACKET_SIZE + 4)
+/* 7 TS packets fit in the payload of a 1500 byte MTU UDP datagram */
+#define TS_BURST_PACKETS 7
+
 typedef struct MpegTSWrite {
     const AVClass *av_class;
     MpegTSSection pat; /* MPEG-2 PAT table */
@@ -115,6 +119,10 @@ typedef struct MpegTSWrite {
     int64_t last_sdt_ts;
 
     int omit_video_pes_length;
+
+    /* TS packets are assembled here and written out in bursts */
+    uint8_t burst[TS_BURST_PACKETS * M2TS_PACKET_SIZE];
+    int burst_len;
 } MpegTSWrite;
 
 /* a PES packet header is generated every DEFAULT_PES_HEADER_FREQ packets */
@@ -241,6 +249,7 @@ typedef struct MpegTSWriteStream {
     uint8_t *payload;
     AVFormatContext *amux;
     AVRational user_tb;
+    int pes_stream_id;
 
     /* For Opus */
     int opus_queued_samples;
@@ -738,27 +747,70 @@ fail:
 
 static int64_t get_pcr(const MpegTSWrite *ts, AVIOContext *pb)
 {
-    return av_rescale(avio_tell(pb) + 11, 8 * PCR_TIME_BASE, ts->mux_rate) +
+    return av_rescale(avio_tell(pb) + ts->burst_len + 11, 8 * PCR_TIME_BASE, ts->mux_rate) +
            ts->first_pcr;
 }
 
-static void mpegts_prefix_m2ts_header(AVFormatContext *s)
+static void mpegts_flush_burst(AVFormatContext *s)
+{
+    MpegTSWrite *ts = s->priv_data;
+
+    if (ts->burst_len) {
+        avio_write(s->pb, ts->burst, ts->burst_len);
+        ts->burst_len = 0;
+    }
+}
+
+/* Return the space for the next TS packet in the burst buffer.
+ * The packet must be completed with mpegts_commit_packet(). */
+static uint8_t *mpegts_get_packet(AVFormatContext *s)
+{
+    MpegTSWrite *ts = s->priv_data;
+
+    if (ts->burst_len > sizeof(ts->burst) - M2TS_PACKET_SIZE)
+        mpegts_flush_burst(s);
+    return ts->burst + ts->burst_len + (ts->m2ts_mode ? 4 : 0);
+}
+
+static void mpegts_commit_packet(AVFormatContext *s)
 {
     MpegTSWrite *ts = s->priv_data;
+
     if (ts->m2ts_mode) {
-        int64_t pcr = get_pcr(s->priv_data, s->pb);
-        uint32_t tp_extra_header = pcr % 0x3fffffff;
-        tp_extra_header = AV_RB32(&tp_extra_header);
-        avio_write(s->pb, (unsigned char *) &tp_extra_header,
-                   sizeof(tp_extra_header));
+        int64_t pcr = get_pcr(ts, s->pb);
+        AV_WB32(ts->burst + ts->burst_len, pcr % 0x3fffffff);
+        ts->burst_len += 4;
     }
+    ts->burst_len += TS_PACKET_SIZE;
 }
 
 static void section_write_packet(MpegTSSection *s, const uint8_t *packet)
 {
     AVFormatContext *ctx = s->opaque;
-    mpegts_prefix_m2ts_header(ctx);
-    avio_write(ctx->pb, packet, TS_PACKET_SIZE);
+    memcpy(mpegts_get_packet(ctx), packet, TS_PACKET_SIZE);
+    mpegts_commit_packet(ctx);
+}
+
+static int get_pes_stream_id(AVFormatContext *s, AVStream *st)
+{
+    MpegTSWrite *ts = s->priv_data;
+
+    switch (st->codecpar->codec_type) {
+    case AVMEDIA_TYPE_VIDEO:
+        return st->codecpar->codec_id == AV_CODEC_ID_DIRAC ? 0xfd : 0xe0;
+    case AVMEDIA_TYPE_AUDIO:
+        if (st->codecpar->codec_id == AV_CODEC_ID_MP2 ||
+            st->codecpar->codec_id == AV_CODEC_ID_MP3 ||
+            st->codecpar->codec_id == AV_CODEC_ID_AAC)
+            return 0xc0;
+        if (st->codecpar->codec_id == AV_CODEC_ID_AC3 && ts->m2ts_mode)
+            return 0xfd;
+        return 0xbd;
+    case AVMEDIA_TYPE_DATA:
+        return st->codecpar->codec_id == AV_CODEC_ID_TIMED_ID3 ? 0xbd : 0xfc;
+    default:
+        return 0xbd;
+    }
 }
 
 static int mpegts_init(AVFormatContext *s)
@@ -856,6 +908,7 @@ static int mpegts_init(AVFormatContext *s)
         st->priv_data = ts_st;
 
         ts_st->user_tb = st->time_base;
+        ts_st->pes_stream_id = get_pes_stream_id(s, st);
         avpriv_set_pts_info(st, 33, 1, 90000);
 
         ts_st->payload = av_mallocz(ts->pes_payload_size);
@@ -1071,8 +1124,8 @@ static int write_pcr_bits(uint8_t *buf, int64_t pcr)
 /* Write a single null transport stream packet */
 static void mpegts_insert_null_packet(AVFormatContext *s)
 {
+    uint8_t *buf = mpegts_get_packet(s);
     uint8_t *q;
-    uint8_t buf[TS_PACKET_SIZE];
 
     q    = buf;
     *q++ = 0x47;
@@ -1080,8 +1133,7 @@ static void mpegts_insert_null_packet(AVFormatContext *s)
     *q++ = 0xff;
     *q++ = 0x10;
     memset(q, 0x0FF, TS_PACKET_SIZE - (q - buf));
-    mpegts_prefix_m2ts_header(s);
-    avio_write(s->pb, buf, TS_PACKET_SIZE);
+    mpegts_commit_packet(s);
 }
 
 /* Write a single transport stream packet with a PCR and no payload */
@@ -1089,8 +1141,8 @@ static void mpegts_insert_pcr_only(AVFormatContext *s, AVStream *st)
 {
     MpegTSWrite *ts = s->priv_data;
     MpegTSWriteStream *ts_st = st->priv_data;
+    uint8_t *buf = mpegts_get_packet(s);
     uint8_t *q;
-    uint8_t buf[TS_PACKET_SIZE];
 
     q    = buf;
     *q++ = 0x47;
@@ -1110,8 +1162,7 @@ static void mpegts_insert_pcr_only(AVFormatContext *s, AVStream *st)
 
     /* stuffing bytes */
     memset(q, 0xFF, TS_PACKET_SIZE - (q - buf));
-    mpegts_prefix_m2ts_header(s);
-    avio_write(s->pb, buf, TS_PACKET_SIZE);
+    mpegts_commit_packet(s);
 }
 
 static void write_pts(uint8_t *q, int fourbits, int64_t pts)
@@ -1171,7 +1222,7 @@ static void mpegts_write_pes(AVFormatContext *s, AVStream *st,
 {
     MpegTSWriteStream *ts_st = st->priv_data;
     MpegTSWrite *ts = s->priv_data;
-    uint8_t buf[TS_PACKET_SIZE];
+    uint8_t *buf;
     uint8_t *q;
     int val, is_start, len, header_len, write_pcr, is_dvb_subtitle, is_dvb_teletext, flags;
     int afc_len, stuffing_len;
@@ -1179,7 +1230,6 @@ static void mpegts_write_pes(AVFormatContext *s, AVStream *st,
     int64_t delay = av_rescale(s->max_delay, 90000, AV_TIME_BASE);
     int force_pat = st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO && key && !ts_st->prev_payload_key;
 
-    av_assert0(ts_st->payload != buf || st->codecpar->codec_type != AVMEDIA_TYPE_VIDEO);
     if (ts->flags & MPEGTS_FLAG_PAT_PMT_AT_FRAMES && st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
         force_pat = 1;
     }
@@ -1212,6 +1262,7 @@ static void mpegts_write_pes(AVFormatContext *s, AVStream *st,
         }
 
         /* prepare packet header */
+        buf  = mpegts_get_packet(s);
         q    = buf;
         *q++ = 0x47;
         val  = ts_st->pid >> 8;
@@ -1253,39 +1304,17 @@ static void mpegts_write_pes(AVFormatContext *s, AVStream *st,
             *q++ = 0x00;
             *q++ = 0x00;
             *q++ = 0x01;
-            is_dvb_subtitle = 0;
-            is_dvb_teletext = 0;
-            if (st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
-                if (st->codecpar->codec_id == AV_CODEC_ID_DIRAC)
-                    *q++ = 0xfd;
-                else
-                    *q++ = 0xe0;
-            } else if (st->codecpar->codec_type == AVMEDIA_TYPE_AUDIO &&
-                       (st->codecpar->codec_id == AV_CODEC_ID_MP2 ||
-                        st->codecpar->codec_id == AV_CODEC_ID_MP3 ||
-                        st->codecpar->codec_id == AV_CODEC_ID_AAC)) {
-                *q++ = 0xc0;
-            } else if (st->codecpar->codec_type == AVMEDIA_TYPE_AUDIO &&
-                        st->codecpar->codec_id == AV_CODEC_ID_AC3 &&
-                        ts->m2ts_mode) {
-                *q++ = 0xfd;
-            } else if (st->codecpar->codec_type == AVMEDIA_TYPE_DATA &&
-                       st->codecpar->codec_id == AV_CODEC_ID_TIMED_ID3) {
-                *q++ = 0xbd;
-            } else if (st->codecpar->codec_type == AVMEDIA_TYPE_DATA) {
-                *q++ = stream_id != -1 ? stream_id : 0xfc;
+            is_dvb_subtitle = st->codecpar->codec_id == AV_CODEC_ID_DVB_SUBTITLE;
+            is_dvb_teletext = st->codecpar->codec_id == AV_CODEC_ID_DVB_TELETEXT;
+            if (st->codecpar->codec_type == AVMEDIA_TYPE_DATA &&
+                st->codecpar->codec_id != AV_CODEC_ID_TIMED_ID3 &&
+                stream_id != -1) {
+                *q++ = stream_id;
 
                 if (stream_id == 0xbd) /* asynchronous KLV */
                     pts = dts = AV_NOPTS_VALUE;
             } else {
-                *q++ = 0xbd;
-                if (st->codecpar->codec_type == AVMEDIA_TYPE_SUBTITLE) {
-                    if (st->codecpar->codec_id == AV_CODEC_ID_DVB_SUBTITLE) {
-                        is_dvb_subtitle = 1;
-                    } else if (st->codecpar->codec_id == AV_CODEC_ID_DVB_TELETEXT) {
-                        is_dvb_teletext = 1;
-                    }
-                }
+                *q++ = ts_st->pes_stream_id;
             }
             header_len = 0;
             flags      = 0;
@@ -1421,9 +1450,9 @@ static void mpegts_write_pes(AVFormatContext *s, AVStream *st,
 
         payload      += len;
         payload_size -= len;
-        mpegts_prefix_m2ts_header(s);
-        avio_write(s->pb, buf, TS_PACKET_SIZE);
+        mpegts_commit_packet(s);
     }
+    mpegts_flush_burst(s);
     ts_st->prev_payload_key = key;
 }
 
@@ -0,0 +1,150 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdio.h>
+
+#include "libavutil/dict.h"
+#include "libavutil/error.h"
+#include "libavutil/mem.h"
+#include "libavformat/avio_internal.h"
+
+#define FILE_SIZE (3 * 1024 * 1024 + 123)
+
+static uint8_t pattern(int64_t pos)
+{
+    return pos * 7 + (pos >> 12);
+}
+
+static int open_async(AVIOContext **pb, const char *filename, int flags)
+{
+    AVDictionary *opts = NULL;
+    int ret;
+
+    av_dict_set(&opts, "avio_flags", "async", 0);
+    ret = avio_open2(pb, filename, flags, NULL, &opts);
+    av_dict_free(&opts);
+    return ret;
+}
+
+/* check the file contents through a separate, synchronous context */
+static int check_file(const char *filename, int64_t size, int64_t patch_pos,
+                      const uint8_t *patch, int patch_size)
+{
+    AVIOContext *pb;
+    uint8_t buf[4096];
+    int64_t pos = 0;
+    int ret;
+
+    if ((ret = avio_open(&pb, filename, AVIO_FLAG_READ)) < 0)
+        return ret;
+    if (avio_size(pb) != size) {
+        avio_closep(&pb);
+        return AVERROR_INVALIDDATA;
+    }
+    while ((ret = avio_read(pb, buf, sizeof(buf))) > 0) {
+        int i;
+        for (i = 0; i < ret; i++, pos++) {
+            uint8_t expected = pattern(pos);
+            if (pos >= patch_pos && pos < patch_pos + patch_size)
+                expected = patch[pos - patch_pos];
+            if (buf[i] != expected) {
+                avio_closep(&pb);
+                return AVERROR_INVALIDDATA;
+            }
+        }
+    }
+    avio_closep(&pb);
+    return pos == size ? 0 : AVERROR_INVALIDDATA;
+}
+
+static int test_write(const char *filename)
+{
+    static const uint8_t patch[] = { 0xde, 0xad, 0xbe, 0xef };
+    AVIOContext *pb;
+    uint8_t *buf;
+    int i, ret;
+
+    if (!(buf = av_malloc(FILE_SIZE)))
+        return AVERROR(ENOMEM);
+    for (i = 0; i < FILE_SIZE; i++)
+        buf[i] = pattern(i);
+
+    if ((ret = open_async(&pb, filename, AVIO_FLAG_WRITE)) < 0) {
+        av_free(buf);
+        return ret;
+    }
+
+    printf("write: urlcontext %s\n", ffio_geturlcontext(pb) ? "exposed" : "hidden");
+
+    /* queue everything at once so that the worker lags behind */
+    avio_write(pb, buf, FILE_SIZE);
+    av_free(buf);
+    avio_flush(pb);
+    printf("write: flush %s\n", check_file(filename, FILE_SIZE, 0, NULL, 0) ? "failed" : "ok");
+
+    avio_seek(pb, 100, SEEK_SET);
+    avio_write(pb, patch, sizeof(patch));
+    avio_flush(pb);
+    printf("write: patch %s\n",
+           check_file(filename, FILE_SIZE, 100, patch, sizeof(patch)) ? "failed" : "ok");
+
+    return avio_closep(&pb);
+}
+
+static int test_read(const char *filename)
+{
+    static const int64_t offsets[] = { 0, 5000, 4096, 1 << 20, 70000, FILE_SIZE - 10 };
+    AVIOContext *pb;
+    uint8_t buf[64];
+    int i, j, ret;
+
+    if ((ret = open_async(&pb, filename, AVIO_FLAG_READ)) < 0)
+        return ret;
+
+    printf("read: urlcontext %s\n", ffio_geturlcontext(pb) ? "exposed" : "hidden");
+    printf("read: pause %s\n", avio_pause(pb, 1) == AVERROR(ENOSYS) ? "rejected" : "accepted");
+
+    for (i = 0; i < FF_ARRAY_ELEMS(offsets); i++) {
+        int ok = avio_seek(pb, offsets[i], SEEK_SET) == offsets[i];
+        int len = avio_read(pb, buf, sizeof(buf));
+
+        ok &= len == FFMIN(sizeof(buf), FILE_SIZE - offsets[i]);
+        for (j = 0; ok && j < len; j++)
+            ok = buf[j] == pattern(offsets[i] + j);
+        printf("read: seek to %"PRId64" %s\n", offsets[i], ok ? "ok" : "failed");
+    }
+
+    avio_closep(&pb);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int ret;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <file>\n", argv[0]);
+        return 1;
+    }
+
+    if ((ret = test_write(argv[1])) < 0 || (ret = test_read(argv[1])) < 0) {
+        fprintf(stderr, "%s\n", av_err2str(ret));
+        return 1;
+    }
+    return 0;
+}
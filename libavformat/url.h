@@ -27,6 +27,7 @@
 #include "avio.h"
 #include "libavformat/version.h"
 
+#include "libavutil/buffer.h"
 #include "libavutil/dict.h"
 #include "libavutil/log.h"
 
@@ -35,6 +36,8 @@
 
 extern const AVClass ffurl_context_class;
 
+#define URL_AVIO_FLAG_ASYNC 0x0001 /**< read ahead / write behind on a background thread */
+
 typedef struct URLContext {
     const AVClass *av_class;    /**< information for av_log(). Set by url_open(). */
     const struct URLProtocol *prot;
@@ -49,6 +52,8 @@ typedef struct URLContext {
     const char *protocol_whitelist;
     const char *protocol_blacklist;
     int min_packet_size;        /**< if non zero, the stream is packetized with this min packet size */
+    int avio_flags;             /**< URL_AVIO_FLAG_* for the AVIOContext wrapping this URLContext */
+    int async_buffer_size;      /**< ring buffer size used with URL_AVIO_FLAG_ASYNC */
 } URLContext;
 
 typedef struct URLProtocol {
@@ -96,6 +101,13 @@ typedef struct URLProtocol {
     int (*url_close_dir)(URLContext *h);
     int (*url_delete)(URLContext *h);
     int (*url_move)(URLContext *h_src, URLContext *h_dst);
+    /**
+     * Return a pointer to size bytes of the resource at offset pos without
+     * copying, and optionally a packet-like reference to them, see
+     * ffurl_get_buffer_ref().
+     */
+    int (*url_get_buffer_ref)(URLContext *h, int64_t pos, int size,
+                              AVBufferRef **buf, uint8_t **data);
     const char *default_whitelist;
 } URLProtocol;
 
@@ -257,6 +269,22 @@ int ffurl_get_multi_file_handle(URLContext *h, int **handles, int *numhandles);
  */
 int ffurl_get_short_seek(URLContext *h);
 
+/**
+ * Access size bytes of the resource at absolute offset pos in place,
+ * e.g. in a memory mapping. The current position of h is not changed.
+ * At least AV_INPUT_BUFFER_PADDING_SIZE readable bytes follow the returned
+ * data.
+ *
+ * @param buf if NULL, data is only valid until h is closed. Otherwise, set
+ *            to a new reference to a buffer containing the data, which is
+ *            then writable and followed by zeroed padding like packet data
+ * @param data set to the start of the data
+ * @return size on success, AVERROR(ENOSYS) if the data cannot be
+ *         accessed in place, another negative error code on failure
+ */
+int ffurl_get_buffer_ref(URLContext *h, int64_t pos, int size,
+                         AVBufferRef **buf, uint8_t **data);
+
 /**
  * Signal the URLContext that we are done reading or writing the stream.
  *
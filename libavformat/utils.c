@@ -296,6 +296,23 @@ int av_get_packet(AVIOContext *s, AVPacket *pkt, int size)
     return append_packet_chunked(s, pkt, size);
 }
 
+int ff_get_packet_ref(AVIOContext *s, AVPacket *pkt, int size)
+{
+    av_init_packet(pkt);
+    pkt->data = NULL;
+    pkt->size = 0;
+    pkt->pos  = avio_tell(s);
+
+    if (size > 0 && ffio_read_buffer_ref(s, size, &pkt->buf, &pkt->data) == size) {
+        pkt->size = size;
+        return size;
+    }
+    pkt->buf  = NULL;
+    pkt->data = NULL;
+
+    return append_packet_chunked(s, pkt, size);
+}
+
 int av_append_packet(AVIOContext *s, AVPacket *pkt, int size)
 {
     if (!pkt->size)
@@ -2940,6 +2957,45 @@ static int has_codec_parameters(AVStream *st, const char **errmsg_ptr)
     return 1;
 }
 
+/**
+ * Check whether the stream parameters are to be taken from the parser,
+ * which for these codecs exports the dimensions and pixel format from the
+ * parameter sets, without decoding frames.
+ */
+static int probe_with_parser(AVFormatContext *s, AVStream *st)
+{
+    /* not st->parser, which is freed at the end of the stream */
+    if (!(s->flags & AVFMT_FLAG_FAST_PROBE) || !st->need_parsing)
+        return 0;
+
+    switch (st->codecpar->codec_id) {
+    case AV_CODEC_ID_H264:
+    case AV_CODEC_ID_HEVC:
+    case AV_CODEC_ID_MPEG1VIDEO:
+    case AV_CODEC_ID_MPEG2VIDEO:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static void update_params_from_parser(AVStream *st)
+{
+    AVCodecContext *avctx    = st->internal->avctx;
+    AVCodecParserContext *pc = st->parser;
+
+    if (!pc)
+        return;
+    if (!avctx->width && pc->width > 0 && pc->height > 0) {
+        avctx->width        = pc->width;
+        avctx->height       = pc->height;
+        avctx->coded_width  = pc->coded_width;
+        avctx->coded_height = pc->coded_height;
+    }
+    if (avctx->pix_fmt == AV_PIX_FMT_NONE && pc->format >= 0)
+        avctx->pix_fmt = pc->format;
+}
+
 /* returns 1 or 0 if or if not decoded data was returned, or a negative error */
 static int try_decode_frame(AVFormatContext *s, AVStream *st, AVPacket *avpkt,
                             AVDictionary **options)
@@ -3599,7 +3655,8 @@ FF_ENABLE_DEPRECATION_WARNINGS
         }
 
         // Try to just open decoders, in case this is enough to get parameters.
-        if (!has_codec_parameters(st, NULL) && st->request_probe <= 0) {
+        if (!has_codec_parameters(st, NULL) && st->request_probe <= 0 &&
+            !probe_with_parser(ic, st)) {
             if (codec && !avctx->codec)
                 if (avcodec_open2(avctx, codec, options ? &options[i] : &thread_opt) < 0)
                     av_log(ic, AV_LOG_WARNING,
@@ -3821,8 +3878,11 @@ FF_ENABLE_DEPRECATION_WARNINGS
          * least one frame of codec data, this makes sure the codec initializes
          * the channel configuration and does not only trust the values from
          * the container. */
-        try_decode_frame(ic, st, pkt,
-                         (options && i < orig_nb_streams) ? &options[i] : NULL);
+        if (probe_with_parser(ic, st))
+            update_params_from_parser(st);
+        else
+            try_decode_frame(ic, st, pkt,
+                             (options && i < orig_nb_streams) ? &options[i] : NULL);
 
         if (ic->flags & AVFMT_FLAG_NOBUFFER)
             av_packet_unref(pkt);
@@ -3857,6 +3917,27 @@ FF_ENABLE_DEPRECATION_WARNINGS
         }
     }
 
+    /* Decode the buffered packets of the streams whose parser did not
+     * provide the parameters, as if fastprobe had not been set. */
+    for (i = 0; i < ic->nb_streams; i++) {
+        AVPacketList *pktl;
+
+        st = ic->streams[i];
+        if (!probe_with_parser(ic, st) || has_codec_parameters(st, NULL))
+            continue;
+
+        av_log(ic, AV_LOG_DEBUG, "Stream #%d: parameters not found by the "
+               "parser, decoding\n", i);
+        for (pktl = ic->internal->packet_buffer; pktl; pktl = pktl->next) {
+            if (pktl->pkt.stream_index != i)
+                continue;
+            if (try_decode_frame(ic, st, &pktl->pkt,
+                                 (options && i < orig_nb_streams) ? &options[i] : NULL) < 0 ||
+                has_codec_parameters(st, NULL))
+                break;
+        }
+    }
+
     if (flush_codecs) {
         AVPacket empty_pkt = { 0 };
         int err = 0;
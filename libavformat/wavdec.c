@@ -691,7 +691,7 @@ smv_out:
         size = (size / st->codecpar->block_align) * st->codecpar->block_align;
     }
     size = FFMIN(size, left);
-    ret  = av_get_packet(s->pb, pkt, size);
+    ret  = ff_get_packet_ref(s->pb, pkt, size);
     if (ret < 0)
         return ret;
     pkt->stream_index = 0;
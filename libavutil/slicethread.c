@@ -21,6 +21,7 @@
 #include "mem.h"
 #include "thread.h"
 #include "avassert.h"
+#include "threadpool_internal.h"
 
 #if HAVE_PTHREADS || HAVE_W32THREADS || HAVE_OS2THREADS
 
@@ -48,6 +49,9 @@ struct AVSliceThread {
     void            *priv;
     void            (*worker_func)(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads);
     void            (*main_func)(void *priv);
+
+    AVThreadPoolClient *pool_client;
+    AVThreadPoolJob pool_job;
 };
 
 static int run_jobs(AVSliceThread *ctx)
@@ -64,6 +68,25 @@ static int run_jobs(AVSliceThread *ctx)
     return current_job == nb_jobs + nb_active_threads - 1;
 }
 
+/*
+ * With a shared pool, a lane may only start after the jobs of other
+ * contexts, so all lanes take their jobs in order from current_job: every
+ * job a running job may wait for has then been taken by a running lane.
+ */
+static void run_pool_jobs(AVSliceThread *ctx, int threadnr)
+{
+    unsigned nb_jobs = ctx->nb_jobs;
+    unsigned jobnr;
+
+    while ((jobnr = atomic_fetch_add_explicit(&ctx->current_job, 1, memory_order_acq_rel)) < nb_jobs)
+        ctx->worker_func(ctx->priv, jobnr, threadnr, nb_jobs, ctx->nb_active_threads);
+}
+
+static void pool_lane(void *priv, int lane)
+{
+    run_pool_jobs(priv, lane + 1);
+}
+
 static void *attribute_align_arg thread_worker(void *v)
 {
     WorkerContext *w = v;
@@ -165,6 +188,36 @@ int avpriv_slicethread_create(AVSliceThread **pctx, void *priv,
     return nb_threads;
 }
 
+int avpriv_slicethread_create_pool(AVSliceThread **pctx, AVThreadPool *pool, void *priv,
+                                   void (*worker_func)(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads),
+                                   int nb_threads)
+{
+    AVSliceThread *ctx;
+
+    av_assert0(nb_threads >= 0);
+    if (!nb_threads)
+        nb_threads = avpriv_threadpool_nb_threads(pool) + 1;
+
+    *pctx = ctx = av_mallocz(sizeof(*ctx));
+    if (!ctx)
+        return AVERROR(ENOMEM);
+
+    if (!(ctx->pool_client = avpriv_threadpool_client_alloc(pool))) {
+        av_freep(pctx);
+        return AVERROR(ENOMEM);
+    }
+
+    ctx->priv          = priv;
+    ctx->worker_func   = worker_func;
+    ctx->nb_threads    = nb_threads;
+    ctx->pool_job.func = pool_lane;
+    ctx->pool_job.priv = ctx;
+    atomic_init(&ctx->first_job, 0);
+    atomic_init(&ctx->current_job, 0);
+
+    return nb_threads;
+}
+
 void avpriv_slicethread_execute(AVSliceThread *ctx, int nb_jobs, int execute_main)
 {
     int nb_workers, i, is_last = 0;
@@ -172,6 +225,26 @@ void avpriv_slicethread_execute(AVSliceThread *ctx, int nb_jobs, int execute_mai
     av_assert0(nb_jobs > 0);
     ctx->nb_jobs           = nb_jobs;
     ctx->nb_active_threads = FFMIN(nb_jobs, ctx->nb_threads);
+
+    if (ctx->pool_client) {
+        /* job 0 always runs on thread 0, like with dedicated threads */
+        atomic_store_explicit(&ctx->current_job, 1, memory_order_relaxed);
+        ctx->pool_job.nb_lanes = ctx->nb_active_threads - 1;
+        if (ctx->pool_job.nb_lanes)
+            avpriv_threadpool_submit(ctx->pool_client, &ctx->pool_job);
+
+        ctx->worker_func(ctx->priv, 0, 0, nb_jobs, ctx->nb_active_threads);
+        run_pool_jobs(ctx, 0);
+
+        if (ctx->pool_job.nb_lanes) {
+            /* lanes no pool thread got to yet are run here */
+            while (avpriv_threadpool_run_lane(ctx->pool_client, &ctx->pool_job))
+                ;
+            avpriv_threadpool_wait(ctx->pool_client, &ctx->pool_job);
+        }
+        return;
+    }
+
     atomic_store_explicit(&ctx->first_job, 0, memory_order_relaxed);
     atomic_store_explicit(&ctx->current_job, ctx->nb_active_threads, memory_order_relaxed);
     nb_workers             = ctx->nb_active_threads;
@@ -209,6 +282,12 @@ void avpriv_slicethread_free(AVSliceThread **pctx)
         return;
 
     ctx = *pctx;
+    if (ctx->pool_client) {
+        avpriv_threadpool_client_free(&ctx->pool_client);
+        av_freep(pctx);
+        return;
+    }
+
     nb_workers = ctx->nb_threads;
     if (!ctx->main_func)
         nb_workers--;
@@ -246,6 +325,14 @@ int avpriv_slicethread_create(AVSliceThread **pctx, void *priv,
     return AVERROR(EINVAL);
 }
 
+int avpriv_slicethread_create_pool(AVSliceThread **pctx, AVThreadPool *pool, void *priv,
+                                   void (*worker_func)(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads),
+                                   int nb_threads)
+{
+    *pctx = NULL;
+    return AVERROR(EINVAL);
+}
+
 void avpriv_slicethread_execute(AVSliceThread *ctx, int nb_jobs, int execute_main)
 {
     av_assert0(0);
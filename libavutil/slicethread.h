@@ -19,6 +19,8 @@
 #ifndef AVUTIL_SLICETHREAD_H
 #define AVUTIL_SLICETHREAD_H
 
+#include "threadpool.h"
+
 typedef struct AVSliceThread AVSliceThread;
 
 /**
@@ -35,6 +37,22 @@ int avpriv_slicethread_create(AVSliceThread **pctx, void *priv,
                               void (*main_func)(void *priv),
                               int nb_threads);
 
+/**
+ * Create slice threading context running its jobs on a shared thread pool
+ * instead of threads of its own. The calling thread runs jobs as well.
+ * Jobs are started in order, job 0 by thread 0, and threadnr is unique
+ * among the jobs running concurrently. There is no main_func.
+ * @param pctx slice threading context returned here
+ * @param pool the thread pool, must outlive the context
+ * @param priv private pointer to be passed to callback function
+ * @param worker_func callback function to be executed
+ * @param nb_threads maximum number of jobs run concurrently, 0 for automatic
+ * @return return number of threads or negative AVERROR on failure
+ */
+int avpriv_slicethread_create_pool(AVSliceThread **pctx, AVThreadPool *pool, void *priv,
+                                   void (*worker_func)(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads),
+                                   int nb_threads);
+
 /**
  * Execute slice threading.
  * @param ctx slice threading context
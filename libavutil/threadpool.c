@@ -0,0 +1,320 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "avassert.h"
+#include "cpu.h"
+#include "mem.h"
+#include "thread.h"
+#include "threadpool.h"
+#include "threadpool_internal.h"
+
+#if HAVE_PTHREADS || HAVE_W32THREADS || HAVE_OS2THREADS
+
+struct AVThreadPoolClient {
+    AVThreadPool       *pool;
+    AVThreadPoolJob    *head;       ///< queued jobs with lanes left to start
+    AVThreadPoolJob    *tail;
+    AVThreadPoolClient *next;
+};
+
+struct AVThreadPool {
+    pthread_t          *threads;
+    int                nb_threads;
+
+    pthread_mutex_t    lock;
+    pthread_cond_t     work_cond;   ///< signalled when lanes are queued
+    pthread_cond_t     done_cond;   ///< signalled when a job has finished
+    AVThreadPoolClient *clients;
+    AVThreadPoolClient *next_client; ///< client to look at first for work
+    int                nb_queued;   ///< number of lanes not started yet
+    int                finished;
+};
+
+/* must be called with the lock held */
+static void dequeue_job(AVThreadPoolClient *c, AVThreadPoolJob *job)
+{
+    AVThreadPoolJob **p = &c->head, *prev = NULL;
+
+    while (*p != job) {
+        prev = *p;
+        p    = &(*p)->next;
+    }
+    *p = job->next;
+    if (c->tail == job)
+        c->tail = prev;
+    job->next = NULL;
+}
+
+/* must be called with the lock held and a lane left in the job */
+static int claim_lane(AVThreadPoolClient *c, AVThreadPoolJob *job)
+{
+    int lane = job->next_lane++;
+
+    if (job->next_lane == job->nb_lanes)
+        dequeue_job(c, job);
+    c->pool->nb_queued--;
+    return lane;
+}
+
+/* must be called with the lock held */
+static void finish_lane(AVThreadPool *pool, AVThreadPoolJob *job)
+{
+    if (++job->nb_finished == job->nb_lanes)
+        pthread_cond_broadcast(&pool->done_cond);
+}
+
+static void *attribute_align_arg pool_worker(void *arg)
+{
+    AVThreadPool *pool = arg;
+
+    pthread_mutex_lock(&pool->lock);
+    while (1) {
+        AVThreadPoolClient *c;
+        AVThreadPoolJob *job;
+        int lane;
+
+        while (!pool->nb_queued && !pool->finished)
+            pthread_cond_wait(&pool->work_cond, &pool->lock);
+        if (pool->finished)
+            break;
+
+        /* serve the clients round-robin, one lane at a time */
+        c = pool->next_client ? pool->next_client : pool->clients;
+        while (!c->head)
+            c = c->next ? c->next : pool->clients;
+        pool->next_client = c->next;
+
+        job  = c->head;
+        lane = claim_lane(c, job);
+
+        pthread_mutex_unlock(&pool->lock);
+        job->func(job->priv, lane);
+        pthread_mutex_lock(&pool->lock);
+
+        finish_lane(pool, job);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+AVThreadPool *av_threadpool_alloc(int nb_threads)
+{
+    AVThreadPool *pool;
+    int i;
+
+#if HAVE_W32THREADS
+    w32thread_init();
+#endif
+
+    if (nb_threads < 0)
+        return NULL;
+    if (!nb_threads)
+        nb_threads = av_cpu_count();
+
+    pool = av_mallocz(sizeof(*pool));
+    if (!pool)
+        return NULL;
+    pool->threads = av_calloc(nb_threads, sizeof(*pool->threads));
+    if (!pool->threads) {
+        av_free(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+
+    for (i = 0; i < nb_threads; i++) {
+        if (pthread_create(&pool->threads[i], NULL, pool_worker, pool)) {
+            av_threadpool_free(&pool);
+            return NULL;
+        }
+        pool->nb_threads++;
+    }
+
+    return pool;
+}
+
+void av_threadpool_free(AVThreadPool **ppool)
+{
+    AVThreadPool *pool = *ppool;
+    int i;
+
+    if (!pool)
+        return;
+
+    av_assert0(!pool->clients);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->finished = 1;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (i = 0; i < pool->nb_threads; i++)
+        pthread_join(pool->threads[i], NULL);
+
+    pthread_cond_destroy(&pool->done_cond);
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_mutex_destroy(&pool->lock);
+    av_freep(&pool->threads);
+    av_freep(ppool);
+}
+
+int avpriv_threadpool_nb_threads(AVThreadPool *pool)
+{
+    return pool->nb_threads;
+}
+
+AVThreadPoolClient *avpriv_threadpool_client_alloc(AVThreadPool *pool)
+{
+    AVThreadPoolClient *c = av_mallocz(sizeof(*c));
+
+    if (!c)
+        return NULL;
+    c->pool = pool;
+
+    pthread_mutex_lock(&pool->lock);
+    c->next       = pool->clients;
+    pool->clients = c;
+    pthread_mutex_unlock(&pool->lock);
+
+    return c;
+}
+
+void avpriv_threadpool_client_free(AVThreadPoolClient **pc)
+{
+    AVThreadPoolClient *c = *pc, **p;
+    AVThreadPool *pool;
+
+    if (!c)
+        return;
+    pool = c->pool;
+
+    pthread_mutex_lock(&pool->lock);
+    av_assert0(!c->head);
+    for (p = &pool->clients; *p != c; p = &(*p)->next)
+        ;
+    *p = c->next;
+    if (pool->next_client == c)
+        pool->next_client = c->next;
+    pthread_mutex_unlock(&pool->lock);
+
+    av_freep(pc);
+}
+
+void avpriv_threadpool_submit(AVThreadPoolClient *c, AVThreadPoolJob *job)
+{
+    AVThreadPool *pool = c->pool;
+
+    av_assert0(job->nb_lanes > 0);
+
+    pthread_mutex_lock(&pool->lock);
+    job->next_lane   = 0;
+    job->nb_finished = 0;
+    job->next        = NULL;
+    if (c->tail)
+        c->tail->next = job;
+    else
+        c->head = job;
+    c->tail = job;
+    pool->nb_queued += job->nb_lanes;
+
+    if (job->nb_lanes > 1)
+        pthread_cond_broadcast(&pool->work_cond);
+    else
+        pthread_cond_signal(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+int avpriv_threadpool_run_lane(AVThreadPoolClient *c, AVThreadPoolJob *job)
+{
+    AVThreadPool *pool = c->pool;
+    int lane;
+
+    pthread_mutex_lock(&pool->lock);
+    if (job->next_lane >= job->nb_lanes) {
+        pthread_mutex_unlock(&pool->lock);
+        return 0;
+    }
+    lane = claim_lane(c, job);
+    pthread_mutex_unlock(&pool->lock);
+
+    job->func(job->priv, lane);
+
+    pthread_mutex_lock(&pool->lock);
+    finish_lane(pool, job);
+    pthread_mutex_unlock(&pool->lock);
+
+    return 1;
+}
+
+void avpriv_threadpool_wait(AVThreadPoolClient *c, AVThreadPoolJob *job)
+{
+    AVThreadPool *pool = c->pool;
+
+    pthread_mutex_lock(&pool->lock);
+    while (job->nb_finished < job->nb_lanes)
+        pthread_cond_wait(&pool->done_cond, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+#else /* HAVE_PTHREADS || HAVE_W32THREADS || HAVE_OS2THREADS */
+
+AVThreadPool *av_threadpool_alloc(int nb_threads)
+{
+    return NULL;
+}
+
+void av_threadpool_free(AVThreadPool **pool)
+{
+    av_assert0(!pool || !*pool);
+}
+
+int avpriv_threadpool_nb_threads(AVThreadPool *pool)
+{
+    return 0;
+}
+
+AVThreadPoolClient *avpriv_threadpool_client_alloc(AVThreadPool *pool)
+{
+    return NULL;
+}
+
+void avpriv_threadpool_client_free(AVThreadPoolClient **client)
+{
+    av_assert0(!client || !*client);
+}
+
+void avpriv_threadpool_submit(AVThreadPoolClient *client, AVThreadPoolJob *job)
+{
+    av_assert0(0);
+}
+
+int avpriv_threadpool_run_lane(AVThreadPoolClient *client, AVThreadPoolJob *job)
+{
+    av_assert0(0);
+    return 0;
+}
+
+void avpriv_threadpool_wait(AVThreadPoolClient *client, AVThreadPoolJob *job)
+{
+    av_assert0(0);
+}
+
+#endif /* HAVE_PTHREADS || HAVE_W32THREADS || HAVE_OS2THREADS */
@@ -0,0 +1,71 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVUTIL_THREADPOOL_H
+#define AVUTIL_THREADPOOL_H
+
+/**
+ * @file
+ * @ingroup lavu_threadpool
+ * Public thread pool API.
+ */
+
+/**
+ * @defgroup lavu_threadpool Thread pool
+ * @ingroup lavu_misc
+ *
+ * A set of worker threads which can be shared by several codec contexts
+ * and filter graphs.
+ *
+ * Without a pool, every threaded context creates threads of its own, so an
+ * application running several decoders, encoders and filter graphs at once
+ * ends up with many more threads than CPUs. When the contexts are instead
+ * attached to a common pool (see AVCodecContext.thread_pool and
+ * AVFilterGraph.thread_pool), their work is queued to the pool and the
+ * worker threads serve the attached contexts in turn, so that a busy context
+ * cannot starve the others. The thread calling into a context still takes
+ * part in the work submitted by that context.
+ *
+ * @{
+ */
+
+typedef struct AVThreadPool AVThreadPool;
+
+/**
+ * Allocate a thread pool and start its worker threads.
+ *
+ * @param nb_threads number of worker threads, 0 to use the number of CPUs
+ * @return the pool, or NULL on failure, in particular if lavu was built
+ *         without thread support
+ */
+AVThreadPool *av_threadpool_alloc(int nb_threads);
+
+/**
+ * Stop the worker threads and free the pool.
+ *
+ * All contexts using the pool must have been freed before.
+ *
+ * @param pool pointer to the pool, set to NULL on return
+ */
+void av_threadpool_free(AVThreadPool **pool);
+
+/**
+ * @}
+ */
+
+#endif /* AVUTIL_THREADPOOL_H */
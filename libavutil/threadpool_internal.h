@@ -0,0 +1,82 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVUTIL_THREADPOOL_INTERNAL_H
+#define AVUTIL_THREADPOOL_INTERNAL_H
+
+#include "threadpool.h"
+
+/**
+ * A queue of jobs on a thread pool. Each context using the pool has its
+ * own client; the pool workers take work from the clients in turn, and
+ * the jobs of one client in the order they were submitted.
+ */
+typedef struct AVThreadPoolClient AVThreadPoolClient;
+
+/**
+ * A job made of nb_lanes calls of func, which may run concurrently.
+ * Only func, priv and nb_lanes are to be set by the caller, and they must
+ * not be changed while the job is in flight. A job must not wait for
+ * anything done by a job submitted after it to the same client.
+ */
+typedef struct AVThreadPoolJob {
+    void (*func)(void *priv, int lane);
+    void *priv;
+    int nb_lanes;
+
+    int next_lane;
+    int nb_finished;
+    struct AVThreadPoolJob *next;
+} AVThreadPoolJob;
+
+/**
+ * @return the number of worker threads of the pool
+ */
+int avpriv_threadpool_nb_threads(AVThreadPool *pool);
+
+/**
+ * Create a client queue on the pool.
+ * @return the client or NULL on failure
+ */
+AVThreadPoolClient *avpriv_threadpool_client_alloc(AVThreadPool *pool);
+
+/**
+ * Free a client. All jobs submitted to it must have been waited for.
+ */
+void avpriv_threadpool_client_free(AVThreadPoolClient **client);
+
+/**
+ * Queue a job. A job which has been submitted before must have been
+ * waited for before it can be submitted again.
+ */
+void avpriv_threadpool_submit(AVThreadPoolClient *client, AVThreadPoolJob *job);
+
+/**
+ * Run one lane of the job on the calling thread if some lane has not been
+ * started yet.
+ * @return 1 if a lane was run, 0 otherwise
+ */
+int avpriv_threadpool_run_lane(AVThreadPoolClient *client, AVThreadPoolJob *job);
+
+/**
+ * Wait until all lanes of the job have finished. Returns immediately for a
+ * zeroed job which was never submitted.
+ */
+void avpriv_threadpool_wait(AVThreadPoolClient *client, AVThreadPoolJob *job);
+
+#endif /* AVUTIL_THREADPOOL_INTERNAL_H */
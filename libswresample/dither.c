@@ -32,44 +32,38 @@ int swri_get_dither(SwrContext *s, void *dst, int len, unsigned seed, enum AVSam
     if (!tmp)
         return AVERROR(ENOMEM);
 
-    for(i=0; i<len + TMP_EXTRA; i++){
-        double v;
-        seed = seed* 1664525 + 1013904223;
-
-        switch(s->dither.method){
-            case SWR_DITHER_RECTANGULAR: v= ((double)seed) / UINT_MAX - 0.5; break;
-            default:
-                av_assert0(s->dither.method < SWR_DITHER_NB);
-                v = ((double)seed) / UINT_MAX;
-                seed = seed*1664525 + 1013904223;
-                v-= ((double)seed) / UINT_MAX;
-                break;
-        }
-        tmp[i] = v;
-    }
+    av_assert0(s->dither.method < SWR_DITHER_NB);
 
-    for(i=0; i<len; i++){
-        double v;
-
-        switch(s->dither.method){
-            default:
-                av_assert0(s->dither.method < SWR_DITHER_NB);
-                v = tmp[i];
-                break;
-            case SWR_DITHER_TRIANGULAR_HIGHPASS :
-                v = (- tmp[i] + 2*tmp[i+1] - tmp[i+2]) / sqrt(6);
-                break;
+    if (s->dither.method == SWR_DITHER_RECTANGULAR) {
+        for(i=0; i<len + TMP_EXTRA; i++){
+            seed = seed* 1664525 + 1013904223;
+            tmp[i] = ((double)seed) / UINT_MAX - 0.5;
+        }
+    } else {
+        /* both draws derive from the same seed, the second one through the
+         * two step LCG, so they no longer depend on each other */
+        for(i=0; i<len + TMP_EXTRA; i++){
+            unsigned seed2 = seed * 389569705U + 1196435762U;
+            double v = ((double)(seed * 1664525 + 1013904223)) / UINT_MAX;
+            seed = seed2;
+            tmp[i] = v - ((double)seed) / UINT_MAX;
         }
+    }
 
-        v*= scale;
+    if (s->dither.method == SWR_DITHER_TRIANGULAR_HIGHPASS) {
+        for(i=0; i<len; i++)
+            tmp[i] = (- tmp[i] + 2*tmp[i+1] - tmp[i+2]) / sqrt(6) * scale;
+    } else {
+        for(i=0; i<len; i++)
+            tmp[i] *= scale;
+    }
 
-        switch(noise_fmt){
-            case AV_SAMPLE_FMT_S16P: ((int16_t*)dst)[i] = v; break;
-            case AV_SAMPLE_FMT_S32P: ((int32_t*)dst)[i] = v; break;
-            case AV_SAMPLE_FMT_FLTP: ((float  *)dst)[i] = v; break;
-            case AV_SAMPLE_FMT_DBLP: ((double *)dst)[i] = v; break;
-            default: av_assert0(0);
-        }
+    switch(noise_fmt){
+        case AV_SAMPLE_FMT_S16P: for(i=0; i<len; i++) ((int16_t*)dst)[i] = tmp[i]; break;
+        case AV_SAMPLE_FMT_S32P: for(i=0; i<len; i++) ((int32_t*)dst)[i] = tmp[i]; break;
+        case AV_SAMPLE_FMT_FLTP: for(i=0; i<len; i++) ((float  *)dst)[i] = tmp[i]; break;
+        case AV_SAMPLE_FMT_DBLP: for(i=0; i<len; i++) ((double *)dst)[i] = tmp[i]; break;
+        default: av_assert0(0);
     }
 
     av_free(tmp);
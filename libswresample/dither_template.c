@@ -40,33 +40,71 @@
 ERROR
 #endif
 
+static av_always_inline double RENAME(ns_filter)(const float *ns_coeffs, const float *ns_errors,
+                                                 int taps, double d)
+{
+    int j;
+
+    for(j=0; j<taps-2; j+=4) {
+        d -= ns_coeffs[j    ] * ns_errors[j    ]
+            +ns_coeffs[j + 1] * ns_errors[j + 1]
+            +ns_coeffs[j + 2] * ns_errors[j + 2]
+            +ns_coeffs[j + 3] * ns_errors[j + 3];
+    }
+    if(j < taps)
+        d -= ns_coeffs[j] * ns_errors[j];
+    return d;
+}
+
 void RENAME(swri_noise_shaping)(SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count){
     int pos = s->dither.ns_pos;
-    int i, j, ch;
+    int i, ch;
     int taps  = s->dither.ns_taps;
     float S   = s->dither.ns_scale;
     float S_1 = s->dither.ns_scale_1;
+    const float *ns_coeffs = s->dither.ns_coeffs;
 
     av_assert2((taps&3) != 2);
     av_assert2((taps&3) != 3 || s->dither.ns_coeffs[taps] == 0);
 
-    for (ch=0; ch<srcs->ch_count; ch++) {
+    /* The error feedback makes every channel one long dependency chain,
+     * so filter two channels per pass to keep two chains in flight. */
+    for (ch=0; ch+1<srcs->ch_count; ch+=2) {
+        const float *noise0 = ((const float *)noises->ch[ch    ]) + s->dither.noise_pos;
+        const float *noise1 = ((const float *)noises->ch[ch + 1]) + s->dither.noise_pos;
+        const DELEM *src0 = (const DELEM*)srcs->ch[ch    ];
+        const DELEM *src1 = (const DELEM*)srcs->ch[ch + 1];
+        DELEM *dst0 = (DELEM*)dsts->ch[ch    ];
+        DELEM *dst1 = (DELEM*)dsts->ch[ch + 1];
+        float *ns_errors0 = s->dither.ns_errors[ch    ];
+        float *ns_errors1 = s->dither.ns_errors[ch + 1];
+        pos  = s->dither.ns_pos;
+        for (i=0; i<count; i++) {
+            double d0 = RENAME(ns_filter)(ns_coeffs, ns_errors0 + pos, taps, src0[i]*S_1);
+            double d1 = RENAME(ns_filter)(ns_coeffs, ns_errors1 + pos, taps, src1[i]*S_1);
+            double r0, r1;
+            pos = pos ? pos - 1 : taps - 1;
+            r0 = rint(d0 + noise0[i]);
+            r1 = rint(d1 + noise1[i]);
+            ns_errors0[pos + taps] = ns_errors0[pos] = r0 - d0;
+            ns_errors1[pos + taps] = ns_errors1[pos] = r1 - d1;
+            r0 *= S;
+            r1 *= S;
+            CLIP(r0);
+            CLIP(r1);
+            dst0[i] = r0;
+            dst1[i] = r1;
+        }
+    }
+
+    for (; ch<srcs->ch_count; ch++) {
         const float *noise = ((const float *)noises->ch[ch]) + s->dither.noise_pos;
         const DELEM *src = (const DELEM*)srcs->ch[ch];
         DELEM *dst = (DELEM*)dsts->ch[ch];
         float *ns_errors = s->dither.ns_errors[ch];
-        const float *ns_coeffs = s->dither.ns_coeffs;
         pos  = s->dither.ns_pos;
         for (i=0; i<count; i++) {
-            double d1, d = src[i]*S_1;
-            for(j=0; j<taps-2; j+=4) {
-                d -= ns_coeffs[j    ] * ns_errors[pos + j    ]
-                    +ns_coeffs[j + 1] * ns_errors[pos + j + 1]
-                    +ns_coeffs[j + 2] * ns_errors[pos + j + 2]
-                    +ns_coeffs[j + 3] * ns_errors[pos + j + 3];
-            }
-            if(j < taps)
-                d -= ns_coeffs[j] * ns_errors[pos + j];
+            double d1, d = RENAME(ns_filter)(ns_coeffs, ns_errors + pos, taps, src[i]*S_1);
             pos = pos ? pos - 1 : taps - 1;
             d1 = rint(d + noise[i]);
             ns_errors[pos + taps] = ns_errors[pos] = d1 - d;
@@ -459,6 +459,7 @@ av_cold int swri_rematrix_init(SwrContext *s){
         s->mix_any_f = (mix_any_func_type*)get_mix_any_func_s32(s);
     }else
         av_assert0(0);
+    s->mix_simd_len_mask = 15;
     //FIXME quantize for integeres
     for (i = 0; i < SWR_CH_MAX; i++) {
         int ch_in=0;
@@ -494,7 +495,7 @@ int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mus
     }
 
     if(s->mix_2_1_simd || s->mix_1_1_simd){
-        len1= len&~15;
+        len1= len&~s->mix_simd_len_mask;
         off = len1 * out->bps;
     }
 
@@ -532,7 +533,21 @@ int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mus
             break;}
         default:
             if(s->int_sample_fmt == AV_SAMPLE_FMT_FLTP){
-                for(i=0; i<len; i++){
+                i = 0;
+                if(s->mix_2_1_simd && len1){
+                    /* accumulate the remaining inputs into the output using
+                     * the unit coefficient stored after the matrix */
+                    int one = in->ch_count * out->ch_count;
+                    s->mix_2_1_simd(out->ch[out_i], in->ch[s->matrix_ch[out_i][1]], in->ch[s->matrix_ch[out_i][2]], s->native_simd_matrix,
+                                    in->ch_count*out_i + s->matrix_ch[out_i][1], in->ch_count*out_i + s->matrix_ch[out_i][2], len1);
+                    for(j=2; j<s->matrix_ch[out_i][0]; j++){
+                        in_i= s->matrix_ch[out_i][1+j];
+                        s->mix_2_1_simd(out->ch[out_i], out->ch[out_i], in->ch[in_i], s->native_simd_matrix,
+                                        one, in->ch_count*out_i + in_i, len1);
+                    }
+                    i = len1;
+                }
+                for(; i<len; i++){
                     float v=0;
                     for(j=0; j<s->matrix_ch[out_i][0]; j++){
                         in_i= s->matrix_ch[out_i][1+j];
@@ -280,13 +280,34 @@ static void resample_free(ResampleContext **cc){
     ResampleContext *c = *cc;
     if(!c)
         return;
+    avpriv_slicethread_free(&c->slicethread);
     av_freep(&c->filter_bank);
     av_freep(cc);
 }
 
+static void resample_worker(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
+{
+    ResampleContext *c = priv;
+    int ch_count = c->job.dst->ch_count;
+    int i;
+
+    for (i = jobnr; i < ch_count; i += nb_jobs) {
+        /* only the last channel updates the context, and it does so on a
+         * private copy so the other channels still see the initial state */
+        if (i + 1 == ch_count)
+            c->job.consumed = c->job.resample_func(c->job.last, c->job.dst->ch[i], c->job.src->ch[i], c->job.n, 1);
+        else
+            c->job.resample_func(c, c->job.dst->ch[i], c->job.src->ch[i], c->job.n, 0);
+    }
+
+    if (c->job.need_emms)
+        emms_c();
+}
+
 static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_rate, int filter_size, int phase_shift, int linear,
                                     double cutoff0, enum AVSampleFormat format, enum SwrFilterType filter_type, double kaiser_beta,
-                                    double precision, int cheby, int exact_rational)
+                                    double precision, int cheby, int exact_rational, int nb_threads,
+                                    AVThreadPool *pool)
 {
     double cutoff = cutoff0? cutoff0 : 0.97;
     double factor= FFMIN(out_rate * cutoff / in_rate, 1.0);
@@ -344,7 +365,7 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
         c->linear        = linear;
         c->factor        = factor;
         c->filter_length = filter_length;
-        c->filter_alloc  = FFALIGN(c->filter_length, 8);
+        c->filter_alloc  = FFALIGN(c->filter_length, 16);
         c->filter_bank   = av_calloc(c->filter_alloc, (phase_count+1)*c->felem_size);
         c->filter_type   = filter_type;
         c->kaiser_beta   = kaiser_beta;
@@ -373,8 +394,26 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
 
     swri_resample_dsp_init(c);
 
+    if (!c->slicethread || c->nb_threads != nb_threads || c->thread_pool != pool) {
+        int ret = 1;
+
+        avpriv_slicethread_free(&c->slicethread);
+        c->nb_threads  = nb_threads;
+        c->thread_pool = pool;
+        if (nb_threads != 1 && pool)
+            ret = avpriv_slicethread_create_pool(&c->slicethread, pool, c, resample_worker, nb_threads);
+        else if (nb_threads != 1)
+            ret = avpriv_slicethread_create(&c->slicethread, c, resample_worker, NULL, nb_threads);
+        if (ret <= 1) {
+            if (ret < 0)
+                av_log(NULL, AV_LOG_WARNING, "Multi-threaded resampling unavailable, using a single thread\n");
+            avpriv_slicethread_free(&c->slicethread);
+        }
+    }
+
     return c;
 error:
+    avpriv_slicethread_free(&c->slicethread);
     av_freep(&c->filter_bank);
     av_free(c);
     return NULL;
@@ -494,8 +533,23 @@ static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, A
              * when frac and dst_incr_mod are zero */
             resample_func = (c->linear && (c->frac || c->dst_incr_mod)) ?
                             c->dsp.resample_linear : c->dsp.resample_common;
-            for (i = 0; i < dst->ch_count; i++)
-                *consumed = resample_func(c, dst->ch[i], src->ch[i], dst_size, i+1 == dst->ch_count);
+            if (c->slicethread && dst->ch_count > 1) {
+                ResampleContext last = *c;
+
+                c->job.dst           = dst;
+                c->job.src           = src;
+                c->job.n             = dst_size;
+                c->job.need_emms     = need_emms;
+                c->job.last          = &last;
+                c->job.resample_func = resample_func;
+                avpriv_slicethread_execute(c->slicethread, dst->ch_count, 0);
+                c->index  = last.index;
+                c->frac   = last.frac;
+                *consumed = c->job.consumed;
+            } else {
+                for (i = 0; i < dst->ch_count; i++)
+                    *consumed = resample_func(c, dst->ch[i], src->ch[i], dst_size, i+1 == dst->ch_count);
+            }
         }
     }
 
@@ -24,6 +24,7 @@
 
 #include "libavutil/log.h"
 #include "libavutil/samplefmt.h"
+#include "libavutil/slicethread.h"
 
 #include "swresample_internal.h"
 
@@ -50,6 +51,20 @@ typedef struct ResampleContext {
     int filter_shift;
     int phase_count_compensation;      /* desired phase_count when compensation is enabled */
 
+    AVSliceThread *slicethread;        ///< per-channel worker threads, NULL if single threaded
+    int nb_threads;                    ///< number of threads requested by the user, 0 for auto
+    AVThreadPool *thread_pool;         ///< pool slicethread was created on, NULL for private threads
+    struct {
+        AudioData *dst;
+        AudioData *src;
+        int n;
+        int need_emms;
+        int consumed;
+        struct ResampleContext *last;  ///< private copy updated by the last channel
+        int (*resample_func)(struct ResampleContext *c, void *dst,
+                             const void *src, int n, int update_ctx);
+    } job;                             ///< state shared with the worker threads for one multiple_resample() call
+
     struct {
         void (*resample_one)(void *dst, const void *src,
                              int n, int64_t index, int64_t incr);
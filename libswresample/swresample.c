@@ -56,6 +56,13 @@ int swr_set_channel_mapping(struct SwrContext *s, const int *channel_map){
     return 0;
 }
 
+int swr_set_thread_pool(struct SwrContext *s, AVThreadPool *pool){
+    if (!s)
+        return AVERROR(EINVAL);
+    s->thread_pool = pool;
+    return 0;
+}
+
 struct SwrContext *swr_alloc_set_opts(struct SwrContext *s,
                                       int64_t out_ch_layout, enum AVSampleFormat out_sample_fmt, int out_sample_rate,
                                       int64_t  in_ch_layout, enum AVSampleFormat  in_sample_fmt, int  in_sample_rate,
@@ -150,7 +157,7 @@ av_cold void swr_close(SwrContext *s){
 }
 
 av_cold int swr_init(struct SwrContext *s){
-    int ret;
+    int ret, i;
     char l1[1024], l2[1024];
 
     clear_context(s);
@@ -264,7 +271,7 @@ av_cold int swr_init(struct SwrContext *s){
     }
 
     if (s->out_sample_rate!=s->in_sample_rate || (s->flags & SWR_FLAG_RESAMPLE)){
-        s->resample = s->resampler->init(s->resample, s->out_sample_rate, s->in_sample_rate, s->filter_size, s->phase_shift, s->linear_interp, s->cutoff, s->int_sample_fmt, s->filter_type, s->kaiser_beta, s->precision, s->cheby, s->exact_rational);
+        s->resample = s->resampler->init(s->resample, s->out_sample_rate, s->in_sample_rate, s->filter_size, s->phase_shift, s->linear_interp, s->cutoff, s->int_sample_fmt, s->filter_type, s->kaiser_beta, s->precision, s->cheby, s->exact_rational, s->nb_threads, s->thread_pool);
         if (!s->resample) {
             av_log(s, AV_LOG_ERROR, "Failed to initialize resampler\n");
             return AVERROR(ENOMEM);
@@ -335,6 +342,11 @@ av_assert0(s->out.ch_count);
 
     s->in_convert = swri_audio_convert_alloc(s->int_sample_fmt,
                                              s-> in_sample_fmt, s->used_ch_count, s->channel_map, 0);
+
+    s->channel_map_alias = !!s->channel_map;
+    for (i = 0; s->channel_map && i < s->used_ch_count; i++)
+        if (s->channel_map[i] < 0)
+            s->channel_map_alias = 0;
     s->out_convert= swri_audio_convert_alloc(s->out_sample_fmt,
                                              s->int_sample_fmt, s->out.ch_count, NULL, 0);
 
@@ -575,7 +587,7 @@ static int swr_convert_internal(struct SwrContext *s, AudioData *out, int out_co
                                                       AudioData *in , int  in_count){
     AudioData *postin, *midbuf, *preout;
     int ret/*, in_max*/;
-    AudioData preout_tmp, midbuf_tmp;
+    AudioData postin_tmp, preout_tmp, midbuf_tmp;
 
     if(s->full_convert){
         av_assert0(!s->resample);
@@ -586,29 +598,25 @@ static int swr_convert_internal(struct SwrContext *s, AudioData *out, int out_co
 //     in_max= out_count*(int64_t)s->in_sample_rate / s->out_sample_rate + resample_filter_taps;
 //     in_count= FFMIN(in_count, in_in + 2 - s->hist_buffer_count);
 
-    if((ret=swri_realloc_audio(&s->postin, in_count))<0)
-        return ret;
-    if(s->resample_first){
-        av_assert0(s->midbuf.ch_count == s->used_ch_count);
-        if((ret=swri_realloc_audio(&s->midbuf, out_count))<0)
-            return ret;
-    }else{
-        av_assert0(s->midbuf.ch_count ==  s->out.ch_count);
-        if((ret=swri_realloc_audio(&s->midbuf,  in_count))<0)
-            return ret;
-    }
-    if((ret=swri_realloc_audio(&s->preout, out_count))<0)
-        return ret;
+    av_assert0(s->midbuf.ch_count == (s->resample_first ? s->used_ch_count : s->out.ch_count));
 
+    /* Plan the stages first, the intermediate buffers are only allocated
+     * below for the stages which actually need their own storage. */
     postin= &s->postin;
+    midbuf= &s->midbuf;
+    preout= &s->preout;
 
-    midbuf_tmp= s->midbuf;
-    midbuf= &midbuf_tmp;
-    preout_tmp= s->preout;
-    preout= &preout_tmp;
-
-    if(s->int_sample_fmt == s-> in_sample_fmt && s->in.planar && !s->channel_map)
-        postin= in;
+    if(s->int_sample_fmt == s-> in_sample_fmt && s->in.planar){
+        if(!s->channel_map){
+            postin= in;
+        }else if(s->channel_map_alias){
+            int ch;
+            postin_tmp= s->postin;
+            for(ch=0; ch<s->used_ch_count; ch++)
+                postin_tmp.ch[ch]= in->ch[s->channel_map[ch]];
+            postin= &postin_tmp;
+        }
+    }
 
     if(s->resample_first ? !s->resample : !s->rematrix)
         midbuf= postin;
@@ -629,7 +637,24 @@ static int swr_convert_internal(struct SwrContext *s, AudioData *out, int out_co
         else                    preout= out;
     }
 
-    if(in != postin){
+    if(postin == &s->postin && (ret=swri_realloc_audio(&s->postin, in_count))<0)
+        return ret;
+    if(midbuf == &s->midbuf){
+        if((ret=swri_realloc_audio(&s->midbuf, s->resample_first ? out_count : in_count))<0)
+            return ret;
+        midbuf_tmp= s->midbuf;
+        if(preout == midbuf)
+            preout= &midbuf_tmp;
+        midbuf= &midbuf_tmp;
+    }
+    if(preout == &s->preout){
+        if((ret=swri_realloc_audio(&s->preout, out_count))<0)
+            return ret;
+        preout_tmp= s->preout;
+        preout= &preout_tmp;
+    }
+
+    if(in != postin && postin != &postin_tmp){
         swri_audio_convert(s->in_convert, postin, in, in_count);
     }
 
@@ -651,7 +676,7 @@ static int swr_convert_internal(struct SwrContext *s, AudioData *out, int out_co
             int ch;
             int dither_count= FFMAX(out_count, 1<<16);
 
-            if (preout == in) {
+            if (preout == in || preout == &postin_tmp) {
                 conv_src = &s->dither.temp;
                 if((ret=swri_realloc_audio(&s->dither.temp, dither_count))<0)
                     return ret;
@@ -670,7 +695,7 @@ static int swr_convert_internal(struct SwrContext *s, AudioData *out, int out_co
 
             if (s->dither.method < SWR_DITHER_NS){
                 if (s->mix_2_1_simd) {
-                    int len1= out_count&~15;
+                    int len1= out_count&~s->mix_simd_len_mask;
                     int off = len1 * preout->bps;
 
                     if(len1)
@@ -123,6 +123,7 @@
 #include "libavutil/channel_layout.h"
 #include "libavutil/frame.h"
 #include "libavutil/samplefmt.h"
+#include "libavutil/threadpool.h"
 
 #include "libswresample/version.h"
 
@@ -403,6 +404,18 @@ int swr_build_matrix(uint64_t in_layout, uint64_t out_layout,
  */
 int swr_set_matrix(struct SwrContext *s, const double *matrix, int stride);
 
+/**
+ * Set the thread pool the resampling threads are taken from.
+ *
+ * The pool is used from the next swr_init() on. Without a pool the context
+ * creates its own threads when the resample_threads option is not 1.
+ *
+ * @param s     allocated Swr context
+ * @param pool  thread pool, which must outlive s, or NULL
+ * @return  >= 0 on success, or AVERROR error code in case of failure.
+ */
+int swr_set_thread_pool(struct SwrContext *s, AVThreadPool *pool);
+
 /**
  * @}
  *
@@ -527,6 +540,12 @@ const char *swresample_license(void);
  * field will be set using av_frame_get_buffer()
  * is called to allocate the frame.
  *
+ * If the output AVFrame does not have the data pointers allocated, no samples
+ * are buffered and the conversion does not change the samples (same sample
+ * format, rate and channel layout, no rematrixing, channel mapping or
+ * dithering), the output AVFrame will reference the data of a reference
+ * counted input AVFrame instead of receiving a copy.
+ *
  * The output AVFrame can be NULL or have fewer allocated samples than required.
  * In this case, any remaining samples not written to the output will be added
  * to an internal FIFO buffer, to be returned at the next call to this function
@@ -107,6 +107,78 @@ static inline int convert_frame(SwrContext *s,
     return 0;
 }
 
+/**
+ * Check whether the conversion leaves the samples untouched, in which case
+ * the output can reference the input buffers instead of receiving a copy.
+ */
+static int is_passthrough(SwrContext *s, const AVFrame *out, const AVFrame *in)
+{
+    return s->full_convert && in && in->buf[0] &&
+           s->in_sample_fmt == s->out_sample_fmt &&
+           s->in.ch_count   == s->out.ch_count   &&
+           !s->in_buffer_count && !s->drop_output &&
+           !out->linesize[0] && !out->buf[0];
+}
+
+static int alias_frame(SwrContext *s, AVFrame *out, const AVFrame *in)
+{
+    int i, ret;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(in->buf) && in->buf[i]; i++) {
+        out->buf[i] = av_buffer_ref(in->buf[i]);
+        if (!out->buf[i]) {
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+    }
+
+    if (in->extended_buf) {
+        out->extended_buf = av_mallocz_array(in->nb_extended_buf,
+                                             sizeof(*out->extended_buf));
+        if (!out->extended_buf) {
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+        out->nb_extended_buf = in->nb_extended_buf;
+
+        for (i = 0; i < in->nb_extended_buf; i++) {
+            out->extended_buf[i] = av_buffer_ref(in->extended_buf[i]);
+            if (!out->extended_buf[i]) {
+                ret = AVERROR(ENOMEM);
+                goto fail;
+            }
+        }
+    }
+
+    if (in->extended_data != in->data) {
+        int ch = s->in.ch_count;
+
+        out->extended_data = av_malloc_array(ch, sizeof(*out->extended_data));
+        if (!out->extended_data) {
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+        memcpy(out->extended_data, in->extended_data, sizeof(*in->extended_data) * ch);
+    } else
+        out->extended_data = out->data;
+
+    memcpy(out->data,     in->data,     sizeof(in->data));
+    memcpy(out->linesize, in->linesize, sizeof(in->linesize));
+    out->nb_samples = in->nb_samples;
+
+    s->outpts += in->nb_samples * (int64_t)s->in_sample_rate;
+
+    return 0;
+fail:
+    for (i = 0; i < FF_ARRAY_ELEMS(out->buf); i++)
+        av_buffer_unref(&out->buf[i]);
+    for (i = 0; i < out->nb_extended_buf; i++)
+        av_buffer_unref(&out->extended_buf[i]);
+    av_freep(&out->extended_buf);
+    out->nb_extended_buf = 0;
+    return ret;
+}
+
 static inline int available_samples(AVFrame *out)
 {
     int bytes_per_sample = av_get_bytes_per_sample(out->format);
@@ -138,6 +210,9 @@ int swr_convert_frame(SwrContext *s,
     }
 
     if (out) {
+        if (is_passthrough(s, out, in))
+            return alias_frame(s, out, in);
+
         if (!out->linesize[0]) {
             out->nb_samples = swr_get_delay(s, s->out_sample_rate) + 3;
             if (in) {
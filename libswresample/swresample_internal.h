@@ -69,7 +69,7 @@ struct DitherContext {
 };
 
 typedef struct ResampleContext * (* resample_init_func)(struct ResampleContext *c, int out_rate, int in_rate, int filter_size, int phase_shift, int linear,
-                                    double cutoff, enum AVSampleFormat format, enum SwrFilterType filter_type, double kaiser_beta, double precision, int cheby, int exact_rational);
+                                    double cutoff, enum AVSampleFormat format, enum SwrFilterType filter_type, double kaiser_beta, double precision, int cheby, int exact_rational, int nb_threads, AVThreadPool *pool);
 typedef void    (* resample_free_func)(struct ResampleContext **c);
 typedef int     (* multiple_resample_func)(struct ResampleContext *c, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed);
 typedef int     (* resample_flush_func)(struct SwrContext *c);
@@ -112,6 +112,7 @@ struct SwrContext {
     int matrix_encoding;                            /**< matrixed stereo encoding */
     const int *channel_map;                         ///< channel index (or -1 if muted channel) map
     int used_ch_count;                              ///< number of used input channels (mapped channel count if channel_map, otherwise in.ch_count)
+    int channel_map_alias;                          ///< 1 if the mapped input channels can be referenced in place instead of being copied
     int engine;
 
     int user_in_ch_count;                           ///< User set input channel count
@@ -133,6 +134,8 @@ struct SwrContext {
     double kaiser_beta;                                /**< swr beta value for Kaiser window (only applicable if filter_type == AV_FILTER_TYPE_KAISER) */
     double precision;                               /**< soxr resampling precision (in bits) */
     int cheby;                                      /**< soxr: if 1 then passband rolloff will be none (Chebyshev) & irrational ratio approximation precision will be higher */
+    int nb_threads;                                 /**< number of threads used to resample channels in parallel, 0 for auto */
+    AVThreadPool *thread_pool;                      /**< pool the resampling threads are taken from, NULL for private threads */
 
     float min_compensation;                         ///< swr minimum below which no compensation will happen
     float min_hard_compensation;                    ///< swr minimum below which no silence inject / sample drop will happen
@@ -181,6 +184,7 @@ struct SwrContext {
 
     mix_2_1_func_type *mix_2_1_f;
     mix_2_1_func_type *mix_2_1_simd;
+    int mix_simd_len_mask;                          ///< the mix_*_simd functions require the length to be a multiple of this mask + 1
 
     mix_any_func_type *mix_any_f;
 
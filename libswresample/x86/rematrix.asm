@@ -113,12 +113,12 @@ cglobal mix_1_1_%1_int16, 5, 5, 6, out, in, coeffp, index, len
 %else
 mix_1_1_int16_u_int %+ SUFFIX:
 %endif
-    movd   m4, [coeffpq + 4*indexq]
-    SPLATW m5, m4
-    psllq  m4, 32
-    psrlq  m4, 48
+    movd  xm4, [coeffpq + 4*indexq]
+    SPLATW m5, xm4
+    psllq xm4, 32
+    psrlq xm4, 48
     mova   m0, [w1]
-    psllw  m0, m4
+    psllw  m0, xm4
     psrlw  m0, 1
     punpcklwd m5, m0
     add lenq    , lenq
@@ -138,10 +138,10 @@ mix_1_1_int16_u_int %+ SUFFIX:
     pmaddwd      m1, m5
     pmaddwd      m2, m5
     pmaddwd      m3, m5
-    psrad        m0, m4
-    psrad        m1, m4
-    psrad        m2, m4
-    psrad        m3, m4
+    psrad        m0, xm4
+    psrad        m1, xm4
+    psrad        m2, xm4
+    psrad        m3, xm4
     packssdw     m0, m1
     packssdw     m2, m3
     mov%1  [outq + lenq         ], m0
@@ -168,14 +168,14 @@ cglobal mix_2_1_%1_int16, 7, 7, 8, out, in1, in2, coeffp, index1, index2, len
 %else
 mix_2_1_int16_u_int %+ SUFFIX:
 %endif
-    movd   m4, [coeffpq + 4*index1q]
-    movd   m6, [coeffpq + 4*index2q]
-    SPLATW m5, m4
-    SPLATW m6, m6
-    psllq  m4, 32
-    psrlq  m4, 48
+    movd  xm4, [coeffpq + 4*index1q]
+    movd  xm6, [coeffpq + 4*index2q]
+    SPLATW m5, xm4
+    SPLATW m6, xm6
+    psllq xm4, 32
+    psrlq xm4, 48
     mova   m7, [dw1]
-    pslld  m7, m4
+    pslld  m7, xm4
     psrld  m7, 1
     punpcklwd m5, m6
     add lend    , lend
@@ -204,10 +204,10 @@ mix_2_1_int16_u_int %+ SUFFIX:
     paddd        m1, m7
     paddd        m2, m7
     paddd        m3, m7
-    psrad        m0, m4
-    psrad        m1, m4
-    psrad        m2, m4
-    psrad        m3, m4
+    psrad        m0, xm4
+    psrad        m1, xm4
+    psrad        m2, xm4
+    psrad        m3, xm4
     packssdw     m0, m1
     packssdw     m2, m3
     mov%1  [outq + lenq         ], m0
@@ -248,3 +248,11 @@ MIX2_FLT a
 MIX1_FLT u
 MIX1_FLT a
 %endif
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+MIX1_INT16 u
+MIX1_INT16 a
+MIX2_INT16 u
+MIX2_INT16 a
+%endif
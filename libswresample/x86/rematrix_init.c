@@ -29,6 +29,7 @@ D(float, sse)
 D(float, avx)
 D(int16, mmx)
 D(int16, sse2)
+D(int16, avx2)
 
 av_cold int swri_rematrix_init_x86(struct SwrContext *s){
 #if HAVE_X86ASM
@@ -50,6 +51,11 @@ av_cold int swri_rematrix_init_x86(struct SwrContext *s){
             s->mix_1_1_simd = ff_mix_1_1_a_int16_sse2;
             s->mix_2_1_simd = ff_mix_2_1_a_int16_sse2;
         }
+        if(EXTERNAL_AVX2_FAST(mm_flags)) {
+            s->mix_1_1_simd = ff_mix_1_1_a_int16_avx2;
+            s->mix_2_1_simd = ff_mix_2_1_a_int16_avx2;
+            s->mix_simd_len_mask = 31;
+        }
         s->native_simd_matrix = av_mallocz_array(num,  2 * sizeof(int16_t));
         s->native_simd_one    = av_mallocz(2 * sizeof(int16_t));
         if (!s->native_simd_matrix || !s->native_simd_one)
@@ -77,11 +83,14 @@ av_cold int swri_rematrix_init_x86(struct SwrContext *s){
             s->mix_1_1_simd = ff_mix_1_1_a_float_avx;
             s->mix_2_1_simd = ff_mix_2_1_a_float_avx;
         }
-        s->native_simd_matrix = av_mallocz_array(num, sizeof(float));
+        /* one extra unit coefficient is stored after the matrix, it is used
+         * to accumulate into the output for more than 2 inputs */
+        s->native_simd_matrix = av_mallocz_array(num + 1, sizeof(float));
         s->native_simd_one = av_mallocz(sizeof(float));
         if (!s->native_simd_matrix || !s->native_simd_one)
             return AVERROR(ENOMEM);
         memcpy(s->native_simd_matrix, s->native_matrix, num * sizeof(float));
+        ((float*)s->native_simd_matrix)[num] = 1.0;
         memcpy(s->native_simd_one, s->native_one, sizeof(float));
     }
 #endif
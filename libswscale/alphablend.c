@@ -20,6 +20,16 @@
 
 #include "swscale_internal.h"
 
+static void alpha_blend_8_c(uint8_t *dst, const uint8_t *src, const uint8_t *alpha,
+                            int width, int target)
+{
+    int x;
+    for (x = 0; x < width; x++) {
+        unsigned u = src[x]*alpha[x] + target*(255-alpha[x]) + 128;
+        dst[x] = (257*u) >> 16;
+    }
+}
+
 int ff_sws_alphablendaway(SwsContext *c, const uint8_t *src[],
                           int srcStride[], int srcSliceY, int srcSliceH,
                           uint8_t *dst[], int dstStride[])
@@ -116,7 +126,13 @@ int ff_sws_alphablendaway(SwsContext *c, const uint8_t *src[],
                     const uint8_t *s = src[plane      ] + srcStride[plane] * y;
                     const uint8_t *a = src[plane_count] + srcStride[plane_count] * y;
                           uint8_t *d = dst[plane      ] + dstStride[plane] * y;
-                    for (x = 0; x < w; x++) {
+                    int simd_w = w & ~15;
+                    // the target only alternates every 32 pixels for the checkerboard
+                    int run = target_table[0][plane] == target_table[1][plane] ? simd_w : 32;
+                    for (x = 0; x < simd_w; x += run)
+                        c->alpha_blend_8(d + x, s + x, a + x, FFMIN(run, simd_w - x),
+                                         target_table[((x^y)>>5)&1][plane]);
+                    for (x = simd_w; x < w; x++) {
                         unsigned u = s[x]*a[x] + target_table[((x^y)>>5)&1][plane]*(255-a[x]) + 128;
                         d[x] = (257*u) >> 16;
                     }
@@ -167,3 +183,11 @@ int ff_sws_alphablendaway(SwsContext *c, const uint8_t *src[],
 
     return 0;
 }
+
+av_cold void ff_sws_init_alphablend(SwsContext *c)
+{
+    c->alpha_blend_8 = alpha_blend_8_c;
+
+    if (ARCH_X86)
+        ff_sws_init_alphablend_x86(c);
+}
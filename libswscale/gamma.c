@@ -25,6 +25,20 @@ typedef struct GammaContext
     uint16_t *table;
 } GammaContext;
 
+static void gamma_convert_c(uint16_t *line, int width, const uint16_t *table)
+{
+    int j;
+    for (j = 0; j < width; ++j) {
+        uint16_t r = AV_RL16(line + j*4 + 0);
+        uint16_t g = AV_RL16(line + j*4 + 1);
+        uint16_t b = AV_RL16(line + j*4 + 2);
+
+        AV_WL16(line + j*4 + 0, table[r]);
+        AV_WL16(line + j*4 + 1, table[g]);
+        AV_WL16(line + j*4 + 2, table[b]);
+    }
+}
+
 // gamma_convert expects 16 bit rgb format
 // it writes directly in src slice thus it must be modifiable (done through cascade context)
 static int gamma_convert(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int sliceH)
@@ -32,6 +46,7 @@ static int gamma_convert(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, i
     GammaContext *instance = desc->instance;
     uint16_t *table = instance->table;
     int srcW = desc->src->width;
+    int simdW = srcW & ~7;
 
     int i;
     for (i = 0; i < sliceH; ++i) {
@@ -39,17 +54,8 @@ static int gamma_convert(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, i
         int src_pos = sliceY+i - desc->src->plane[0].sliceY;
 
         uint16_t *src1 = (uint16_t*)*(src+src_pos);
-        int j;
-        for (j = 0; j < srcW; ++j) {
-            uint16_t r = AV_RL16(src1 + j*4 + 0);
-            uint16_t g = AV_RL16(src1 + j*4 + 1);
-            uint16_t b = AV_RL16(src1 + j*4 + 2);
-
-            AV_WL16(src1 + j*4 + 0, table[r]);
-            AV_WL16(src1 + j*4 + 1, table[g]);
-            AV_WL16(src1 + j*4 + 2, table[b]);
-        }
-
+        c->gamma_convert(src1, simdW, table);
+        gamma_convert_c(src1 + simdW*4, srcW - simdW, table);
     }
     return sliceH;
 }
@@ -70,3 +76,10 @@ int ff_init_gamma_convert(SwsFilterDescriptor *desc, SwsSlice * src, uint16_t *t
     return 0;
 }
 
+av_cold void ff_sws_init_gamma(SwsContext *c)
+{
+    c->gamma_convert = gamma_convert_c;
+
+    if (ARCH_X86)
+        ff_sws_init_gamma_x86(c);
+}
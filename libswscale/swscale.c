@@ -583,6 +583,7 @@ static av_cold void sws_init_swscale(SwsContext *c)
     }
 
     ff_sws_init_range_convert(c);
+    ff_sws_init_gamma(c);
 
     if (!(isGray(srcFormat) || isGray(c->dstFormat) ||
           srcFormat == AV_PIX_FMT_MONOBLACK || srcFormat == AV_PIX_FMT_MONOWHITE))
@@ -618,6 +618,20 @@ typedef struct SwsContext {
     /// Color range conversion function for chroma planes if needed.
     void (*chrConvertRange)(int16_t *dst1, int16_t *dst2, int width);
 
+    /**
+     * Apply table to the R, G and B components of width native endian
+     * RGBA64 pixels in place, width must be a multiple of 8. table must
+     * have one padding entry after the last index.
+     */
+    void (*gamma_convert)(uint16_t *line, int width, const uint16_t *table);
+
+    /**
+     * Blend width 8-bit samples from src onto the constant target using
+     * the matching alpha samples, width must be a multiple of 16.
+     */
+    void (*alpha_blend_8)(uint8_t *dst, const uint8_t *src, const uint8_t *alpha,
+                          int width, int target);
+
     int needs_hcscale; ///< Set if there are chroma planes to be converted.
 
     SwsDither dither;
@@ -841,6 +855,8 @@ void ff_sws_init_output_funcs(SwsContext *c,
                               yuv2anyX_fn *yuv2anyX);
 void ff_sws_init_swscale_ppc(SwsContext *c);
 void ff_sws_init_swscale_x86(SwsContext *c);
+void ff_sws_init_gamma_x86(SwsContext *c);
+void ff_sws_init_alphablend_x86(SwsContext *c);
 void ff_sws_init_swscale_aarch64(SwsContext *c);
 void ff_sws_init_swscale_arm(SwsContext *c);
 
@@ -870,6 +886,9 @@ struct SwsContext *sws_alloc_set_opts(int srcW, int srcH, enum AVPixelFormat src
                                       int dstW, int dstH, enum AVPixelFormat dstFormat,
                                       int flags, const double *param);
 
+void ff_sws_init_gamma(SwsContext *c);
+void ff_sws_init_alphablend(SwsContext *c);
+
 int ff_sws_alphablendaway(SwsContext *c, const uint8_t *src[],
                           int srcStride[], int srcSliceY, int srcSliceH,
                           uint8_t *dst[], int dstStride[]);
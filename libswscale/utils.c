@@ -1082,13 +1082,15 @@ static uint16_t * alloc_gamma_tbl(double e)
 {
     int i = 0;
     uint16_t * tbl;
-    tbl = (uint16_t*)av_malloc(sizeof(uint16_t) * 1 << 16);
+    // the padding entry allows SIMD code to load 32 bits at any index
+    tbl = (uint16_t*)av_malloc(sizeof(uint16_t) * ((1 << 16) + 1));
     if (!tbl)
         return NULL;
 
     for (i = 0; i < 65536; ++i) {
         tbl[i] = pow(i / 65535.0, e) * 65535.0;
     }
+    tbl[65536] = 0;
     return tbl;
 }
 
@@ -1779,6 +1781,7 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
         alphaless_fmt(srcFormat) == dstFormat
     ) {
         c->swscale = ff_sws_alphablendaway;
+        ff_sws_init_alphablend(c);
 
         if (flags & SWS_PRINT_INFO)
             av_log(c, AV_LOG_INFO,
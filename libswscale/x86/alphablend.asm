@@ -0,0 +1,76 @@
+;******************************************************************************
+;* x86-optimized alpha blending
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+pw_257: times 8 dw 257
+
+SECTION .text
+
+;-----------------------------------------------------------------------------
+; void ff_alpha_blend_8(uint8_t *dst, const uint8_t *src, const uint8_t *alpha,
+;                       int width, int target)
+;
+; dst = ((src * alpha + target * (255 - alpha) + 128) * 257) >> 16
+; all intermediates fit in unsigned 16 bits
+;-----------------------------------------------------------------------------
+
+INIT_XMM sse2
+cglobal alpha_blend_8, 5, 5, 8, dst, src, alpha, w, target
+    test         wd, wd
+    jle .end
+    movd         m7, targetd
+    SPLATW       m7, m7
+    pxor         m6, m6
+    pcmpeqw      m5, m5
+    psrlw        m5, 8          ; 255
+    pcmpeqw      m4, m4
+    psrlw        m4, 15
+    psllw        m4, 7          ; 128
+.loop:
+    movu         m0, [srcq]
+    movu         m1, [alphaq]
+    punpckhbw    m2, m0, m6
+    punpcklbw    m0, m6
+    punpckhbw    m3, m1, m6
+    punpcklbw    m1, m6
+    pmullw       m0, m1
+    pmullw       m2, m3
+    pxor         m1, m5         ; 255 - alpha
+    pxor         m3, m5
+    pmullw       m1, m7
+    pmullw       m3, m7
+    paddw        m0, m1
+    paddw        m2, m3
+    paddw        m0, m4
+    paddw        m2, m4
+    pmulhuw      m0, [pw_257]
+    pmulhuw      m2, [pw_257]
+    packuswb     m0, m2
+    movu     [dstq], m0
+    add        srcq, mmsize
+    add      alphaq, mmsize
+    add        dstq, mmsize
+    sub          wd, mmsize
+    jg .loop
+.end:
+    RET
@@ -0,0 +1,58 @@
+;******************************************************************************
+;* x86-optimized gamma conversion
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION .text
+
+;-----------------------------------------------------------------------------
+; void ff_gamma_convert(uint16_t *line, int width, const uint16_t *table)
+;
+; line holds RGBA64 pixels, the alpha component is kept as is. The lookups
+; load 32 bits per entry, hence the padding entry required after the table.
+;-----------------------------------------------------------------------------
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+cglobal gamma_convert, 3, 3, 6, line, w, table
+    test         wd, wd
+    jle .end
+    pcmpeqd      m5, m5
+    psrld        m5, 16
+.loop:
+    pmovzxwd     m0, [lineq]
+    pmovzxwd     m1, [lineq+16]
+    pcmpeqd      m4, m4
+    vpgatherdd   m2, [tableq+m0*2], m4
+    pcmpeqd      m4, m4
+    vpgatherdd   m3, [tableq+m1*2], m4
+    pand         m2, m5
+    pand         m3, m5
+    pblendw      m2, m0, 0xc0
+    pblendw      m3, m1, 0xc0
+    packusdw     m2, m3
+    vpermq       m2, m2, q3120
+    movu     [lineq], m2
+    add       lineq, mmsize
+    sub          wd, mmsize/8
+    jg .loop
+.end:
+    RET
+%endif
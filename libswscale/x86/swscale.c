@@ -582,3 +582,23 @@ switch(c->dstBpc){ \
         }
     }
 }
+
+void ff_gamma_convert_avx2(uint16_t *line, int width, const uint16_t *table);
+void ff_alpha_blend_8_sse2(uint8_t *dst, const uint8_t *src, const uint8_t *alpha,
+                           int width, int target);
+
+av_cold void ff_sws_init_gamma_x86(SwsContext *c)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_AVX2_FAST(cpu_flags))
+        c->gamma_convert = ff_gamma_convert_avx2;
+}
+
+av_cold void ff_sws_init_alphablend_x86(SwsContext *c)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSE2(cpu_flags))
+        c->alpha_blend_8 = ff_alpha_blend_8_sse2;
+}
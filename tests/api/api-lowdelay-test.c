@@ -0,0 +1,184 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Low delay frame threading test.
+ * Encodes a few frames with MPEG-4, decodes them with FF_THREAD_LOW_DELAY and
+ * AV_CODEC_FLAG_LOW_DELAY, and prints which frames each packet returns.
+ */
+
+#include "libavcodec/avcodec.h"
+#include "libavutil/common.h"
+
+#define NUMBER_OF_FRAMES 8
+#define WIDTH  64
+#define HEIGHT 48
+
+static int encode_frames(AVPacket *pkts)
+{
+    AVCodec *enc = avcodec_find_encoder(AV_CODEC_ID_MPEG4);
+    AVCodecContext *ctx = avcodec_alloc_context3(enc);
+    AVFrame *frame = av_frame_alloc();
+    int i, x, y, got_output, ret;
+
+    if (!ctx || !frame)
+        return AVERROR(ENOMEM);
+
+    ctx->width     = WIDTH;
+    ctx->height    = HEIGHT;
+    ctx->pix_fmt   = AV_PIX_FMT_YUV420P;
+    ctx->time_base = (AVRational){ 1, 25 };
+    ctx->thread_count = 1;
+    ret = avcodec_open2(ctx, enc, NULL);
+    if (ret < 0)
+        goto end;
+
+    frame->width  = WIDTH;
+    frame->height = HEIGHT;
+    frame->format = AV_PIX_FMT_YUV420P;
+    ret = av_frame_get_buffer(frame, 32);
+    if (ret < 0)
+        goto end;
+
+    for (i = 0; i < NUMBER_OF_FRAMES; i++) {
+        ret = av_frame_make_writable(frame);
+        if (ret < 0)
+            goto end;
+        for (y = 0; y < HEIGHT; y++)
+            for (x = 0; x < WIDTH; x++)
+                frame->data[0][y * frame->linesize[0] + x] = x + y + i * 3;
+        for (y = 0; y < HEIGHT / 2; y++) {
+            memset(frame->data[1] + y * frame->linesize[1], 128 + i, WIDTH / 2);
+            memset(frame->data[2] + y * frame->linesize[2],  64 + i, WIDTH / 2);
+        }
+        frame->pts = i;
+
+        av_init_packet(&pkts[i]);
+        pkts[i].data = NULL;
+        pkts[i].size = 0;
+        ret = avcodec_encode_video2(ctx, &pkts[i], frame, &got_output);
+        if (ret < 0)
+            goto end;
+        if (!got_output) {
+            ret = AVERROR_BUG;
+            goto end;
+        }
+    }
+
+end:
+    av_frame_free(&frame);
+    avcodec_free_context(&ctx);
+    return ret;
+}
+
+static int open_decoder(AVCodecContext **pctx, int thread_type)
+{
+    AVCodec *dec = avcodec_find_decoder(AV_CODEC_ID_MPEG4);
+    AVCodecContext *ctx = avcodec_alloc_context3(dec);
+    int ret;
+
+    if (!ctx)
+        return AVERROR(ENOMEM);
+
+    ctx->thread_count = 4;
+    ctx->thread_type  = thread_type;
+    ctx->flags       |= AV_CODEC_FLAG_LOW_DELAY;
+    ret = avcodec_open2(ctx, dec, NULL);
+    if (ret < 0) {
+        avcodec_free_context(&ctx);
+        return ret;
+    }
+
+    printf("thread_type %d: thread_count %d, frame threading %s\n", thread_type,
+           ctx->thread_count, ctx->active_thread_type & FF_THREAD_FRAME ? "on" : "off");
+    *pctx = ctx;
+    return 0;
+}
+
+static int receive_frames(AVCodecContext *ctx, AVFrame *frame, const char *when)
+{
+    int ret;
+
+    while ((ret = avcodec_receive_frame(ctx, frame)) >= 0) {
+        printf("%s: frame %"PRId64"\n", when, frame->pts);
+        av_frame_unref(frame);
+    }
+    return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF ? 0 : ret;
+}
+
+static int decode_frames(AVCodecContext *ctx, AVPacket *pkts)
+{
+    AVFrame *frame = av_frame_alloc();
+    char when[32];
+    int i, ret = 0;
+
+    if (!frame)
+        return AVERROR(ENOMEM);
+
+    for (i = 0; i < NUMBER_OF_FRAMES && ret >= 0; i++) {
+        pkts[i].pts = i;
+        ret = avcodec_send_packet(ctx, &pkts[i]);
+        if (ret >= 0) {
+            snprintf(when, sizeof(when), "packet %d", i);
+            ret = receive_frames(ctx, frame, when);
+        }
+    }
+    if (ret >= 0)
+        ret = avcodec_send_packet(ctx, NULL);
+    if (ret >= 0)
+        ret = receive_frames(ctx, frame, "flush");
+
+    av_frame_free(&frame);
+    return ret;
+}
+
+int main(void)
+{
+    AVPacket pkts[NUMBER_OF_FRAMES] = { { 0 } };
+    AVCodecContext *ctx = NULL;
+    int i, ret;
+
+    avcodec_register_all();
+
+    ret = encode_frames(pkts);
+    if (ret < 0) {
+        av_log(NULL, AV_LOG_ERROR, "Error encoding the frames\n");
+        return 1;
+    }
+
+    /* without FF_THREAD_LOW_DELAY, AV_CODEC_FLAG_LOW_DELAY disables frame threading */
+    ret = open_decoder(&ctx, FF_THREAD_FRAME);
+    if (ret >= 0)
+        avcodec_free_context(&ctx);
+
+    /* with it, the 4 threads are clamped to 2 and the delay is one frame */
+    if (ret >= 0)
+        ret = open_decoder(&ctx, FF_THREAD_FRAME | FF_THREAD_LOW_DELAY);
+    if (ret >= 0)
+        ret = decode_frames(ctx, pkts);
+    avcodec_free_context(&ctx);
+
+    for (i = 0; i < NUMBER_OF_FRAMES; i++)
+        av_packet_unref(&pkts[i]);
+
+    if (ret < 0) {
+        av_log(NULL, AV_LOG_ERROR, "Error decoding the frames\n");
+        return 1;
+    }
+    return 0;
+}
@@ -115,6 +115,7 @@ static const struct {
     #endif
     #if CONFIG_HEVC_DECODER
         { "hevc_add_res", checkasm_check_hevc_add_res },
+        { "hevc_deblock", checkasm_check_hevc_deblock },
         { "hevc_idct", checkasm_check_hevc_idct },
     #endif
     #if CONFIG_JPEG2000_DECODER
@@ -147,6 +148,12 @@ static const struct {
         { "vf_colorspace", checkasm_check_colorspace },
     #endif
 #endif
+#if CONFIG_SWRESAMPLE
+        { "swresample", checkasm_check_swresample },
+#endif
+#if CONFIG_SWSCALE
+        { "sw_scale", checkasm_check_sw_scale },
+#endif
 #if CONFIG_AVUTIL
         { "fixed_dsp", checkasm_check_fixed_dsp },
         { "float_dsp", checkasm_check_float_dsp },
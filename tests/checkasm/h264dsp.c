@@ -226,7 +226,80 @@ static void check_idct(void)
     report("idct");
 }
 
+#define WEIGHT_STRIDE 32
+
+static void randomize_pixels(uint8_t *buf, int bit_depth)
+{
+    uint32_t mask = pixel_mask[bit_depth - 8];
+    int i;
+
+    for (i = 0; i < 16 * WEIGHT_STRIDE; i += 4)
+        AV_WN32A(buf + i, rnd() & mask);
+}
+
+static void check_weight(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, src,  [16 * WEIGHT_STRIDE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [16 * WEIGHT_STRIDE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [16 * WEIGHT_STRIDE]);
+    /* Heights passed by the decoder for each width: those of the luma
+     * partitions, plus halved (4:2:0) and full (4:2:2, 4:4:4) heights of
+     * the chroma ones. */
+    static const int heights[4][5] = {
+        { 16, 8 }, { 16, 8, 4 }, { 16, 8, 4, 2 }, { 8, 4, 2 },
+    };
+    H264DSPContext h;
+    int bit_depth, i, j, w, height;
+
+    for (bit_depth = 8; bit_depth <= 10; bit_depth++) {
+        ff_h264dsp_init(&h, bit_depth, 1);
+        for (i = 0; i < 4; i++) {
+            w = 16 >> i;
+            for (j = 0; (height = heights[i][j]); j++) {
+                /* Keep the weighted sums within the int16 range, as the
+                 * SIMD versions for 8 bit rely on it, which real streams
+                 * satisfy. */
+                int log2_denom = rnd() % 7;
+                int offset     = (int)(rnd() % 16) - 8;
+                int weightd    = (int)(rnd() % 120) - 56;
+                int weights    = av_clip((int)(rnd() % 121) - weightd, -56, 120);
+
+                if (check_func(h.weight_h264_pixels_tab[i], "h264_weight_%dx%d_%dbpp",
+                               w, height, bit_depth)) {
+                    declare_func(void, uint8_t *block, ptrdiff_t stride, int height,
+                                 int log2_denom, int weight, int offset);
+
+                    randomize_pixels(dst0, bit_depth);
+                    memcpy(dst1, dst0, 16 * WEIGHT_STRIDE);
+                    call_ref(dst0, WEIGHT_STRIDE, height, log2_denom, weights, offset);
+                    call_new(dst1, WEIGHT_STRIDE, height, log2_denom, weights, offset);
+                    if (memcmp(dst0, dst1, 16 * WEIGHT_STRIDE))
+                        fail();
+                    bench_new(dst1, WEIGHT_STRIDE, height, log2_denom, weights, offset);
+                }
+                if (check_func(h.biweight_h264_pixels_tab[i], "h264_biweight_%dx%d_%dbpp",
+                               w, height, bit_depth)) {
+                    declare_func(void, uint8_t *dst, uint8_t *src, ptrdiff_t stride,
+                                 int height, int log2_denom, int weightd,
+                                 int weights, int offset);
+
+                    randomize_pixels(src, bit_depth);
+                    randomize_pixels(dst0, bit_depth);
+                    memcpy(dst1, dst0, 16 * WEIGHT_STRIDE);
+                    call_ref(dst0, src, WEIGHT_STRIDE, height, log2_denom, weightd, weights, offset);
+                    call_new(dst1, src, WEIGHT_STRIDE, height, log2_denom, weightd, weights, offset);
+                    if (memcmp(dst0, dst1, 16 * WEIGHT_STRIDE))
+                        fail();
+                    bench_new(dst1, src, WEIGHT_STRIDE, height, log2_denom, weightd, weights, offset);
+                }
+            }
+        }
+    }
+    report("weight");
+}
+
 void checkasm_check_h264dsp(void)
 {
     check_idct();
+    check_weight();
 }
@@ -0,0 +1,158 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/intreadwrite.h"
+
+#include "libavcodec/hevcdsp.h"
+
+#include "checkasm.h"
+
+/* 16x16 pixels with the edge between the 8th and 9th line/column */
+#define BUF_PIXELS 16
+#define BUF_SIZE   (BUF_PIXELS * BUF_PIXELS * 2)
+
+/* Fill the block with a gradient and a step across the edge plus some
+ * noise, chosen per 4-line segment so that the strong, normal and no
+ * filtering decisions all get exercised. xstride is across the edge,
+ * ystride along it, both in pixels. */
+static void randomize_edge(uint8_t *buf, int xstride, int ystride, int bit_depth)
+{
+    const int max   = (1 << bit_depth) - 1;
+    const int shift = bit_depth - 8;
+    int i, j;
+
+    for (j = 0; j < BUF_PIXELS; j += 4) {
+        int base  = rnd() & max;
+        int slope = ((int)(rnd() % 5) - 2) << shift;
+        int step  = ((int)(rnd() % 33) - 16) << shift;
+        int noise = (rnd() % 3) << shift;
+        int k;
+
+        for (k = j; k < j + 4; k++) {
+            for (i = 0; i < BUF_PIXELS; i++) {
+                int val = base + slope * i + (i >= BUF_PIXELS / 2 ? step : 0);
+                int idx = i * xstride + k * ystride;
+
+                if (noise)
+                    val += (int)(rnd() % (2 * noise + 1)) - noise;
+                val = av_clip(val, 0, max);
+                if (bit_depth > 8)
+                    AV_WN16A(buf + idx * 2, val);
+                else
+                    buf[idx] = val;
+            }
+        }
+    }
+}
+
+static void check_deblock_luma(HEVCDSPContext *h, int bit_depth)
+{
+    LOCAL_ALIGNED_32(uint8_t, buf0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, buf1, [BUF_SIZE]);
+    const int pixel_size   = bit_depth > 8 ? 2 : 1;
+    const ptrdiff_t stride = BUF_PIXELS * pixel_size;
+    uint8_t no_p[2] = { 0, 0 };
+    uint8_t no_q[2] = { 0, 0 };
+    int32_t tc[2];
+    int dir, beta;
+
+    declare_func(void, uint8_t *pix, ptrdiff_t stride, int beta, int32_t *tc,
+                 uint8_t *no_p, uint8_t *no_q);
+
+    for (dir = 0; dir < 2; dir++) {
+        void (*func)(uint8_t *pix, ptrdiff_t stride, int beta, int32_t *tc,
+                     uint8_t *no_p, uint8_t *no_q) =
+            dir ? h->hevc_v_loop_filter_luma : h->hevc_h_loop_filter_luma;
+        /* pixel offset of the first q0 */
+        const int off = (dir ? 1 : BUF_PIXELS) * BUF_PIXELS / 2;
+
+        if (check_func(func, "hevc_%s_loop_filter_luma_%d", dir ? "v" : "h", bit_depth)) {
+            randomize_edge(buf0, dir ? 1 : BUF_PIXELS, dir ? BUF_PIXELS : 1, bit_depth);
+            memcpy(buf1, buf0, BUF_SIZE);
+            beta  = rnd() % 65;
+            tc[0] = rnd() % 25;
+            tc[1] = rnd() % 25;
+
+            call_ref(buf0 + off * pixel_size, stride, beta, tc, no_p, no_q);
+            call_new(buf1 + off * pixel_size, stride, beta, tc, no_p, no_q);
+            if (memcmp(buf0, buf1, BUF_SIZE))
+                fail();
+            bench_new(buf1 + off * pixel_size, stride, beta, tc, no_p, no_q);
+        }
+    }
+}
+
+static void check_deblock_chroma(HEVCDSPContext *h, int bit_depth)
+{
+    LOCAL_ALIGNED_32(uint8_t, buf0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, buf1, [BUF_SIZE]);
+    const int pixel_size   = bit_depth > 8 ? 2 : 1;
+    const ptrdiff_t stride = BUF_PIXELS * pixel_size;
+    uint8_t no_p[2] = { 0, 0 };
+    uint8_t no_q[2] = { 0, 0 };
+    int32_t tc[2];
+    int dir;
+
+    declare_func(void, uint8_t *pix, ptrdiff_t stride, int32_t *tc,
+                 uint8_t *no_p, uint8_t *no_q);
+
+    for (dir = 0; dir < 2; dir++) {
+        void (*func)(uint8_t *pix, ptrdiff_t stride, int32_t *tc,
+                     uint8_t *no_p, uint8_t *no_q) =
+            dir ? h->hevc_v_loop_filter_chroma : h->hevc_h_loop_filter_chroma;
+        const int off = (dir ? 1 : BUF_PIXELS) * BUF_PIXELS / 2;
+
+        if (check_func(func, "hevc_%s_loop_filter_chroma_%d", dir ? "v" : "h", bit_depth)) {
+            randomize_edge(buf0, dir ? 1 : BUF_PIXELS, dir ? BUF_PIXELS : 1, bit_depth);
+            memcpy(buf1, buf0, BUF_SIZE);
+            tc[0] = rnd() % 25;
+            tc[1] = rnd() % 25;
+
+            call_ref(buf0 + off * pixel_size, stride, tc, no_p, no_q);
+            call_new(buf1 + off * pixel_size, stride, tc, no_p, no_q);
+            if (memcmp(buf0, buf1, BUF_SIZE))
+                fail();
+            bench_new(buf1 + off * pixel_size, stride, tc, no_p, no_q);
+        }
+    }
+}
+
+void checkasm_check_hevc_deblock(void)
+{
+    static const int bit_depths[] = { 8, 10, 12 };
+    int i;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(bit_depths); i++) {
+        HEVCDSPContext h;
+
+        ff_hevc_dsp_init(&h, bit_depths[i]);
+        check_deblock_luma(&h, bit_depths[i]);
+    }
+    report("luma");
+
+    for (i = 0; i < FF_ARRAY_ELEMS(bit_depths); i++) {
+        HEVCDSPContext h;
+
+        ff_hevc_dsp_init(&h, bit_depths[i]);
+        check_deblock_chroma(&h, bit_depths[i]);
+    }
+    report("chroma");
+}
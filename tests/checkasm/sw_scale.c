@@ -0,0 +1,113 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/mem.h"
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
+#include "checkasm.h"
+
+#define WIDTH 512
+
+static void check_gamma_convert(SwsContext *c)
+{
+    static uint16_t table[(1 << 16) + 1];
+    LOCAL_ALIGNED_32(uint16_t, src,      [WIDTH * 4]);
+    LOCAL_ALIGNED_32(uint16_t, line_ref, [WIDTH * 4]);
+    LOCAL_ALIGNED_32(uint16_t, line_new, [WIDTH * 4]);
+    int i, width;
+
+    declare_func(void, uint16_t *line, int width, const uint16_t *table);
+
+    ff_sws_init_gamma(c);
+
+    if (check_func(c->gamma_convert, "gamma_convert")) {
+        for (i = 0; i <= 1 << 16; i++)
+            table[i] = rnd();
+        for (i = 0; i < WIDTH * 4; i++)
+            src[i] = rnd();
+        /* make sure the ends of the table are hit */
+        src[0] = 0;
+        src[1] = 0xffff;
+
+        for (width = 8; width <= WIDTH; width += 8 * 31) {
+            memcpy(line_ref, src, sizeof(src[0]) * WIDTH * 4);
+            memcpy(line_new, src, sizeof(src[0]) * WIDTH * 4);
+            call_ref(line_ref, width, table);
+            call_new(line_new, width, table);
+            if (memcmp(line_ref, line_new, sizeof(src[0]) * WIDTH * 4))
+                fail();
+        }
+        bench_new(line_new, WIDTH, table);
+    }
+
+    report("gamma_convert");
+}
+
+static void check_alpha_blend(SwsContext *c)
+{
+    LOCAL_ALIGNED_32(uint8_t, src,     [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, alpha,   [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, dst_ref, [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, dst_new, [WIDTH]);
+    static const int targets[] = { 64, 128, 192 };
+    int i, t;
+
+    declare_func(void, uint8_t *dst, const uint8_t *src, const uint8_t *alpha,
+                 int width, int target);
+
+    ff_sws_init_alphablend(c);
+
+    if (check_func(c->alpha_blend_8, "alpha_blend_8")) {
+        for (t = 0; t < FF_ARRAY_ELEMS(targets); t++) {
+            for (i = 0; i < WIDTH; i++) {
+                src[i]   = rnd();
+                alpha[i] = rnd();
+            }
+            /* opaque and transparent extremes */
+            alpha[0] = 0;
+            alpha[1] = 255;
+            memset(dst_ref, 0, WIDTH);
+            memset(dst_new, 0, WIDTH);
+            call_ref(dst_ref, src, alpha, WIDTH - 16 * t, targets[t]);
+            call_new(dst_new, src, alpha, WIDTH - 16 * t, targets[t]);
+            if (memcmp(dst_ref, dst_new, WIDTH))
+                fail();
+        }
+        bench_new(dst_new, src, alpha, WIDTH, 128);
+    }
+
+    report("alpha_blend");
+}
+
+void checkasm_check_sw_scale(void)
+{
+    SwsContext *c = sws_alloc_context();
+
+    if (!c) {
+        fail();
+        return;
+    }
+
+    check_gamma_convert(c);
+    check_alpha_blend(c);
+
+    sws_freeContext(c);
+}
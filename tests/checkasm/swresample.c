@@ -0,0 +1,179 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/channel_layout.h"
+#include "libavutil/internal.h"
+#include "libavutil/opt.h"
+#include "libswresample/resample.h"
+#include "libswresample/swresample_internal.h"
+#include "checkasm.h"
+
+#define DST_LEN 256
+#define SRC_LEN 1024
+
+static const enum AVSampleFormat resample_fmts[] = {
+    AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_DBLP,
+};
+
+static void randomize_samples(uint8_t *buf, enum AVSampleFormat fmt, int len)
+{
+    int i;
+
+    for (i = 0; i < len; i++) {
+        switch (fmt) {
+        case AV_SAMPLE_FMT_S16P: ((int16_t *)buf)[i] = rnd();                           break;
+        case AV_SAMPLE_FMT_FLTP: ((float   *)buf)[i] = (int16_t)rnd() / 32768.0f;       break;
+        case AV_SAMPLE_FMT_DBLP: ((double  *)buf)[i] = (int32_t)rnd() / 2147483648.0;   break;
+        }
+    }
+}
+
+static int compare_samples(const uint8_t *ref, const uint8_t *new,
+                           enum AVSampleFormat fmt, int len)
+{
+    switch (fmt) {
+    case AV_SAMPLE_FMT_FLTP:
+        return !float_near_abs_eps_array((const float *)ref, (const float *)new, 1e-5f, len);
+    case AV_SAMPLE_FMT_DBLP:
+        return !double_near_abs_eps_array((const double *)ref, (const double *)new, 1e-12, len);
+    default:
+        return memcmp(ref, new, len * av_get_bytes_per_sample(fmt));
+    }
+}
+
+static void check_resample(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, src,     [SRC_LEN * sizeof(double)]);
+    LOCAL_ALIGNED_32(uint8_t, dst_ref, [DST_LEN * sizeof(double)]);
+    LOCAL_ALIGNED_32(uint8_t, dst_new, [DST_LEN * sizeof(double)]);
+    static const char * const fmt_names[] = { "int16", "float", "double" };
+    int i, linear;
+
+    declare_func(int, ResampleContext *c, void *dst, const void *src,
+                 int n, int update_ctx);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(resample_fmts); i++) {
+        ResampleContext *c = swri_resampler.init(NULL, 48000, 44100, 32, 10, 1, 0,
+                                                 resample_fmts[i], SWR_FILTER_TYPE_KAISER,
+                                                 9, 20, 0, 1, 1, NULL);
+        if (!c) {
+            fail();
+            continue;
+        }
+
+        for (linear = 0; linear < 2; linear++) {
+            int (*func)(ResampleContext *c, void *dst, const void *src, int n, int update_ctx) =
+                linear ? c->dsp.resample_linear : c->dsp.resample_common;
+
+            if (check_func(func, "resample_%s_%s", linear ? "linear" : "common", fmt_names[i])) {
+                ResampleContext ref_ctx = *c, new_ctx = *c;
+                int ref_consumed, new_consumed;
+
+                ref_ctx.index = new_ctx.index = rnd() % c->phase_count;
+                ref_ctx.frac  = new_ctx.frac  = rnd() % c->src_incr;
+
+                randomize_samples(src, resample_fmts[i], SRC_LEN);
+                memset(dst_ref, 0, DST_LEN * sizeof(double));
+                memset(dst_new, 0, DST_LEN * sizeof(double));
+
+                ref_consumed = call_ref(&ref_ctx, dst_ref, src, DST_LEN, 1);
+                new_consumed = call_new(&new_ctx, dst_new, src, DST_LEN, 1);
+                if (ref_consumed != new_consumed ||
+                    ref_ctx.index != new_ctx.index || ref_ctx.frac != new_ctx.frac ||
+                    compare_samples(dst_ref, dst_new, resample_fmts[i], DST_LEN))
+                    fail();
+
+                new_ctx = *c;
+                bench_new(&new_ctx, dst_new, src, DST_LEN, 1);
+            }
+        }
+        swri_resampler.free(&c);
+    }
+
+    report("resample");
+}
+
+static void check_rematrix(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, in1,     [DST_LEN * sizeof(float)]);
+    LOCAL_ALIGNED_32(uint8_t, in2,     [DST_LEN * sizeof(float)]);
+    LOCAL_ALIGNED_32(uint8_t, dst_ref, [DST_LEN * sizeof(float)]);
+    LOCAL_ALIGNED_32(uint8_t, dst_new, [DST_LEN * sizeof(float)]);
+    static const enum AVSampleFormat fmts[] = { AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_FLTP };
+    static const char * const fmt_names[] = { "int16", "float" };
+    double matrix[4];
+    int i, j;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(fmts); i++) {
+        SwrContext *s = swr_alloc_set_opts(NULL, AV_CH_LAYOUT_STEREO, fmts[i], 48000,
+                                           AV_CH_LAYOUT_STEREO, fmts[i], 48000, 0, NULL);
+        mix_1_1_func_type *mix_1_1;
+        mix_2_1_func_type *mix_2_1;
+
+        /* keep the row sums below 1.0 so no clipping version is selected
+         * and the int16 coefficients need no extra shift */
+        for (j = 0; j < 4; j++)
+            matrix[j] = ((int)(rnd() % 900) - 450) / 1000.0;
+        if (!s || av_opt_set_sample_fmt(s, "internal_sample_fmt", fmts[i], 0) < 0 ||
+            swr_set_matrix(s, matrix, 2) < 0 || swr_init(s) < 0) {
+            swr_free(&s);
+            fail();
+            continue;
+        }
+
+        mix_1_1 = s->mix_1_1_simd ? s->mix_1_1_simd : s->mix_1_1_f;
+        mix_2_1 = s->mix_2_1_simd ? s->mix_2_1_simd : s->mix_2_1_f;
+
+        if (check_func(mix_1_1, "mix_1_1_%s", fmt_names[i])) {
+            declare_func(void, void *out, const void *in, void *coeffp,
+                         integer index, integer len);
+
+            randomize_samples(in1, fmts[i], DST_LEN);
+            call_ref(dst_ref, in1, s->native_matrix, 1, DST_LEN);
+            call_new(dst_new, in1, s->mix_1_1_simd ? s->native_simd_matrix : s->native_matrix, 1, DST_LEN);
+            if (memcmp(dst_ref, dst_new, DST_LEN * av_get_bytes_per_sample(fmts[i])))
+                fail();
+            bench_new(dst_new, in1, s->mix_1_1_simd ? s->native_simd_matrix : s->native_matrix, 1, DST_LEN);
+        }
+
+        if (check_func(mix_2_1, "mix_2_1_%s", fmt_names[i])) {
+            declare_func(void, void *out, const void *in1, const void *in2,
+                         void *coeffp, integer index1, integer index2, integer len);
+
+            randomize_samples(in1, fmts[i], DST_LEN);
+            randomize_samples(in2, fmts[i], DST_LEN);
+            call_ref(dst_ref, in1, in2, s->native_matrix, 2, 3, DST_LEN);
+            call_new(dst_new, in1, in2, s->mix_2_1_simd ? s->native_simd_matrix : s->native_matrix, 2, 3, DST_LEN);
+            if (memcmp(dst_ref, dst_new, DST_LEN * av_get_bytes_per_sample(fmts[i])))
+                fail();
+            bench_new(dst_new, in1, in2, s->mix_2_1_simd ? s->native_simd_matrix : s->native_matrix, 2, 3, DST_LEN);
+        }
+
+        swr_free(&s);
+    }
+
+    report("rematrix");
+}
+
+void checkasm_check_swresample(void)
+{
+    check_resample();
+    check_rematrix();
+}
@@ -320,6 +320,28 @@ gaplessenc(){
     probegaplessinfo "$file1"
 }
 
+segmenter(){
+    playlist=$1
+    shift
+
+    # the segments are written next to the playlist, give them their own directory
+    segdir="${outdir}/${test}.segments"
+    rm -rf "$segdir"
+    mkdir -p "$segdir"
+
+    ffmpeg "$@" -flags +bitexact -fflags +bitexact -y $(target_path "$segdir/$playlist") || return
+    cat "$segdir/$playlist"
+}
+
+dashchunks(){
+    segmenter manifest.mpd "$@" || return
+    for seg in init-stream0.m4s chunk-stream0-00001.m4s; do
+        md5=$(do_md5sum "$segdir/$seg" | awk '{print $1}')
+        nb_moof=$(grep -a -o moof "$segdir/$seg" | wc -l | tr -d ' ')
+        echo "$seg: $md5, $nb_moof moof"
+    done
+}
+
 audio_match(){
     sample=$(target_path $1)
     trefile=$(target_path $2)
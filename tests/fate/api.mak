@@ -3,6 +3,11 @@ fate-api-flac: $(APITESTSDIR)/api-flac-test$(EXESUF)
 fate-api-flac: CMD = run $(APITESTSDIR)/api-flac-test
 fate-api-flac: CMP = null
 
+FATE_API_LOWDELAY-$(call ALLYES, MPEG4_ENCODER MPEG4_DECODER) += fate-api-lowdelay
+fate-api-lowdelay: $(APITESTSDIR)/api-lowdelay-test$(EXESUF)
+fate-api-lowdelay: CMD = run $(APITESTSDIR)/api-lowdelay-test
+FATE_API_LIBAVCODEC-$(HAVE_THREADS) += $(FATE_API_LOWDELAY-yes)
+
 FATE_API_SAMPLES_LIBAVFORMAT-$(call DEMDEC, FLV, FLV) += fate-api-band
 fate-api-band: $(APITESTSDIR)/api-band-test$(EXESUF)
 fate-api-band: CMD = run $(APITESTSDIR)/api-band-test $(TARGET_SAMPLES)/mpeg4/resize_down-up.h263
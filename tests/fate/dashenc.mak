@@ -0,0 +1,19 @@
+DASHENC_SRC = -f lavfi -i "aevalsrc=cos(2*PI*t)*sin(2*PI*(440+4*t)*t):d=12" -map 0 -codec:a mp2fixed
+
+# the equal duration segments are merged into SegmentTimeline runs
+FATE_DASHENC-$(call ALLYES, DASH_MUXER MP4_MUXER AEVALSRC_FILTER LAVFI_INDEV MP2FIXED_ENCODER) += fate-dashenc-timeline
+fate-dashenc-timeline: CMD = segmenter manifest.mpd $(DASHENC_SRC) -f dash -min_seg_duration 1000000
+
+# the window starts in the middle of a run, which has to be split
+FATE_DASHENC-$(call ALLYES, DASH_MUXER MP4_MUXER AEVALSRC_FILTER LAVFI_INDEV MP2FIXED_ENCODER) += fate-dashenc-timeline-window
+fate-dashenc-timeline-window: CMD = segmenter manifest.mpd $(DASHENC_SRC) -f dash -min_seg_duration 1000000 -window_size 5 -extra_window_size 0
+
+# streaming writes the segments in chunks of frag_duration, or of one frame
+FATE_DASHENC-$(call ALLYES, DASH_MUXER MP4_MUXER AEVALSRC_FILTER LAVFI_INDEV MP2FIXED_ENCODER) += fate-dashenc-streaming
+fate-dashenc-streaming: CMD = dashchunks $(DASHENC_SRC) -t 3 -f dash -min_seg_duration 1000000 -streaming 1 -frag_duration 200000
+
+FATE_DASHENC-$(call ALLYES, DASH_MUXER MP4_MUXER AEVALSRC_FILTER LAVFI_INDEV MP2FIXED_ENCODER) += fate-dashenc-streaming-frame
+fate-dashenc-streaming-frame: CMD = dashchunks $(DASHENC_SRC) -t 3 -f dash -min_seg_duration 1000000 -streaming 1
+
+FATE_FFMPEG += $(FATE_DASHENC-yes)
+fate-dashenc: $(FATE_DASHENC-yes)
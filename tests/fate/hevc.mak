@@ -222,6 +222,20 @@ $(foreach N,$(HEVC_SAMPLES_422_10BIN),$(eval $(call FATE_HEVC_TEST_422_10BIN,$(N
 $(foreach N,$(HEVC_SAMPLES_444_8BIT),$(eval $(call FATE_HEVC_TEST_444_8BIT,$(N))))
 $(foreach N,$(HEVC_SAMPLES_444_12BIT),$(eval $(call FATE_HEVC_TEST_444_12BIT,$(N))))
 
+# pictures with a single slice and without WPP or tiles use a separate
+# loop filter job with slice threads, the output must not change
+HEVC_SAMPLES_SLICE_THREADS = DBLK_A_SONY_3 SAO_A_MediaTek_4
+
+define FATE_HEVC_SLICE_THREADS_TEST
+FATE_HEVC += fate-hevc-slice-threads-$(1)
+fate-hevc-slice-threads-$(1): CMD = framecrc -flags unaligned -vsync drop -i $(TARGET_SAMPLES)/hevc-conformance/$(1).bit
+fate-hevc-slice-threads-$(1): THREADS = 4
+fate-hevc-slice-threads-$(1): THREAD_TYPE = slice
+fate-hevc-slice-threads-$(1): REF = $(SRC_PATH)/tests/ref/fate/hevc-conformance-$(1)
+endef
+
+$(foreach N,$(HEVC_SAMPLES_SLICE_THREADS),$(eval $(call FATE_HEVC_SLICE_THREADS_TEST,$(N))))
+
 fate-hevc-paramchange-yuv420p-yuv420p10: CMD = framecrc -vsync 0 -i $(TARGET_SAMPLES)/hevc/paramchange_yuv420p_yuv420p10.hevc -sws_flags area+accurate_rnd+bitexact
 FATE_HEVC += fate-hevc-paramchange-yuv420p-yuv420p10
 
@@ -0,0 +1,12 @@
+HLSENC_SRC = -f lavfi -i "aevalsrc=cos(2*PI*t)*sin(2*PI*(440+4*t)*t):d=12" -map 0 -codec:a mp2fixed
+
+# all the segments stay in the playlist, which is appended to for each segment
+FATE_HLSENC-$(call ALLYES, HLS_MUXER MPEGTS_MUXER AEVALSRC_FILTER LAVFI_INDEV MP2FIXED_ENCODER) += fate-hlsenc-event
+fate-hlsenc-event: CMD = segmenter list.m3u8 $(HLSENC_SRC) -f hls -hls_time 1 -hls_list_size 0
+
+# the oldest segments are dropped from the head of the playlist
+FATE_HLSENC-$(call ALLYES, HLS_MUXER MPEGTS_MUXER AEVALSRC_FILTER LAVFI_INDEV MP2FIXED_ENCODER) += fate-hlsenc-window
+fate-hlsenc-window: CMD = segmenter list.m3u8 $(HLSENC_SRC) -f hls -hls_time 1 -hls_list_size 4 -hls_flags delete_segments
+
+FATE_FFMPEG += $(FATE_HLSENC-yes)
+fate-hlsenc: $(FATE_HLSENC-yes)
@@ -2,6 +2,10 @@
 #fate-async: libavformat/tests/async$(EXESUF)
 #fate-async: CMD = run libavformat/tests/async
 
+FATE_LIBAVFORMAT-$(HAVE_THREADS) += fate-aviobuf-async
+fate-aviobuf-async: libavformat/tests/aviobuf_async$(EXESUF)
+fate-aviobuf-async: CMD = run libavformat/tests/aviobuf_async $(TARGET_PATH)/tests/data/fate/aviobuf-async.bin
+
 FATE_LIBAVFORMAT-$(CONFIG_NETWORK) += fate-noproxy
 fate-noproxy: libavformat/tests/noproxy$(EXESUF)
 fate-noproxy: CMD = run libavformat/tests/noproxy
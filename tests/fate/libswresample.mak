@@ -1086,6 +1086,29 @@ FATE_SWR_RESAMPLE-$(call FILTERDEMDECENCMUX, ARESAMPLE, WAV, PCM_S16LE, PCM_S16L
 fate-swr-resample: $(FATE_SWR_RESAMPLE-yes)
 FATE_SWR += $(FATE_SWR_RESAMPLE-yes)
 
+define ARESAMPLE_DITHER
+FATE_SWR_DITHER += fate-swr-dither-$(1)-$(2)-$(3)
+fate-swr-dither-$(1)-$(2)-$(3): tests/data/asynth-44100-$(3).wav
+fate-swr-dither-$(1)-$(2)-$(3): CMD = md5 -i $(TARGET_PATH)/tests/data/asynth-44100-$(3).wav -af aformat=$(2),volume=0.8,aresample=osf=s16:dither_method=$(1) -f s16le
+endef
+
+$(foreach M,triangular_hp lipshitz shibata high_shibata,$(foreach C,1 2 3,$(eval $(call ARESAMPLE_DITHER,$(M),fltp,$(C)))))
+$(foreach C,1 2 3,$(eval $(call ARESAMPLE_DITHER,shibata,dblp,$(C))))
+
+FATE_SWR_DITHER-$(call FILTERDEMDECENCMUX, AFORMAT VOLUME ARESAMPLE, WAV, PCM_S16LE, PCM_S16LE, PCM_S16LE) += $(FATE_SWR_DITHER)
+fate-swr-dither: $(FATE_SWR_DITHER-yes)
+FATE_SWR += $(FATE_SWR_DITHER-yes)
+
+FATE_SWR_THREADS-$(call FILTERDEMDECENCMUX, ARESAMPLE, WAV, PCM_S16LE, PCM_S16LE, PCM_S16LE) += fate-swr-threads-1 fate-swr-threads-3
+fate-swr-threads-1: tests/data/asynth-44100-3.wav
+fate-swr-threads-1: CMD = md5 -i $(TARGET_PATH)/tests/data/asynth-44100-3.wav -af aresample=48000:internal_sample_fmt=s16p:resample_threads=1 -f s16le
+fate-swr-threads-3: tests/data/asynth-44100-3.wav
+fate-swr-threads-3: CMD = md5 -i $(TARGET_PATH)/tests/data/asynth-44100-3.wav -af aresample=48000:internal_sample_fmt=s16p:resample_threads=3 -f s16le
+fate-swr-threads-3: REF = $(SRC_PATH)/tests/ref/fate/swr-threads-1
+
+fate-swr-threads: $(FATE_SWR_THREADS-yes)
+FATE_SWR += $(FATE_SWR_THREADS-yes)
+
 FATE_SWR_AUDIOCONVERT-$(call FILTERDEMDECENCMUX, AFORMAT AEVAL, WAV, PCM_S16LE, PCM_S16LE, WAV) += fate-swr-audioconvert
 fate-swr-audioconvert: tests/data/asynth-44100-1.wav
 fate-swr-audioconvert: REF = tests/data/asynth-44100-1.wav
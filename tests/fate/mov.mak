@@ -49,6 +49,15 @@ fate-mov-displaymatrix: CMD = run ffprobe$(PROGSSUF)$(EXESUF) -show_entries stre
 
 fate-mov-spherical-mono: CMD = run ffprobe$(PROGSSUF)$(EXESUF) -show_entries stream_side_data_list -select_streams v -v 0 $(TARGET_SAMPLES)/mov/spherical.mov
 
+# Writes the moov atom into the space reserved with expected_duration,
+# without the second faststart pass.
+FATE_MOV_FFMPEG-$(call ALLYES, RAWVIDEO_DEMUXER MPEG4_ENCODER MOV_MUXER MOV_DEMUXER) += fate-mov-faststart-reserve
+fate-mov-faststart-reserve: tests/data/vsynth1.yuv
+fate-mov-faststart-reserve: CMD = transcode "rawvideo -s 352x288 -pix_fmt yuv420p" tests/data/vsynth1.yuv mp4 "-c:v mpeg4 -frames:v 25 -movflags +faststart -expected_duration 1" "-c copy"
+
+FATE_FFMPEG += $(FATE_MOV_FFMPEG-yes)
+fate-mov: $(FATE_MOV_FFMPEG-yes)
+
 fate-mov-gpmf-remux: CMD = md5 -i $(TARGET_SAMPLES)/mov/fake-gp-media-with-real-gpmf.mp4 -map 0 -c copy -fflags +bitexact -f mp4
 fate-mov-gpmf-remux: CMP = oneline
 fate-mov-gpmf-remux: REF = 8f48e435ee1f6b7e173ea756141eabf3
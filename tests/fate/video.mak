@@ -242,6 +242,15 @@ FATE_VIDEO-$(call DEMDEC, MPEGTS, MPEG2VIDEO) += fate-mpeg2-field-enc fate-mpeg2
 fate-mpeg2-field-enc: CMD = framecrc -flags +bitexact -idct simple -i $(TARGET_SAMPLES)/mpeg2/mpeg2_field_encoding.ts -an -frames:v 30
 fate-mpeg2-ticket186: CMD = framecrc -flags +bitexact -idct simple -i $(TARGET_SAMPLES)/mpeg2/t.mpg -an
 
+# field pictures hand the first field over to the next frame thread
+FATE_VIDEO-$(call DEMDEC, MPEGTS, MPEG2VIDEO) += fate-mpeg2-field-enc-frame-threads fate-mpeg2-ticket186-frame-threads
+fate-mpeg2-field-enc-frame-threads: CMD = framecrc -flags +bitexact -idct simple -i $(TARGET_SAMPLES)/mpeg2/mpeg2_field_encoding.ts -an -frames:v 30
+fate-mpeg2-field-enc-frame-threads: REF = $(SRC_PATH)/tests/ref/fate/mpeg2-field-enc
+fate-mpeg2-ticket186-frame-threads: CMD = framecrc -flags +bitexact -idct simple -i $(TARGET_SAMPLES)/mpeg2/t.mpg -an
+fate-mpeg2-ticket186-frame-threads: REF = $(SRC_PATH)/tests/ref/fate/mpeg2-ticket186
+fate-mpeg2-%-frame-threads: THREADS = 4
+fate-mpeg2-%-frame-threads: THREAD_TYPE = frame
+
 FATE_VIDEO-$(call DEMDEC, MPEGPS, MPEG2VIDEO) += fate-mpeg2-ticket6024
 fate-mpeg2-ticket6024: CMD = framecrc -flags +bitexact -idct simple -flags +truncated -i $(TARGET_SAMPLES)/mpeg2/matrixbench_mpeg2.lq1.mpg -an
 
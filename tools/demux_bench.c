@@ -0,0 +1,87 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Measure the demuxing throughput of a file.
+ *
+ * With -p, all programs but the given one are set to AVDISCARD_ALL, which
+ * e.g. lets the MPEG-TS demuxer drop their packets early.
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavutil/time.h"
+#include "libavformat/avformat.h"
+
+static int usage(int ret)
+{
+    fprintf(stderr, "Demux a file as fast as possible and print the throughput.\n");
+    fprintf(stderr, "demux_bench [-p program_id] file\n");
+    fprintf(stderr, "-p\tdiscard all programs except program_id\n");
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    AVFormatContext *fctx = NULL;
+    AVPacket pkt;
+    int64_t nb_packets = 0, nb_bytes = 0, start, elapsed, size;
+    int program_id = -1;
+    int i, err;
+
+    if (argc > 2 && !strcmp(argv[1], "-p")) {
+        program_id = atoi(argv[2]);
+        argv += 2;
+        argc -= 2;
+    }
+    if (argc != 2)
+        return usage(1);
+
+    av_register_all();
+
+    err = avformat_open_input(&fctx, argv[1], NULL, NULL);
+    if (err < 0) {
+        fprintf(stderr, "cannot open input: error %d\n", err);
+        return 1;
+    }
+    if (program_id >= 0) {
+        for (i = 0; i < fctx->nb_programs; i++)
+            if (fctx->programs[i]->id != program_id)
+                fctx->programs[i]->discard = AVDISCARD_ALL;
+    }
+
+    start = av_gettime_relative();
+    av_init_packet(&pkt);
+    while ((err = av_read_frame(fctx, &pkt)) >= 0) {
+        nb_packets++;
+        nb_bytes += pkt.size;
+        av_packet_unref(&pkt);
+    }
+    elapsed = FFMAX(av_gettime_relative() - start, 1);
+    size    = avio_size(fctx->pb);
+
+    printf("%"PRId64" packets, %"PRId64" payload bytes in %.3f s, %.1f MB/s of input\n",
+           nb_packets, nb_bytes, elapsed / 1000000.0,
+           size > 0 ? size / (double)elapsed : 0.0);
+
+    avformat_close_input(&fctx);
+    return err == AVERROR_EOF ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Measure the muxing throughput for a synthetic video stream.
+ *
+ * Packets of constant size, matching the requested bitrate at 25 fps, are
+ * muxed into a context whose output is discarded, so only the muxer and
+ * AVIOContext overhead is measured.
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavutil/mem.h"
+#include "libavutil/time.h"
+#include "libavformat/avformat.h"
+
+#define FPS 25
+
+static int64_t nb_out_bytes;
+
+static int discard_packet(void *opaque, uint8_t *buf, int buf_size)
+{
+    nb_out_bytes += buf_size;
+    return buf_size;
+}
+
+static int usage(int ret)
+{
+    fprintf(stderr, "Mux a synthetic video stream as fast as possible and print the throughput.\n");
+    fprintf(stderr, "mux_bench [-f format] [-b bitrate] [-t seconds] [-m muxrate]\n");
+    fprintf(stderr, "-f\toutput format, default mpegts\n");
+    fprintf(stderr, "-b\tvideo bitrate in bit/s, default 200000000\n");
+    fprintf(stderr, "-t\tstream duration in seconds, default 60\n");
+    fprintf(stderr, "-m\tvalue of the muxrate muxer option, if set; it must leave room for\n\tthe container overhead\n");
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    const char *format = "mpegts", *muxrate = NULL;
+    int64_t bitrate = 200000000, nb_frames, start, elapsed, i;
+    int duration = 60;
+    AVFormatContext *oc = NULL;
+    AVDictionary *opts = NULL;
+    AVStream *st;
+    AVPacket pkt;
+    uint8_t *iobuf, *data;
+    int size, err;
+
+    for (i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "-f"))
+            format = argv[i + 1];
+        else if (!strcmp(argv[i], "-b"))
+            bitrate = strtoll(argv[i + 1], NULL, 0);
+        else if (!strcmp(argv[i], "-t"))
+            duration = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-m"))
+            muxrate = argv[i + 1];
+        else
+            return usage(1);
+    }
+    if (i != argc || bitrate < 8 * FPS || duration <= 0)
+        return usage(1);
+
+    av_register_all();
+
+    err = avformat_alloc_output_context2(&oc, NULL, format, NULL);
+    if (err < 0) {
+        fprintf(stderr, "cannot allocate output context: error %d\n", err);
+        return 1;
+    }
+
+    size = bitrate / 8 / FPS;
+    data = av_mallocz(size + AV_INPUT_BUFFER_PADDING_SIZE);
+    iobuf = av_malloc(32768);
+    if (!data || !iobuf || !(st = avformat_new_stream(oc, NULL)) ||
+        !(oc->pb = avio_alloc_context(iobuf, 32768, 1, NULL, NULL,
+                                      discard_packet, NULL))) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    oc->flags    |= AVFMT_FLAG_BITEXACT;
+    /* same as the ffmpeg -muxdelay default */
+    oc->max_delay = 700000;
+    st->time_base                = (AVRational){ 1, FPS };
+    st->codecpar->codec_type     = AVMEDIA_TYPE_VIDEO;
+    st->codecpar->codec_id       = AV_CODEC_ID_MPEG2VIDEO;
+    st->codecpar->width          = 1920;
+    st->codecpar->height         = 1080;
+    st->codecpar->bit_rate       = bitrate;
+    /* the contents do not matter, but avoid start codes */
+    memset(data, 0xaa, size);
+
+    if (muxrate)
+        av_dict_set(&opts, "muxrate", muxrate, 0);
+    err = avformat_write_header(oc, &opts);
+    av_dict_free(&opts);
+    if (err < 0) {
+        fprintf(stderr, "cannot write header: error %d\n", err);
+        return 1;
+    }
+
+    nb_frames = (int64_t)duration * FPS;
+    start     = av_gettime_relative();
+    for (i = 0; i < nb_frames && err >= 0; i++) {
+        av_init_packet(&pkt);
+        pkt.data  = data;
+        pkt.size  = size;
+        pkt.flags = i % FPS ? 0 : AV_PKT_FLAG_KEY;
+        pkt.pts   = pkt.dts = av_rescale_q(i, (AVRational){ 1, FPS }, st->time_base);
+        err = av_write_frame(oc, &pkt);
+    }
+    if (err >= 0)
+        err = av_write_trailer(oc);
+    elapsed = FFMAX(av_gettime_relative() - start, 1);
+
+    printf("%"PRId64" packets, %"PRId64" output bytes in %.3f s, %.1f MB/s of output, %.1fx realtime\n",
+           i, nb_out_bytes, elapsed / 1000000.0, nb_out_bytes / (double)elapsed,
+           i * 1000000.0 / FPS / elapsed);
+
+    av_freep(&oc->pb->buffer);
+    avio_context_free(&oc->pb);
+    avformat_free_context(oc);
+    av_free(data);
+    return err < 0;
+}
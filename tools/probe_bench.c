@@ -0,0 +1,129 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Measure how long opening a file and probing its streams takes, for each
+ * of the given files.
+ *
+ * With -f, the fastprobe format flag is set, which takes the video stream
+ * parameters from the parsers instead of decoding frames.
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavutil/dict.h"
+#include "libavutil/pixdesc.h"
+#include "libavutil/time.h"
+#include "libavformat/avformat.h"
+
+static int usage(int ret)
+{
+    fprintf(stderr, "Probe files repeatedly and print the average probe time of each.\n");
+    fprintf(stderr, "probe_bench [-f] [-n runs] file [file...]\n");
+    fprintf(stderr, "-f\ttake video parameters from the parsers (fflags +fastprobe)\n");
+    fprintf(stderr, "-n\tnumber of runs, default 10\n");
+    return ret;
+}
+
+static void print_streams(AVFormatContext *fctx)
+{
+    int i;
+
+    for (i = 0; i < fctx->nb_streams; i++) {
+        const AVCodecParameters *par = fctx->streams[i]->codecpar;
+
+        printf("stream %d: %s", i, avcodec_get_name(par->codec_id));
+        if (par->codec_type == AVMEDIA_TYPE_VIDEO)
+            printf(" %dx%d %s profile %d level %d", par->width, par->height,
+                   par->format >= 0 ? av_get_pix_fmt_name(par->format) : "none",
+                   par->profile, par->level);
+        printf("\n");
+    }
+}
+
+static int bench_file(const char *filename, int fast, int runs)
+{
+    AVFormatContext *fctx = NULL;
+    int64_t start, elapsed, total = 0, worst = 0;
+    int i, err;
+
+    for (i = 0; i < runs; i++) {
+        AVDictionary *opts = NULL;
+
+        if (fast)
+            av_dict_set(&opts, "fflags", "+fastprobe", 0);
+
+        start = av_gettime_relative();
+        err = avformat_open_input(&fctx, filename, NULL, &opts);
+        av_dict_free(&opts);
+        if (err < 0) {
+            fprintf(stderr, "%s: cannot open input: error %d\n", filename, err);
+            return err;
+        }
+        err = avformat_find_stream_info(fctx, NULL);
+        elapsed = av_gettime_relative() - start;
+        if (err < 0) {
+            fprintf(stderr, "%s: cannot find stream info: error %d\n", filename, err);
+            avformat_close_input(&fctx);
+            return err;
+        }
+
+        total += elapsed;
+        worst  = FFMAX(worst, elapsed);
+        if (i == runs - 1)
+            print_streams(fctx);
+        avformat_close_input(&fctx);
+    }
+
+    printf("%s: %d runs, average %.3f ms, worst %.3f ms\n",
+           filename, runs, total / 1000.0 / runs, worst / 1000.0);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int fast = 0, runs = 10;
+    int i, ret = 0;
+
+    while (argc > 2 && argv[1][0] == '-') {
+        if (!strcmp(argv[1], "-f")) {
+            fast = 1;
+            argv++;
+            argc--;
+        } else if (!strcmp(argv[1], "-n") && argc > 3) {
+            runs = atoi(argv[2]);
+            argv += 2;
+            argc -= 2;
+        } else {
+            return usage(1);
+        }
+    }
+    if (argc < 2 || runs < 1)
+        return usage(1);
+
+    av_register_all();
+
+    for (i = 1; i < argc; i++)
+        if (bench_file(argv[i], fast, runs) < 0)
+            ret = 1;
+
+    return ret;
+}